@@ -0,0 +1,38 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> allocation_count{ 0 };
+
+uint64_t get_allocation_count() {
+	return allocation_count.load(std::memory_order_relaxed);
+}
+
+static void *counted_alloc(std::size_t p_size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	void *ptr = malloc(p_size == 0 ? 1 : p_size);
+	if (ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void *operator new(std::size_t p_size) { return counted_alloc(p_size); }
+void *operator new[](std::size_t p_size) { return counted_alloc(p_size); }
+void *operator new(std::size_t p_size, const std::nothrow_t &) noexcept {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	return malloc(p_size == 0 ? 1 : p_size);
+}
+void *operator new[](std::size_t p_size, const std::nothrow_t &) noexcept {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	return malloc(p_size == 0 ? 1 : p_size);
+}
+
+void operator delete(void *p_ptr) noexcept { free(p_ptr); }
+void operator delete[](void *p_ptr) noexcept { free(p_ptr); }
+void operator delete(void *p_ptr, std::size_t) noexcept { free(p_ptr); }
+void operator delete[](void *p_ptr, std::size_t) noexcept { free(p_ptr); }
+void operator delete(void *p_ptr, const std::nothrow_t &) noexcept { free(p_ptr); }
+void operator delete[](void *p_ptr, const std::nothrow_t &) noexcept { free(p_ptr); }
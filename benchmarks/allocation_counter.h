@@ -0,0 +1,6 @@
+#pragma once
+#include <cstdint>
+
+// Heap allocations made through operator new since the program started. The benchmarks
+// replace the global allocation functions to count them, over-aligned allocations aside
+uint64_t get_allocation_count();
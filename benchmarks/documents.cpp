@@ -0,0 +1,197 @@
+#include "documents.h"
+
+#include <RmlUi/Core/Element.h>
+#include <RmlUi/Core/StringUtilities.h>
+
+// No user agent stylesheet is loaded outside of Godot, so each document brings the basics
+static const char *BASE_STYLE = R"(
+body {
+	display: block;
+	width: 100%;
+	height: 100%;
+	font-family: "Open Sans";
+	font-size: 14dp;
+	color: #202020;
+}
+div, p, h1 { display: block; }
+h1 { font-size: 24dp; }
+)";
+
+static Rml::String make_document(const Rml::String &p_style, const Rml::String &p_body) {
+	return "<rml><head><style>" + Rml::String(BASE_STYLE) + p_style + "</style></head><body>" + p_body + "</body></rml>";
+}
+
+static const char *LOREM =
+	"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore "
+	"magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo "
+	"consequat. Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur.";
+
+// Deep tree: descendant selectors resolved through 256 levels, restyled from the innermost element
+static Rml::String deep_tree_generate() {
+	const int depth = 256;
+	Rml::String body;
+	for (int i = 0; i < depth; i++) {
+		body += Rml::CreateString("<div class=\"level l%d\">", i % 8);
+	}
+	body += "<div id=\"leaf\">leaf</div>";
+	for (int i = 0; i < depth; i++) {
+		body += "</div>";
+	}
+
+	return make_document(R"(
+		.level { padding: 1px; border: 1px #8888; }
+		.l0 .l1 .l2 div { margin-left: 1px; }
+		.level.l3 > .level.l4 { background-color: #eee; }
+		#leaf.active { padding: 4px; font-size: 18dp; }
+	)", body);
+}
+
+static void deep_tree_step(Rml::ElementDocument *p_document, int p_frame) {
+	p_document->GetElementById("leaf")->SetClass("active", p_frame % 2 == 0);
+}
+
+// Long list: thousands of rows inside a scroll container, one row's text changing per frame
+static Rml::String long_list_generate() {
+	const int rows = 2000;
+	Rml::String body = "<div id=\"list\">";
+	for (int i = 0; i < rows; i++) {
+		body += Rml::CreateString(
+			"<div class=\"row\" id=\"row%d\"><span class=\"index\">%d</span><span class=\"label\">Item %d</span></div>",
+			i, i, i
+		);
+	}
+	body += "</div>";
+
+	return make_document(R"(
+		#list { height: 100%; overflow-y: auto; }
+		.row { display: flex; height: 24dp; border-bottom: 1px #ccc; }
+		.row:nth-child(even) { background-color: #f4f4f4; }
+		.index { width: 60dp; text-align: right; padding-right: 8dp; }
+		.label { flex: 1; }
+	)", body);
+}
+
+static void long_list_step(Rml::ElementDocument *p_document, int p_frame) {
+	Rml::Element *row = p_document->GetElementById(Rml::CreateString("row%d", (p_frame * 37) % 2000));
+	row->GetLastChild()->SetInnerRML(Rml::CreateString("Item updated at frame %d", p_frame));
+
+	p_document->GetElementById("list")->SetScrollTop((float)((p_frame * 24) % 40000));
+}
+
+// Flex grid: wrapping flex containers re-laid out as the outer width changes
+static Rml::String flex_grid_generate() {
+	const int cells = 1600;
+	Rml::String body = "<div id=\"grid\">";
+	for (int i = 0; i < cells; i++) {
+		body += Rml::CreateString("<div class=\"cell\"><div class=\"title\">Cell %d</div><div class=\"value\">%d</div></div>", i, i * 7);
+	}
+	body += "</div>";
+
+	return make_document(R"(
+		#grid { display: flex; flex-wrap: wrap; width: 100%; }
+		.cell {
+			display: flex;
+			flex-direction: column;
+			flex: 1 1 80dp;
+			margin: 2dp;
+			padding: 4dp;
+			border: 1px #999;
+			border-radius: 4dp;
+		}
+		.title { flex: 1; font-size: 12dp; }
+		.value { text-align: right; }
+	)", body);
+}
+
+static void flex_grid_step(Rml::ElementDocument *p_document, int p_frame) {
+	p_document->GetElementById("grid")->SetProperty("width", Rml::CreateString("%d%%", 60 + p_frame % 40));
+}
+
+// Heavy text: long paragraphs re-wrapped every frame
+static Rml::String heavy_text_generate() {
+	const int paragraphs = 200;
+	Rml::String body = "<div id=\"text\"><h1>Heavy text</h1>";
+	for (int i = 0; i < paragraphs; i++) {
+		body += Rml::CreateString("<p>%d. %s <em>%s</em> %s</p>", i, LOREM, LOREM, LOREM);
+	}
+	body += "</div>";
+
+	return make_document(R"(
+		#text { width: 100%; }
+		p { margin-bottom: 8dp; line-height: 1.4; }
+		em { color: #555; }
+	)", body);
+}
+
+static void heavy_text_step(Rml::ElementDocument *p_document, int p_frame) {
+	p_document->GetElementById("text")->SetProperty("width", Rml::CreateString("%dpx", 600 + (p_frame % 20) * 20));
+}
+
+// Animations: keyframed transforms, opacity and colors on hundreds of elements
+static Rml::String animations_generate() {
+	const int elements = 400;
+	Rml::String body = "<div id=\"stage\">";
+	for (int i = 0; i < elements; i++) {
+		body += Rml::CreateString("<div class=\"box b%d\"/>", i % 4);
+	}
+	body += "</div>";
+
+	return make_document(R"(
+		@keyframes spin {
+			from { transform: rotate(0deg) scale(1); opacity: 1; }
+			to { transform: rotate(360deg) scale(0.5); opacity: 0.25; }
+		}
+		@keyframes pulse {
+			from { background-color: #3080ff; }
+			to { background-color: #ff8030; }
+		}
+		#stage { display: flex; flex-wrap: wrap; }
+		.box { width: 32dp; height: 32dp; margin: 4dp; background-color: #3080ff; }
+		.b0 { animation: 1s linear infinite spin; }
+		.b1 { animation: 0.7s cubic-in-out infinite alternate pulse; }
+		.b2 { animation: 1.3s elastic-out infinite alternate spin; }
+		.b3 { transition: width 0.5s cubic-out; }
+		.b3.wide { width: 64dp; }
+	)", body);
+}
+
+static void animations_step(Rml::ElementDocument *p_document, int p_frame) {
+	// Restart the transitions every half a second
+	if (p_frame % 30 != 0) return;
+
+	Rml::ElementList boxes;
+	p_document->GetElementsByClassName(boxes, "b3");
+	for (Rml::Element *box : boxes) {
+		box->SetClass("wide", !box->IsClassSet("wide"));
+	}
+}
+
+// Steady: a bit of everything, never touched once loaded
+static Rml::String steady_generate() {
+	const int cards = 200;
+	Rml::String body = "<div id=\"page\">";
+	for (int i = 0; i < cards; i++) {
+		body += Rml::CreateString("<div class=\"card\"><h1>Card %d</h1><p>%s</p></div>", i, LOREM);
+	}
+	body += "</div>";
+
+	return make_document(R"(
+		#page { display: flex; flex-wrap: wrap; height: 100%; overflow-y: auto; }
+		.card { width: 240dp; margin: 4dp; padding: 8dp; border: 1px #aaa; border-radius: 6dp; background-color: #fafafa; }
+		.card h1 { font-size: 16dp; }
+	)", body);
+}
+
+static void steady_step(Rml::ElementDocument *p_document, int p_frame) {}
+
+const std::vector<BenchmarkDocument> &get_benchmark_documents() {
+	static const std::vector<BenchmarkDocument> documents = {
+		{ "deep_tree", "256 nested elements, restyling the innermost", deep_tree_generate, deep_tree_step, false },
+		{ "long_list", "2000 rows in a scroll container, editing and scrolling", long_list_generate, long_list_step, false },
+		{ "flex_grid", "1600 wrapping flex cells, resizing the grid", flex_grid_generate, flex_grid_step, false },
+		{ "heavy_text", "200 long paragraphs, re-wrapping them", heavy_text_generate, heavy_text_step, false },
+		{ "animations", "400 elements with keyframe animations and transitions", animations_generate, animations_step, false },
+		{ "steady", "200 text cards left untouched, frames shouldn't allocate", steady_generate, steady_step, true },
+	};
+	return documents;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <RmlUi/Core/ElementDocument.h>
+#include <RmlUi/Core/Types.h>
+
+#include <vector>
+
+// Synthetic document stressing one part of RmlUi, with a step mutating it between frames
+// so every measured update does the work a live UI would
+struct BenchmarkDocument {
+	const char *name;
+	const char *description;
+	Rml::String (*generate)();
+	void (*step)(Rml::ElementDocument *p_document, int p_frame);
+	// Left untouched between frames, so they should neither allocate nor recompile anything
+	bool steady;
+};
+
+const std::vector<BenchmarkDocument> &get_benchmark_documents();
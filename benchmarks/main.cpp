@@ -0,0 +1,328 @@
+// Standalone RmlUi benchmarks, built with `scons benchmarks=yes`.
+//
+// Runs synthetic documents through Context::Update and Context::Render against a render
+// interface that draws nothing, so the timings track layout and style cost alone. Run it from
+// the repository root, or pass --font with the path of a font file.
+//
+// With --replay, plays back a frame captured in Godot (see RMLServer.context_capture_frame)
+// instead, timing the render calls alone.
+//
+// Heap allocations are counted per frame too. With --check-allocations, the run fails when
+// a steady document, left untouched between frames, allocates once warmed up.
+
+#include <RmlUi/Core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "documents.h"
+#include "null_render_interface.h"
+#include "interface/render_capture.h"
+
+static const char *DEFAULT_FONT = "project/addons/rmlui/fonts/OpenSans-VariableFont_wdth,wght.ttf";
+
+// Time advances by a fixed step per frame, so animations progress the same on every machine
+class BenchmarkSystemInterface: public Rml::SystemInterface {
+public:
+	double time = 0.0;
+
+	double GetElapsedTime() override { return time; }
+
+	bool LogMessage(Rml::Log::Type type, const Rml::String& message) override {
+		if (type <= Rml::Log::LT_WARNING) {
+			fprintf(stderr, "%s\n", message.c_str());
+		}
+		return true;
+	}
+};
+
+struct Options {
+	int frames = 300;
+	int warmup = 10;
+	int width = 1280;
+	int height = 720;
+	const char *filter = nullptr;
+	const char *font = DEFAULT_FONT;
+	const char *replay = nullptr;
+	bool csv = false;
+	bool check_allocations = false;
+};
+
+struct Timing {
+	double total = 0.0;
+	double min = 0.0;
+	double max = 0.0;
+
+	void add(double p_ms, bool p_first) {
+		total += p_ms;
+		min = p_first ? p_ms : std::min(min, p_ms);
+		max = p_first ? p_ms : std::max(max, p_ms);
+	}
+};
+
+struct Result {
+	const BenchmarkDocument *document;
+	double load_ms = 0.0;
+	Timing update;
+	Timing render;
+	uint64_t update_allocations = 0;
+	uint64_t render_allocations = 0;
+	NullRenderInterface::Counters counters;
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point p_start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - p_start).count();
+}
+
+static void print_usage(const char *p_program) {
+	printf(
+		"Usage: %s [options]\n"
+		"  --frames N      measured frames per document (default 300)\n"
+		"  --warmup N      frames run before measuring (default 10)\n"
+		"  --size WxH      context dimensions (default 1280x720)\n"
+		"  --filter NAME   only run documents whose name contains NAME\n"
+		"  --font PATH     font face to load (default %s)\n"
+		"  --csv           print results as CSV\n"
+		"  --check-allocations  fail if steady documents allocate once warmed up\n"
+		"  --replay PATH   replay a render capture instead of the documents\n"
+		"  --list          list the documents and exit\n",
+		p_program, DEFAULT_FONT
+	);
+}
+
+static bool parse_options(int argc, char **argv, Options &r_options) {
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (strcmp(arg, "--frames") == 0 && has_value) {
+			r_options.frames = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(arg, "--warmup") == 0 && has_value) {
+			r_options.warmup = std::max(0, atoi(argv[++i]));
+		} else if (strcmp(arg, "--size") == 0 && has_value) {
+			if (sscanf(argv[++i], "%dx%d", &r_options.width, &r_options.height) != 2) return false;
+		} else if (strcmp(arg, "--filter") == 0 && has_value) {
+			r_options.filter = argv[++i];
+		} else if (strcmp(arg, "--font") == 0 && has_value) {
+			r_options.font = argv[++i];
+		} else if (strcmp(arg, "--replay") == 0 && has_value) {
+			r_options.replay = argv[++i];
+		} else if (strcmp(arg, "--csv") == 0) {
+			r_options.csv = true;
+		} else if (strcmp(arg, "--check-allocations") == 0) {
+			r_options.check_allocations = true;
+		} else if (strcmp(arg, "--list") == 0) {
+			for (const BenchmarkDocument &document : get_benchmark_documents()) {
+				printf("%-12s %s\n", document.name, document.description);
+			}
+			exit(0);
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool run_document(const BenchmarkDocument &p_document, const Options &p_options, BenchmarkSystemInterface &p_system, NullRenderInterface &p_render, Result &r_result) {
+	const double frame_step = 1.0 / 60.0;
+
+	Rml::Context *context = Rml::CreateContext(p_document.name, Rml::Vector2i(p_options.width, p_options.height));
+	if (context == nullptr) return false;
+
+	r_result.document = &p_document;
+
+	// Loading covers parsing, the first style resolution and layout
+	Clock::time_point start = Clock::now();
+	Rml::ElementDocument *document = context->LoadDocumentFromMemory(p_document.generate());
+	if (document == nullptr) {
+		Rml::RemoveContext(p_document.name);
+		return false;
+	}
+	document->Show();
+	context->Update();
+	r_result.load_ms = elapsed_ms(start);
+
+	int frame = 0;
+	for (int i = 0; i < p_options.warmup; i++, frame++) {
+		p_system.time += frame_step;
+		p_document.step(document, frame);
+		context->Update();
+		context->Render();
+	}
+
+	p_render.reset_counters();
+	for (int i = 0; i < p_options.frames; i++, frame++) {
+		p_system.time += frame_step;
+
+		uint64_t allocations = get_allocation_count();
+		start = Clock::now();
+		p_document.step(document, frame);
+		context->Update();
+		r_result.update.add(elapsed_ms(start), i == 0);
+		r_result.update_allocations += get_allocation_count() - allocations;
+
+		allocations = get_allocation_count();
+		start = Clock::now();
+		context->Render();
+		r_result.render.add(elapsed_ms(start), i == 0);
+		r_result.render_allocations += get_allocation_count() - allocations;
+	}
+	r_result.counters = p_render.get_counters();
+
+	Rml::RemoveContext(p_document.name);
+	// Release the document's geometry and textures before the next one starts
+	Rml::ReleaseCompiledGeometry();
+	Rml::ReleaseTextures();
+	return true;
+}
+
+static void print_results(const std::vector<Result> &p_results, const Options &p_options) {
+	double frames = p_options.frames;
+
+	if (p_options.csv) {
+		printf("document,load_ms,update_avg_ms,update_min_ms,update_max_ms,render_avg_ms,render_min_ms,render_max_ms,"
+			"draws_per_frame,vertices_per_frame,geometry_compiled_per_frame,bytes_uploaded_per_frame,largest_geometry_vertices,"
+			"update_allocations_per_frame,render_allocations_per_frame\n");
+		for (const Result &result : p_results) {
+			const NullRenderInterface::Counters &c = result.counters;
+			printf("%s,%.3f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.1f,%.1f,%.2f,%.1f,%llu,%.2f,%.2f\n",
+				result.document->name, result.load_ms,
+				result.update.total / frames, result.update.min, result.update.max,
+				result.render.total / frames, result.render.min, result.render.max,
+				(c.render_geometry + c.shaders_rendered) / frames,
+				c.vertices_rendered / frames,
+				c.compile_geometry / frames,
+				c.bytes_uploaded / frames,
+				(unsigned long long)c.largest_geometry_vertices,
+				result.update_allocations / frames,
+				result.render_allocations / frames
+			);
+		}
+		return;
+	}
+
+	printf("%d frames per document at %dx%d, times in ms\n\n", p_options.frames, p_options.width, p_options.height);
+	printf("%-12s %9s %9s %9s %9s %9s %9s %9s %11s %12s %9s %9s\n",
+		"document", "load", "update", "upd max", "render", "rnd max", "draws", "compiled", "KiB upload", "vertices", "upd alloc", "rnd alloc");
+	for (const Result &result : p_results) {
+		const NullRenderInterface::Counters &c = result.counters;
+		printf("%-12s %9.2f %9.4f %9.4f %9.4f %9.4f %9.1f %9.2f %11.2f %12.1f %9.1f %9.1f\n",
+			result.document->name, result.load_ms,
+			result.update.total / frames, result.update.max,
+			result.render.total / frames, result.render.max,
+			(c.render_geometry + c.shaders_rendered) / frames,
+			c.compile_geometry / frames,
+			c.bytes_uploaded / frames / 1024.0,
+			c.vertices_rendered / frames,
+			result.update_allocations / frames,
+			result.render_allocations / frames
+		);
+	}
+	printf("\nDraws, compiled geometry, uploads, vertices and heap allocations are per frame.\n");
+}
+
+static int run_replay(const Options &p_options) {
+	std::ifstream file(p_options.replay, std::ios::binary);
+	if (!file) {
+		fprintf(stderr, "Couldn't open the capture '%s'\n", p_options.replay);
+		return 1;
+	}
+
+	RenderCapturePlayer player;
+	if (!player.load(std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()))) {
+		return 1;
+	}
+
+	NullRenderInterface render;
+	Timing timing;
+	int64_t command_count = 0;
+	uint64_t allocations = 0;
+	for (int i = 0; i < p_options.warmup + p_options.frames; i++) {
+		render.reset_counters();
+		uint64_t start_allocations = get_allocation_count();
+		Clock::time_point start = Clock::now();
+		command_count = player.replay(&render);
+		if (command_count < 0) return 1;
+		if (i >= p_options.warmup) {
+			timing.add(elapsed_ms(start), i == p_options.warmup);
+			allocations += get_allocation_count() - start_allocations;
+		}
+	}
+
+	const NullRenderInterface::Counters &c = render.get_counters();
+	printf("%s: %dx%d, %lld commands, %llu draws, %llu geometry compiled, %.2f KiB uploaded\n",
+		p_options.replay, player.get_size().x, player.get_size().y, (long long)command_count,
+		(unsigned long long)(c.render_geometry + c.shaders_rendered),
+		(unsigned long long)c.compile_geometry,
+		c.bytes_uploaded / 1024.0
+	);
+	printf("replay: %.4f ms avg, %.4f ms min, %.4f ms max over %d frames, %.1f heap allocations per frame\n",
+		timing.total / p_options.frames, timing.min, timing.max, p_options.frames, (double)allocations / p_options.frames);
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	Options options;
+	if (!parse_options(argc, argv, options)) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (options.replay != nullptr) {
+		return run_replay(options);
+	}
+
+	BenchmarkSystemInterface system;
+	NullRenderInterface render;
+
+	Rml::SetSystemInterface(&system);
+	Rml::SetRenderInterface(&render);
+	if (!Rml::Initialise()) {
+		fprintf(stderr, "Couldn't initialise RmlUi\n");
+		return 1;
+	}
+
+	if (!Rml::LoadFontFace(options.font, true)) {
+		fprintf(stderr, "Couldn't load the font '%s', see --font\n", options.font);
+		Rml::Shutdown();
+		return 1;
+	}
+
+	std::vector<Result> results;
+	for (const BenchmarkDocument &document : get_benchmark_documents()) {
+		if (options.filter != nullptr && strstr(document.name, options.filter) == nullptr) continue;
+
+		Result result;
+		if (!run_document(document, options, system, render, result)) {
+			fprintf(stderr, "Couldn't run the document '%s'\n", document.name);
+			continue;
+		}
+		results.push_back(result);
+	}
+
+	print_results(results, options);
+
+	bool allocations_failed = false;
+	if (options.check_allocations) {
+		for (const Result &result : results) {
+			if (!result.document->steady) continue;
+			if (result.update_allocations + result.render_allocations > 0) {
+				fprintf(stderr, "%s: %llu heap allocations over %d steady frames\n", result.document->name,
+					(unsigned long long)(result.update_allocations + result.render_allocations), options.frames);
+				allocations_failed = true;
+			}
+		}
+	}
+
+	Rml::Shutdown();
+	return results.empty() || allocations_failed ? 1 : 0;
+}
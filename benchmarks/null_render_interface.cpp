@@ -0,0 +1,98 @@
+#include "null_render_interface.h"
+
+#include <algorithm>
+
+Rml::CompiledGeometryHandle NullRenderInterface::CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) {
+	counters.compile_geometry++;
+	counters.vertices_compiled += vertices.size();
+	counters.indices_compiled += indices.size();
+	counters.bytes_uploaded += vertices.size() * sizeof(Rml::Vertex) + indices.size() * sizeof(int);
+	counters.largest_geometry_vertices = std::max<uint64_t>(counters.largest_geometry_vertices, vertices.size());
+
+	Geometry *geometry = new Geometry{ vertices.size(), indices.size() };
+	return reinterpret_cast<uintptr_t>(geometry);
+}
+
+void NullRenderInterface::RenderGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) {
+	counters.render_geometry++;
+	counters.vertices_rendered += reinterpret_cast<Geometry *>(geometry)->vertex_count;
+}
+
+void NullRenderInterface::ReleaseGeometry(Rml::CompiledGeometryHandle geometry) {
+	counters.release_geometry++;
+	delete reinterpret_cast<Geometry *>(geometry);
+}
+
+Rml::TextureHandle NullRenderInterface::LoadTexture(Rml::Vector2i& texture_dimensions, const Rml::String& source) {
+	// Benchmarks don't ship images, every file texture is a 1x1 placeholder
+	counters.load_texture++;
+	counters.bytes_uploaded += 4;
+	texture_dimensions = Rml::Vector2i(1, 1);
+	return next_texture++;
+}
+
+Rml::TextureHandle NullRenderInterface::GenerateTexture(Rml::Span<const Rml::byte> source, Rml::Vector2i source_dimensions) {
+	counters.generate_texture++;
+	counters.bytes_uploaded += source.size();
+	return next_texture++;
+}
+
+void NullRenderInterface::ReleaseTexture(Rml::TextureHandle texture) {
+	counters.release_texture++;
+}
+
+void NullRenderInterface::EnableScissorRegion(bool enable) {
+	counters.scissor_changes++;
+}
+
+void NullRenderInterface::SetScissorRegion(Rml::Rectanglei region) {
+	counters.scissor_changes++;
+}
+
+void NullRenderInterface::EnableClipMask(bool enable) {}
+
+void NullRenderInterface::RenderToClipMask(Rml::ClipMaskOperation operation, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation) {
+	counters.clip_mask_renders++;
+}
+
+void NullRenderInterface::SetTransform(const Rml::Matrix4f* transform) {
+	counters.transform_changes++;
+}
+
+Rml::LayerHandle NullRenderInterface::PushLayer() {
+	counters.layers_pushed++;
+	return next_handle++;
+}
+
+void NullRenderInterface::CompositeLayers(Rml::LayerHandle source, Rml::LayerHandle destination, Rml::BlendMode blend_mode, Rml::Span<const Rml::CompiledFilterHandle> filters) {
+	counters.layers_composited++;
+}
+
+void NullRenderInterface::PopLayer() {}
+
+Rml::TextureHandle NullRenderInterface::SaveLayerAsTexture() {
+	return next_texture++;
+}
+
+Rml::CompiledFilterHandle NullRenderInterface::SaveLayerAsMaskImage() {
+	return next_handle++;
+}
+
+Rml::CompiledFilterHandle NullRenderInterface::CompileFilter(const Rml::String& name, const Rml::Dictionary& parameters) {
+	counters.filters_compiled++;
+	return next_handle++;
+}
+
+void NullRenderInterface::ReleaseFilter(Rml::CompiledFilterHandle filter) {}
+
+Rml::CompiledShaderHandle NullRenderInterface::CompileShader(const Rml::String& name, const Rml::Dictionary& parameters) {
+	counters.shaders_compiled++;
+	return next_handle++;
+}
+
+void NullRenderInterface::RenderShader(Rml::CompiledShaderHandle shader, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) {
+	counters.shaders_rendered++;
+	counters.vertices_rendered += reinterpret_cast<Geometry *>(geometry)->vertex_count;
+}
+
+void NullRenderInterface::ReleaseShader(Rml::CompiledShaderHandle shader) {}
@@ -0,0 +1,78 @@
+#pragma once
+#include <RmlUi/Core/RenderInterface.h>
+
+#include <cstdint>
+
+// Render interface that draws nothing, only counting what RmlUi asks of it so the
+// benchmarks measure layout and style cost without a GPU in the loop
+class NullRenderInterface: public Rml::RenderInterface {
+public:
+	struct Counters {
+		uint64_t compile_geometry = 0;
+		uint64_t release_geometry = 0;
+		uint64_t render_geometry = 0;
+		uint64_t generate_texture = 0;
+		uint64_t load_texture = 0;
+		uint64_t release_texture = 0;
+		uint64_t scissor_changes = 0;
+		uint64_t clip_mask_renders = 0;
+		uint64_t transform_changes = 0;
+		uint64_t layers_pushed = 0;
+		uint64_t layers_composited = 0;
+		uint64_t filters_compiled = 0;
+		uint64_t shaders_compiled = 0;
+		uint64_t shaders_rendered = 0;
+
+		// Vertex, index and texture data handed over, as a GPU renderer would upload it
+		uint64_t bytes_uploaded = 0;
+		uint64_t vertices_compiled = 0;
+		uint64_t indices_compiled = 0;
+		uint64_t largest_geometry_vertices = 0;
+		// Vertices that went through a draw, counting repeated draws of the same geometry
+		uint64_t vertices_rendered = 0;
+	};
+
+private:
+	struct Geometry {
+		uint64_t vertex_count;
+		uint64_t index_count;
+	};
+
+	Counters counters;
+	uint64_t next_texture = 1;
+	uint64_t next_handle = 1;
+
+public:
+	const Counters &get_counters() const { return counters; }
+	void reset_counters() { counters = Counters(); }
+
+	Rml::CompiledGeometryHandle CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) override;
+	void RenderGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) override;
+	void ReleaseGeometry(Rml::CompiledGeometryHandle geometry) override;
+
+	Rml::TextureHandle LoadTexture(Rml::Vector2i& texture_dimensions, const Rml::String& source) override;
+	Rml::TextureHandle GenerateTexture(Rml::Span<const Rml::byte> source, Rml::Vector2i source_dimensions) override;
+	void ReleaseTexture(Rml::TextureHandle texture) override;
+
+	void EnableScissorRegion(bool enable) override;
+	void SetScissorRegion(Rml::Rectanglei region) override;
+
+	void EnableClipMask(bool enable) override;
+	void RenderToClipMask(Rml::ClipMaskOperation operation, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation) override;
+
+	void SetTransform(const Rml::Matrix4f* transform) override;
+
+	Rml::LayerHandle PushLayer() override;
+	void CompositeLayers(Rml::LayerHandle source, Rml::LayerHandle destination, Rml::BlendMode blend_mode, Rml::Span<const Rml::CompiledFilterHandle> filters) override;
+	void PopLayer() override;
+
+	Rml::TextureHandle SaveLayerAsTexture() override;
+	Rml::CompiledFilterHandle SaveLayerAsMaskImage() override;
+
+	Rml::CompiledFilterHandle CompileFilter(const Rml::String& name, const Rml::Dictionary& parameters) override;
+	void ReleaseFilter(Rml::CompiledFilterHandle filter) override;
+
+	Rml::CompiledShaderHandle CompileShader(const Rml::String& name, const Rml::Dictionary& parameters) override;
+	void RenderShader(Rml::CompiledShaderHandle shader, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) override;
+	void ReleaseShader(Rml::CompiledShaderHandle shader) override;
+};
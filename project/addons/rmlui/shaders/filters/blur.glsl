@@ -1,56 +1,36 @@
-#[vertex]
+#[compute]
 #version 450 core
 
-vec2 uvs[3] = vec2[](
-	vec2(0, 0), vec2(2, 0), vec2(0, 2)
-);
+#include "blur.glsl.inc"
 
-void main() {
-	vec2 uv = uvs[gl_VertexIndex];
-	gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
-}
-
-#[fragment]
-#version 450 core
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
 
 layout(set = 0, binding = 0) uniform sampler2D source;
 
-layout(location = 0) out vec4 o_color;
+// Offset and weight of each tap, the first is the center and the others
+// are mirrored, placed between two texels to get both with one fetch
+layout(set = 0, binding = 1, std430) restrict readonly buffer Kernel {
+	vec2 taps[];
+} kernel;
 
-layout(push_constant, std430) uniform FilterParams {
-	vec2 dir;
-	vec2 off;
-	float sigma;
-} params;
+layout(rgba8, set = 0, binding = 2) uniform restrict writeonly image2D destination;
 
 void main() {
-	vec2 tex_size = textureSize(source, 0);
-	vec2 inv_tex_size = 1.0 / tex_size;
-	vec2 uv = (gl_FragCoord.xy - params.off) * inv_tex_size;
-	vec2 dir = params.dir * inv_tex_size;
-	float inv_sig = 1.0 / params.sigma;
-
-	vec3 color = vec3(0.0);
-	float alpha = 0.0;
-	
-	float color_weight = 0.0;
-	float alpha_weight = 0.0;
-
-	for (float t = -params.sigma; t <= params.sigma; t += 1.0) {
-		float w = 1.0 - pow(t * inv_sig, 2.0);
-
-		vec2 new_uv = uv + dir * t;
-		bool outside = new_uv.x < 0.0 || new_uv.x > 1.0 || new_uv.y < 0.0 || new_uv.y > 1.0;
-		vec4 pix = !outside ? texture(source, uv + dir * t) : vec4(0.0);
-		bool transparent = pix.a <= 0.0;
-
-		color = transparent ? color : color + pix.rgb * w;
-		alpha = alpha + pix.a * w;
-
-		color_weight = transparent ? color_weight : color_weight + w;
-		alpha_weight = alpha_weight + w;
+	ivec2 texel = blur_region_start() + ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(texel, blur_region_end()))) {
+		return;
 	}
 
-	o_color.rgb = color_weight > 0.0 ? color / color_weight : vec3(0.0);
-	o_color.a = alpha_weight > 0.0 ? alpha / alpha_weight : 0.0;
-}
\ No newline at end of file
+	float scale = float(params.scale);
+	vec2 center = vec2(texel) + 0.5;
+
+	// Colors are premultiplied, so they can be averaged as is
+	vec4 color = sample_region(source, center, scale) * kernel.taps[0].y;
+	for (uint i = 1; i < params.tap_count; i++) {
+		vec2 off = params.dir * kernel.taps[i].x;
+		color += sample_region(source, center + off, scale) * kernel.taps[i].y;
+		color += sample_region(source, center - off, scale) * kernel.taps[i].y;
+	}
+
+	imageStore(destination, texel, color);
+}
@@ -0,0 +1,29 @@
+#[compute]
+#version 450 core
+
+#include "blur.glsl.inc"
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+layout(rgba8, set = 0, binding = 1) uniform restrict writeonly image2D destination;
+
+void main() {
+	ivec2 texel = blur_region_start() + ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(texel, blur_region_end()))) {
+		return;
+	}
+
+	float scale = float(params.scale);
+	vec2 center = (vec2(texel) + 0.5) * scale;
+	// Each bilinear fetch averages a quarter of the box covered by the texel
+	float q = scale * 0.25;
+
+	vec4 color = vec4(0.0);
+	color += sample_region(source, center + vec2(-q, -q), 1.0);
+	color += sample_region(source, center + vec2( q, -q), 1.0);
+	color += sample_region(source, center + vec2(-q,  q), 1.0);
+	color += sample_region(source, center + vec2( q,  q), 1.0);
+
+	imageStore(destination, texel, color * 0.25);
+}
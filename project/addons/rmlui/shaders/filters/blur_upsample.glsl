@@ -0,0 +1,27 @@
+#[vertex]
+#version 450 core
+
+vec2 uvs[3] = vec2[](
+	vec2(0, 0), vec2(2, 0), vec2(0, 2)
+);
+
+void main() {
+	vec2 uv = uvs[gl_VertexIndex];
+	gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#[fragment]
+#version 450 core
+
+#include "blur.glsl.inc"
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+
+layout(location = 0) out vec4 o_color;
+
+void main() {
+	float scale = float(params.scale);
+	vec2 pos = (gl_FragCoord.xy - params.offset) / scale;
+
+	o_color = sample_region(source, pos, scale);
+}
@@ -10,11 +10,17 @@ layout(location = 1) out vec4 o_color;
 
 layout(push_constant, std430) uniform GeometryData {
 	vec2 inv_viewport_size;
+	uint instance_offset;
 	mat4 transform;
 } geometry_data;
 
+// Translation of each instance, repeated draws of the same geometry are instanced
+layout(set = 0, binding = 1, std430) restrict readonly buffer Instances {
+	vec2 translations[];
+} instances;
+
 void main() {
-	vec2 pos = i_vertex_position;
+	vec2 pos = i_vertex_position + instances.translations[geometry_data.instance_offset + gl_InstanceIndex];
 	pos = (geometry_data.transform * vec4(pos, 0.0, 1.0)).xy;
 
 	vec2 screen_uv = pos * geometry_data.inv_viewport_size;
@@ -35,6 +41,7 @@ layout(location = 0) out vec4 o_color;
 
 layout(push_constant, std430) uniform GeometryData {
 	vec2 inv_viewport_size;
+	uint instance_offset;
 	mat4 transform;
 } geometry_data;
 
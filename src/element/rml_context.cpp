@@ -0,0 +1,111 @@
+#include <godot_cpp/classes/input_event_mouse_motion.hpp>
+
+#include "../server/rml_server.h"
+#include "rml_context.h"
+
+using namespace godot;
+
+void RMLContext::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_ENTER_TREE: {
+			RMLServer::get_singleton()->context_set_size(rid, Vector2i(
+				get_size().x,
+				get_size().y
+			));
+			set_process(true);
+		} break;
+		case NOTIFICATION_EXIT_TREE: {
+			set_process(false);
+		} break;
+		case NOTIFICATION_PROCESS: {
+			if (RMLServer::get_singleton()->context_update(rid)) {
+				queue_redraw();
+			}
+		} break;
+		case NOTIFICATION_DRAW: {
+			RMLServer::get_singleton()->context_draw(rid, get_canvas_item());
+		} break;
+		case NOTIFICATION_RESIZED: {
+			RMLServer::get_singleton()->context_set_size(rid, Vector2i(
+				get_size().x,
+				get_size().y
+			));
+		} break;
+		case NOTIFICATION_MOUSE_EXIT: {
+			Ref<InputEventMouseMotion> mm;
+			mm.instantiate();
+			mm->set_position(Vector2(INFINITY, INFINITY));
+			RMLServer::get_singleton()->context_process_event(rid, mm);
+		} break;
+	}
+}
+
+void RMLContext::_gui_input(const Ref<InputEvent> &p_event) {
+	if (RMLServer::get_singleton()->context_process_event(rid, p_event)) {
+		accept_event();
+		Control::CursorShape new_shape = (Control::CursorShape)RMLServer::get_singleton()->context_get_cursor_shape(rid);
+		set_default_cursor_shape(new_shape);
+	}
+}
+
+RID RMLContext::get_rid() const {
+	return rid;
+}
+
+void RMLContext::update() {
+	RMLServer::get_singleton()->context_update(rid);
+}
+
+void RMLContext::set_redraw_mode(RMLServer::RedrawMode p_mode) {
+	redraw_mode = p_mode;
+	RMLServer::get_singleton()->context_set_redraw_mode(rid, redraw_mode);
+}
+
+RMLServer::RedrawMode RMLContext::get_redraw_mode() const {
+	return redraw_mode;
+}
+
+void RMLContext::set_update_mode(RMLServer::UpdateMode p_mode) {
+	update_mode = p_mode;
+	RMLServer::get_singleton()->context_set_update_mode(rid, update_mode);
+}
+
+RMLServer::UpdateMode RMLContext::get_update_mode() const {
+	return update_mode;
+}
+
+void RMLContext::set_direct_rendering(bool p_enabled) {
+	direct_rendering = p_enabled;
+	RMLServer::get_singleton()->context_set_direct_rendering(rid, direct_rendering);
+}
+
+bool RMLContext::is_direct_rendering() const {
+	return direct_rendering;
+}
+
+void RMLContext::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_rid"), &RMLContext::get_rid);
+	ClassDB::bind_method(D_METHOD("update"), &RMLContext::update);
+
+	ClassDB::bind_method(D_METHOD("set_redraw_mode", "mode"), &RMLContext::set_redraw_mode);
+	ClassDB::bind_method(D_METHOD("get_redraw_mode"), &RMLContext::get_redraw_mode);
+	ClassDB::bind_method(D_METHOD("set_update_mode", "mode"), &RMLContext::set_update_mode);
+	ClassDB::bind_method(D_METHOD("get_update_mode"), &RMLContext::get_update_mode);
+	ClassDB::bind_method(D_METHOD("set_direct_rendering", "enabled"), &RMLContext::set_direct_rendering);
+	ClassDB::bind_method(D_METHOD("is_direct_rendering"), &RMLContext::is_direct_rendering);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "redraw_mode", PROPERTY_HINT_ENUM, "Always,When Changed"), "set_redraw_mode", "get_redraw_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "update_mode", PROPERTY_HINT_ENUM, "Always,When Needed"), "set_update_mode", "get_update_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "direct_rendering"), "set_direct_rendering", "is_direct_rendering");
+}
+
+RMLContext::RMLContext() {
+	set_focus_mode(FocusMode::FOCUS_ALL);
+	rid = RMLServer::get_singleton()->create_context();
+}
+
+RMLContext::~RMLContext() {
+	if (rid.is_valid()) {
+		RMLServer::get_singleton()->free_rid(rid);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <godot_cpp/classes/input_event.hpp>
+#include <godot_cpp/classes/control.hpp>
+#include <RmlUi/Core.h>
+
+#include "../server/rml_server.h"
+
+
+namespace godot {
+
+class RMLContext : public Control {
+	GDCLASS(RMLContext, Control)
+
+protected:
+	RID rid = RID();
+	RMLServer::RedrawMode redraw_mode = RMLServer::REDRAW_MODE_ALWAYS;
+	RMLServer::UpdateMode update_mode = RMLServer::UPDATE_MODE_ALWAYS;
+	bool direct_rendering = false;
+
+	static void _bind_methods();
+
+public:
+	void _notification(int p_what);
+	void _gui_input(const Ref<InputEvent> &p_event) override;
+
+	RID get_rid() const;
+	void update();
+
+	void set_redraw_mode(RMLServer::RedrawMode p_mode);
+	RMLServer::RedrawMode get_redraw_mode() const;
+
+	void set_update_mode(RMLServer::UpdateMode p_mode);
+	RMLServer::UpdateMode get_update_mode() const;
+
+	void set_direct_rendering(bool p_enabled);
+	bool is_direct_rendering() const;
+
+	RMLContext();
+	~RMLContext();
+};
+
+}
@@ -5,6 +5,7 @@
 #include <godot_cpp/classes/input_event_key.hpp>
 
 #include "../server/rml_server.h"
+#include "rml_context.h"
 #include "rml_element.h"
 #include "rml_document.h"
 
@@ -14,30 +15,39 @@ using namespace godot;
 
 void RMLDocument::_notification(int p_what) {
 	switch (p_what) {
+		case NOTIFICATION_PARENTED:
+		case NOTIFICATION_UNPARENTED: {
+			update_context();
+		} break;
 		case NOTIFICATION_ENTER_TREE: {
-			RMLServer::get_singleton()->document_set_size(rid, Vector2i(
-				get_size().x,
-				get_size().y
-			));
-			set_process(true);
+			apply_document_settings();
+			// Documents sharing a context are updated and drawn by their RMLContext
+			set_process(!is_context_shared());
 		} break;
 		case NOTIFICATION_EXIT_TREE: {
 			set_process(false);
 		} break;
 		case NOTIFICATION_PROCESS: {
-			update();
-			queue_redraw();
+			// Idle documents keep drawing the last rendered frame
+			if (RMLServer::get_singleton()->document_update(rid)) {
+				queue_redraw();
+			}
 		} break;
 		case NOTIFICATION_DRAW: {
-			RMLServer::get_singleton()->document_draw(rid, get_canvas_item());
+			if (!is_context_shared()) {
+				RMLServer::get_singleton()->document_draw(rid, get_canvas_item());
+			}
 		} break;
-		case NOTIFICATION_RESIZED: {
-			RMLServer::get_singleton()->document_set_size(rid, Vector2i(
-				get_size().x,
-				get_size().y
-			));
+		case NOTIFICATION_RESIZED:
+		case NOTIFICATION_LOCAL_TRANSFORM_CHANGED:
+		case NOTIFICATION_MOVED_IN_PARENT: {
+			apply_document_settings();
 		} break;
 		case NOTIFICATION_MOUSE_EXIT: {
+			// The RMLContext notifies the shared context once the mouse leaves it
+			if (is_context_shared()) {
+				break;
+			}
 			Ref<InputEventMouseMotion> mm;
 			mm.instantiate();
 			mm->set_position(Vector2(INFINITY, INFINITY));
@@ -50,46 +60,134 @@ void RMLDocument::_notification(int p_what) {
 }
 
 void RMLDocument::_gui_input(const Ref<InputEvent> &p_event) {
-	if (RMLServer::get_singleton()->document_process_event(rid, p_event)) {
+	// Shared contexts expect positions relative to the RMLContext
+	Ref<InputEvent> event = is_context_shared() ? p_event->xformed_by(get_transform()) : p_event;
+	if (RMLServer::get_singleton()->document_process_event(rid, event)) {
 		accept_event();
 		Control::CursorShape new_shape = (Control::CursorShape)RMLServer::get_singleton()->document_get_cursor_shape(rid);
 		set_default_cursor_shape(new_shape);
 	}
 }
 
-void RMLDocument::new_document() {
+void RMLDocument::create_document() {
 	if (rid.is_valid()) {
 		RMLServer::get_singleton()->free_rid(rid);
 	}
-	rid = RMLServer::get_singleton()->create_document();
-	RMLServer::get_singleton()->document_set_size(rid, get_size());
+	elements_accessed = false;
+	switch (source) {
+		case SOURCE_EMPTY: {
+			rid = RMLServer::get_singleton()->create_document(context);
+		} break;
+		case SOURCE_RML_STRING: {
+			rid = RMLServer::get_singleton()->create_document_from_rml_string(source_data, context);
+		} break;
+		case SOURCE_PATH: {
+			rid = RMLServer::get_singleton()->create_document_from_path(source_data, context);
+		} break;
+	}
+	apply_document_settings();
 }
 
-void RMLDocument::load_from_rml_string(const String &p_rml) {
-	if (rid.is_valid()) {
-		RMLServer::get_singleton()->free_rid(rid);
+void RMLDocument::apply_document_settings() {
+	if (!rid.is_valid()) {
+		return;
+	}
+	if (is_context_shared()) {
+		set_notify_local_transform(true);
+		RMLServer::get_singleton()->document_set_rect(rid, Rect2i(get_position(), get_size()));
+		RMLServer::get_singleton()->document_set_z_index(rid, get_index());
+	} else {
+		set_notify_local_transform(false);
+		RMLServer::get_singleton()->document_set_size(rid, get_size());
+		RMLServer::get_singleton()->document_set_redraw_mode(rid, redraw_mode);
+		RMLServer::get_singleton()->document_set_update_mode(rid, update_mode);
+		RMLServer::get_singleton()->document_set_direct_rendering(rid, direct_rendering);
 	}
-	rid = RMLServer::get_singleton()->create_document_from_rml_string(p_rml);
-	RMLServer::get_singleton()->document_set_size(rid, get_size());
 }
 
-void RMLDocument::load_from_path(const String &p_path) {
-	if (rid.is_valid()) {
-		RMLServer::get_singleton()->free_rid(rid);
+void RMLDocument::update_context() {
+	RMLContext *parent_context = Object::cast_to<RMLContext>(get_parent());
+	RID new_context = parent_context != nullptr ? parent_context->get_rid() : RID();
+	if (new_context == context) {
+		return;
+	}
+
+	// Documents can't move between contexts, so they are loaded again from the same source,
+	// changes made to the previous DOM are lost
+	if (rid.is_valid() && elements_accessed) {
+		WARN_PRINT(vformat("RMLDocument '%s' moved %s an RMLContext and was reloaded from its source, changes made to its elements are lost and RMLElement references to them are no longer valid.", get_name(), new_context.is_valid() ? "into" : "out of"));
 	}
-	rid = RMLServer::get_singleton()->create_document_from_path(p_path);
-	RMLServer::get_singleton()->document_set_size(rid, get_size());
+	context = new_context;
+	create_document();
+	queue_redraw();
+}
+
+void RMLDocument::new_document() {
+	source = SOURCE_EMPTY;
+	source_data = String();
+	create_document();
+}
+
+void RMLDocument::load_from_rml_string(const String &p_rml) {
+	source = SOURCE_RML_STRING;
+	source_data = p_rml;
+	create_document();
+}
+
+void RMLDocument::load_from_path(const String &p_path) {
+	source = SOURCE_PATH;
+	source_data = p_path;
+	create_document();
 }
 
 void RMLDocument::update() {
 	RMLServer::get_singleton()->document_update(rid);
 }
 
+bool RMLDocument::is_context_shared() const {
+	return context.is_valid();
+}
+
+void RMLDocument::set_redraw_mode(RMLServer::RedrawMode p_mode) {
+	redraw_mode = p_mode;
+	if (rid.is_valid() && !is_context_shared()) {
+		RMLServer::get_singleton()->document_set_redraw_mode(rid, redraw_mode);
+	}
+}
+
+RMLServer::RedrawMode RMLDocument::get_redraw_mode() const {
+	return redraw_mode;
+}
+
+void RMLDocument::set_update_mode(RMLServer::UpdateMode p_mode) {
+	update_mode = p_mode;
+	if (rid.is_valid() && !is_context_shared()) {
+		RMLServer::get_singleton()->document_set_update_mode(rid, update_mode);
+	}
+}
+
+RMLServer::UpdateMode RMLDocument::get_update_mode() const {
+	return update_mode;
+}
+
+void RMLDocument::set_direct_rendering(bool p_enabled) {
+	direct_rendering = p_enabled;
+	if (rid.is_valid() && !is_context_shared()) {
+		RMLServer::get_singleton()->document_set_direct_rendering(rid, direct_rendering);
+	}
+}
+
+bool RMLDocument::is_direct_rendering() const {
+	return direct_rendering;
+}
+
 Ref<RMLElement> RMLDocument::as_element() const {
+	elements_accessed = true;
 	return RMLServer::get_singleton()->get_document_root(rid);
 }
 
 Ref<RMLElement> RMLDocument::create_element(const String &p_tag_name) const {
+	elements_accessed = true;
 	return RMLServer::get_singleton()->create_element(rid, p_tag_name);
 }
 
@@ -98,9 +196,21 @@ void RMLDocument::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("load_from_rml_string", "rml_string"), &RMLDocument::load_from_rml_string);
 	ClassDB::bind_method(D_METHOD("load_from_path", "path"), &RMLDocument::load_from_path);
 	ClassDB::bind_method(D_METHOD("update"), &RMLDocument::update);
+	ClassDB::bind_method(D_METHOD("is_context_shared"), &RMLDocument::is_context_shared);
+
+	ClassDB::bind_method(D_METHOD("set_redraw_mode", "mode"), &RMLDocument::set_redraw_mode);
+	ClassDB::bind_method(D_METHOD("get_redraw_mode"), &RMLDocument::get_redraw_mode);
+	ClassDB::bind_method(D_METHOD("set_update_mode", "mode"), &RMLDocument::set_update_mode);
+	ClassDB::bind_method(D_METHOD("get_update_mode"), &RMLDocument::get_update_mode);
+	ClassDB::bind_method(D_METHOD("set_direct_rendering", "enabled"), &RMLDocument::set_direct_rendering);
+	ClassDB::bind_method(D_METHOD("is_direct_rendering"), &RMLDocument::is_direct_rendering);
 
 	ClassDB::bind_method(D_METHOD("as_element"), &RMLDocument::as_element);
 	ClassDB::bind_method(D_METHOD("create_element", "tag_name"), &RMLDocument::create_element);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "redraw_mode", PROPERTY_HINT_ENUM, "Always,When Changed"), "set_redraw_mode", "get_redraw_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "update_mode", PROPERTY_HINT_ENUM, "Always,When Needed"), "set_update_mode", "get_update_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "direct_rendering"), "set_direct_rendering", "is_direct_rendering");
 }
 
 RMLDocument::RMLDocument() { 
@@ -5,6 +5,7 @@
 #include <godot_cpp/templates/hash_map.hpp>
 #include <RmlUi/Core.h>
 
+#include "../server/rml_server.h"
 
 
 namespace godot {
@@ -14,8 +15,28 @@ class RMLElement;
 class RMLDocument : public Control {
 	GDCLASS(RMLDocument, Control)
 
+	enum Source {
+		SOURCE_EMPTY,
+		SOURCE_RML_STRING,
+		SOURCE_PATH
+	};
+
 protected:
 	RID rid = RID();
+	RMLServer::RedrawMode redraw_mode = RMLServer::REDRAW_MODE_ALWAYS;
+	RMLServer::UpdateMode update_mode = RMLServer::UPDATE_MODE_ALWAYS;
+	bool direct_rendering = false;
+
+	// Context of the parent RMLContext, invalid when the document has its own
+	RID context = RID();
+	Source source = SOURCE_EMPTY;
+	String source_data;
+	// Set once scripts got hold of elements, which is the only way to change the DOM
+	mutable bool elements_accessed = false;
+
+	void create_document();
+	void apply_document_settings();
+	void update_context();
 
 	static void _bind_methods();
 
@@ -27,6 +48,16 @@ public:
 	void load_from_rml_string(const String &p_rml);
 	void load_from_path(const String &p_path);
 	void update();
+	bool is_context_shared() const;
+
+	void set_redraw_mode(RMLServer::RedrawMode p_mode);
+	RMLServer::RedrawMode get_redraw_mode() const;
+
+	void set_update_mode(RMLServer::UpdateMode p_mode);
+	RMLServer::UpdateMode get_update_mode() const;
+
+	void set_direct_rendering(bool p_enabled);
+	bool is_direct_rendering() const;
 
 	Ref<RMLElement> as_element() const;
 	Ref<RMLElement> create_element(const String &p_tag_name) const;
@@ -13,6 +13,14 @@ using namespace godot;
 #define ENSURE_VALID_V(ref, val) if (ref == nullptr || !ref->element.is_valid()) { return val; }
 #endif
 
+void RMLElement::request_update() const {
+	// Documents that only update when needed must know the DOM changed
+	Rml::Context *ctx = element->GetContext();
+	if (ctx != nullptr) {
+		ctx->RequestNextUpdate(0);
+	}
+}
+
 bool RMLElement::is_valid() const {
 	return this->element.is_valid();
 }
@@ -23,6 +31,7 @@ void RMLElement::append_child(const Ref<RMLElement> &p_child) {
 	ERR_FAIL_COND(p_child->element->GetParentNode() != nullptr);
 	
 	element->AppendChild(p_child->element.pop_owned());
+	request_update();
 }
 
 void RMLElement::remove_child(const Ref<RMLElement> &p_child) {
@@ -32,6 +41,7 @@ void RMLElement::remove_child(const Ref<RMLElement> &p_child) {
 
 	Rml::ElementPtr el = element->RemoveChild(p_child->element.get());
 	p_child->element.push_owner(std::move(el));
+	request_update();
 }
 
 Ref<RMLElement> RMLElement::query_selector(const String &p_selector) const {
@@ -89,6 +99,7 @@ void RMLElement::clear_children() {
 	for (int i = count - 1; i >= 0; i--) {
 		element->RemoveChild(element->GetChild(i));
 	}
+	request_update();
 }
 
 Rect2 RMLElement::get_rect() const {
@@ -115,6 +126,7 @@ void RMLElement::set_attribute(const String &p_name, const Variant &p_val) {
 		godot_to_rml_string(p_name), 
 		godot_to_rml_variant(p_val)
 	);
+	request_update();
 }
 
 Variant RMLElement::get_attribute(const String &p_name, const Variant &p_default) const {
@@ -128,6 +140,7 @@ Variant RMLElement::get_attribute(const String &p_name, const Variant &p_default
 void RMLElement::remove_attribute(const String &p_name) {
 	ENSURE_VALID(this);
 	element->RemoveAttribute(godot_to_rml_string(p_name));
+	request_update();
 }
 
 void RMLElement::set_property(const String &p_name, const String &p_val) {
@@ -136,6 +149,7 @@ void RMLElement::set_property(const String &p_name, const String &p_val) {
 		godot_to_rml_string(p_name), 
 		godot_to_rml_string(p_val)
 	);
+	request_update();
 }
 
 String RMLElement::get_property(const String &p_name, const String &p_default) const {
@@ -150,6 +164,7 @@ String RMLElement::get_property(const String &p_name, const String &p_default) c
 void RMLElement::remove_property(const String &p_name) {
 	ENSURE_VALID(this);
 	element->RemoveProperty(godot_to_rml_string(p_name));
+	request_update();
 }
 
 void RMLElement::add_event_listener(const String &p_event_id, const Callable &p_listener) {
@@ -170,6 +185,7 @@ void RMLElement::remove_event_listener(const String &p_event_id, const Callable
 void RMLElement::set_id(const String &p_id) {
 	ENSURE_VALID(this);
 	element->SetId(godot_to_rml_string(p_id));
+	request_update();
 }
 
 String RMLElement::get_id() const {
@@ -180,21 +196,25 @@ String RMLElement::get_id() const {
 void RMLElement::toggle_class(const String &p_class) {
 	ENSURE_VALID(this);
 	element->SetClass(godot_to_rml_string(p_class), !element->IsClassSet(godot_to_rml_string(p_class)));
+	request_update();
 }
 
 void RMLElement::set_class(const String &p_class) {
 	ENSURE_VALID(this);
 	element->SetClass(godot_to_rml_string(p_class), true);
+	request_update();
 }
 
 void RMLElement::set_class_names(const String &p_class_names) {
 	ENSURE_VALID(this);
 	element->SetClassNames(godot_to_rml_string(p_class_names));
+	request_update();
 }
 
 void RMLElement::remove_class(const String &p_class) {
 	ENSURE_VALID(this);
 	element->SetClass(godot_to_rml_string(p_class), false);
+	request_update();
 }
 
 String RMLElement::get_class_names() const {
@@ -219,12 +239,14 @@ void RMLElement::set_text_content(const String &p_text) {
 	element->AppendChild(
 		element->GetOwnerDocument()->CreateTextNode(godot_to_rml_string(p_text))
 	);
+	request_update();
 }
 
 void RMLElement::set_inner_rml(const String &p_rml) {
 	ENSURE_VALID(this);
 
 	element->SetInnerRML(godot_to_rml_string(p_rml));
+	request_update();
 }
 
 PackedStringArray RMLElement::get_text_content() const {
@@ -18,6 +18,8 @@ class RMLElement: public RefCounted {
 
 	ElementRef element = nullptr;
 
+	void request_update() const;
+
 protected:
 	static void _bind_methods();
 
@@ -1,10 +1,10 @@
 #include "rd_render_interface_godot.h"
 #include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/classes/texture2d.hpp>
 #include <godot_cpp/classes/rendering_device.hpp>
 #include <godot_cpp/classes/resource_loader.hpp>
-#include <godot_cpp/classes/uniform_set_cache_rd.hpp>
 #include <godot_cpp/classes/rd_uniform.hpp>
 #include <godot_cpp/classes/rd_shader_source.hpp>
 #include <godot_cpp/classes/rd_shader_file.hpp>
@@ -19,24 +19,34 @@
 #include <godot_cpp/classes/rd_pipeline_depth_stencil_state.hpp>
 #include <godot_cpp/classes/rd_pipeline_color_blend_state.hpp>
 #include <godot_cpp/classes/rd_pipeline_color_blend_state_attachment.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+#include <godot_cpp/templates/hashfuncs.hpp>
 
 #include <RmlUi/Core/Dictionary.h>
 #include <RmlUi/Core/DecorationTypes.h>
 
 #include <iostream>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
 
 #include "../rml_util.h"
 #include "../util.h"
+#include "../project_settings.h"
 
 using namespace godot;
 
 using RD = RenderingDevice;
 
-const uint64_t SHADER_FILTER_MODULATE = 1;
 const uint64_t SHADER_FILTER_BLUR = 2;
 const uint64_t SHADER_FILTER_DROP_SHADOW = 3;
 const uint64_t SHADER_FILTER_COLOR_MATRIX = 4;
 const uint64_t SHADER_FILTER_MASK = 5;
+const uint64_t SHADER_FILTER_BLUR_DOWNSAMPLE = 6;
+const uint64_t SHADER_FILTER_BLUR_UPSAMPLE = 7;
+const uint64_t SHADER_LAYER_COMPOSITION = 8;
+const uint64_t SHADER_POST_PROCESS = 9;
 
 const uint64_t SHADER_GRADIENT = 16;
 
@@ -44,14 +54,54 @@ const uint64_t PIPELINE_GEOMETRY = 1;
 
 const uint64_t PIPELINE_LAYER_COMPOSITION = 2;
 
-const uint64_t PIPELINE_FILTER_MODULATE = 3;
 const uint64_t PIPELINE_FILTER_BLUR = 4;
 const uint64_t PIPELINE_FILTER_DROP_SHADOW = 5;
 const uint64_t PIPELINE_FILTER_COLOR_MATRIX = 6;
 const uint64_t PIPELINE_FILTER_MASK = 7;
+const uint64_t PIPELINE_FILTER_BLUR_DOWNSAMPLE = 8;
+const uint64_t PIPELINE_FILTER_BLUR_UPSAMPLE = 9;
+const uint64_t PIPELINE_POST_PROCESS = 10;
 
 const uint64_t PIPELINE_GRADIENT = 16;
 
+// Compiled shader bytecode is kept here between runs, see RmlUi/rendering/shader_cache
+const char *SHADER_CACHE_PATH = "user://rmlui/shader_cache";
+
+// Names of the timestamps captured by the profiler, followed by their serial
+const char *TIMESTAMP_PREFIX = "GodotRmlUi_Timestamp_";
+const char *PASS_NAME_PREFIX = "GodotRmlUi_";
+
+const std::map<Rml::String, const char *> COLOR_MATRIX_DEBUG_NAMES = {
+    {"opacity", "GodotRmlUi_Opacity"},
+    {"brightness", "GodotRmlUi_Brightness"},
+    {"contrast", "GodotRmlUi_Contrast"},
+    {"invert", "GodotRmlUi_Invert"},
+    {"grayscale", "GodotRmlUi_Grayscale"},
+    {"sepia", "GodotRmlUi_Sepia"},
+    {"hue-rotate", "GodotRmlUi_HueRotate"},
+    {"saturate", "GodotRmlUi_Saturate"}
+};
+
+// Context targets are rounded up to multiples of this size, so documents of similar sizes share back buffers
+const int32_t TARGET_SIZE_GRANULARITY = 64;
+// Pooled layer targets not used for this many frames are freed
+const uint64_t LAYER_TARGET_MAX_IDLE_FRAMES = 120;
+// Released generated textures kept this many frames to be reused
+const uint64_t RELEASED_TEXTURE_MAX_IDLE_FRAMES = 60;
+// Stale uniform sets are only looked for once the cache grows past this size
+const size_t UNIFORM_SET_CACHE_PURGE_SIZE = 1024;
+// Frames canvas resources are kept after being released, until no canvas draws with them
+const uint64_t CANVAS_RELEASE_DELAY_FRAMES = 2;
+// Blurs are downsampled by powers of two until the sigma is at most this many texels
+const float MAX_BLUR_SIGMA = 4.0f;
+const int32_t MAX_BLUR_SCALE = 8;
+// Wider kernels are clamped, only reached past the largest downsampling
+const float MAX_BLUR_KERNEL_SIGMA = 16.0f;
+// Matches the local size of the compute shaders
+const int32_t COMPUTE_GROUP_SIZE = 8;
+// Instance translations the instance buffer starts with, grown by powers of two
+const uint32_t MIN_INSTANCE_CAPACITY = 1024;
+
 Rml::Matrix4f get_final_transform(const Rml::Matrix4f &p_drawing_matrix, const Rml::Vector2f &translation) {
     return p_drawing_matrix * Rml::Matrix4f::Translate(Rml::Vector3f(translation.x, translation.y, 0.0));
 }
@@ -78,48 +128,121 @@ void matrix_to_pointer(float *ptr, const Rml::Matrix4f &p_mat) {
     ptr[15] = p_mat[3].w;
 }
 
-void RDRenderInterfaceGodot::create_render_pipeline_with_clip(uint64_t p_id, const std::map<String, Variant> &p_params) {
-    std::map clipping_params = std::map(p_params);
-    clipping_params.merge(std::map<String, Variant>({
-        {"enable_stencil", true},
-        {"op_ref", 0x01},
-        {"op_compare", RD::COMPARE_OP_EQUAL},
-        {"op_compare_mask", 0xff},
-        {"op_write_mask", 0x00},
-        {"op_pass", RD::STENCIL_OP_KEEP},
-        {"op_fail", RD::STENCIL_OP_KEEP}
-    }));
-    RID pipeline_not_clipping = internal_rendering_resources.create_render_pipeline(p_params);
-    RID pipeline_clipping = internal_rendering_resources.create_render_pipeline(clipping_params);
+void region_to_pointer(int32_t *ptr, const Rect2i &p_region) {
+    ptr[0] = p_region.position.x;
+    ptr[1] = p_region.position.y;
+    ptr[2] = p_region.size.x;
+    ptr[3] = p_region.size.y;
+}
+
+void RDRenderInterfaceGodot::create_render_pipeline_with_clip(uint64_t p_id, const RenderPipelineDesc &p_desc) {
+    StencilOpDesc clip_test;
+    clip_test.reference = 0x01;
+    clip_test.compare = RD::COMPARE_OP_EQUAL;
+    clip_test.compare_mask = 0xff;
+    clip_test.write_mask = 0x00;
+    clip_test.pass = RD::STENCIL_OP_KEEP;
+    clip_test.fail = RD::STENCIL_OP_KEEP;
+
+    RenderPipelineDesc clipping_desc = p_desc;
+    clipping_desc.set_stencil(clip_test);
+
+    RID pipeline_not_clipping = internal_rendering_resources.get_or_create_render_pipeline(p_desc);
+    RID pipeline_clipping = internal_rendering_resources.get_or_create_render_pipeline(clipping_desc);
 
     pipelines_with_clip[p_id] = {pipeline_not_clipping, pipeline_clipping};
 }
 
-RID RDRenderInterfaceGodot::get_shader_pipeline(uint64_t p_id) const {
-    return clip_mask_enabled ? std::get<1>(pipelines_with_clip.at(p_id)) : std::get<0>(pipelines_with_clip.at(p_id));
+RID RDRenderInterfaceGodot::get_shader_pipeline(uint64_t p_id) {
+    auto it = pipelines_with_clip.find(p_id);
+    if (it == pipelines_with_clip.end()) {
+        create_render_pipeline_with_clip(p_id, get_pipeline_desc(p_id));
+        it = pipelines_with_clip.find(p_id);
+    }
+    return clip_mask_enabled ? std::get<1>(it->second) : std::get<0>(it->second);
+}
+
+RID RDRenderInterfaceGodot::get_shader(uint64_t p_id) {
+    auto it = loaded_shaders.find(p_id);
+    if (it != loaded_shaders.end()) {
+        return it->second;
+    }
+    RID rid = internal_rendering_resources.get_or_create_shader(shader_descs.at(p_id));
+    loaded_shaders[p_id] = rid;
+    return rid;
+}
+
+RID RDRenderInterfaceGodot::get_pipeline(uint64_t p_id) {
+    auto it = loaded_pipelines.find(p_id);
+    if (it != loaded_pipelines.end()) {
+        return it->second;
+    }
+    RID rid;
+    if (pipeline_descs.at(p_id).compute) {
+        ComputePipelineDesc desc;
+        desc.shader = get_shader(pipeline_descs.at(p_id).shader_id);
+        rid = internal_rendering_resources.get_or_create_compute_pipeline(desc);
+    } else {
+        rid = internal_rendering_resources.get_or_create_render_pipeline(get_pipeline_desc(p_id));
+    }
+    loaded_pipelines[p_id] = rid;
+    return rid;
+}
+
+RenderPipelineDesc RDRenderInterfaceGodot::get_pipeline_desc(uint64_t p_id) {
+    const PipelineDesc &pipeline = pipeline_descs.at(p_id);
+    RenderPipelineDesc desc = pipeline.render;
+    desc.shader = get_shader(pipeline.shader_id);
+    return desc;
 }
 
 void RDRenderInterfaceGodot::initialize() {
     RenderingServer *rs = RenderingServer::get_singleton();
     RD *rd = rs->get_rendering_device();
+    uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+
+    clear_colors_transparent = { Color(0, 0, 0, 0) };
+    push_const_buffer.resize(sizeof(PushConstant::data));
 
     internal_rendering_resources = RenderingResources(rd);
     rendering_resources = RenderingResources(rd);
 
+    if ((bool)GLOBAL_GET("RmlUi/rendering/shader_cache")) {
+        internal_rendering_resources.set_shader_cache_path(SHADER_CACHE_PATH);
+    }
+
+    batching_enabled = GLOBAL_GET("RmlUi/rendering/batch_draws");
+    post_process_enabled = GLOBAL_GET("RmlUi/rendering/post_process_pass");
+
+    // Half of the device's timestamps per frame are left to the engine's own profiler
+    gpu_profiling_enabled = GLOBAL_GET("RmlUi/debug/gpu_profiling");
+    timestamp_budget = (int)GLOBAL_GET("debug/settings/profiler/max_timestamp_query_elements") / 2;
+
+    // Geometry colors and glyph textures are premultiplied
+    premultiplied_material.instantiate();
+    premultiplied_material->set_blend_mode(CanvasItemMaterial::BLEND_MODE_PREMULT_ALPHA);
+
+    // Interleaved layout matching Rml::Vertex, so vertices can be uploaded as is
+    static_assert(sizeof(Rml::Vertex) == 20, "Rml::Vertex layout doesn't match the geometry vertex format");
+    const uint32_t vertex_stride = sizeof(Rml::Vertex);
+
     Ref<RDVertexAttribute> pos_attr = memnew(RDVertexAttribute);
     pos_attr->set_format(RD::DATA_FORMAT_R32G32_SFLOAT);
     pos_attr->set_location(0);
-    pos_attr->set_stride(4 * 2); // 4 bytes * 2 members (xy)
+    pos_attr->set_offset(offsetof(Rml::Vertex, position));
+    pos_attr->set_stride(vertex_stride);
 
     Ref<RDVertexAttribute> color_attr = memnew(RDVertexAttribute);
-    color_attr->set_format(RD::DATA_FORMAT_R32G32B32A32_SFLOAT);
+    color_attr->set_format(RD::DATA_FORMAT_R8G8B8A8_UNORM);
     color_attr->set_location(1);
-    color_attr->set_stride(4 * 4); // 4 bytes * 4 members (rgba)
+    color_attr->set_offset(offsetof(Rml::Vertex, colour));
+    color_attr->set_stride(vertex_stride);
 
     Ref<RDVertexAttribute> uv_attr = memnew(RDVertexAttribute);
     uv_attr->set_format(RD::DATA_FORMAT_R32G32_SFLOAT);
     uv_attr->set_location(2);
-    uv_attr->set_stride(4 * 2); // 4 bytes * 2 members (xy)
+    uv_attr->set_offset(offsetof(Rml::Vertex, tex_coord));
+    uv_attr->set_stride(vertex_stride);
 
     Ref<RDAttachmentFormat> color_attachment = memnew(RDAttachmentFormat);
     Ref<RDAttachmentFormat> clip_mask_attachment = memnew(RDAttachmentFormat);
@@ -137,196 +260,144 @@ void RDRenderInterfaceGodot::initialize() {
     clip_mask_framebuffer_format = rd->framebuffer_format_create({ clip_mask_attachment });
     geometry_vertex_format = rd->vertex_format_create({ pos_attr, color_attr, uv_attr });
 
-    shader_blit = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/blit.glsl"},
-        {"name", "rmlui_blit_shader"}
-    });
-    shader_geometry = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/geometry.glsl"},
-        {"name", "rmlui_geometry_shader"}
-    });
-    shader_clip_mask = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/clip_mask.glsl"},
-        {"name", "rmlui_clip_mask_shader"}
-    });
-    shader_layer_composition = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/layer_composition.glsl"},
-        {"name", "rmlui_layer_composition_shader"}
-    });
-    shader_post_process = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/post_process.glsl"},
-        {"name", "rmlui_post_process_shader"}
-    });
-
-    pipeline_blit = internal_rendering_resources.create_render_pipeline({
-        {"shader", shader_blit},
-        {"framebuffer_format", color_framebuffer_format},
-        {"attachment_count", 1}
-    });
-    create_render_pipeline_with_clip(PIPELINE_GEOMETRY, {
-        {"shader", shader_geometry},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"vertex_format", geometry_vertex_format},
-        {"attachment_count", 2},
-        {"attachment_enable_blend", true},
-        {"attachment_color_blend_op", RD::BLEND_OP_ADD},
-        {"attachment_alpha_blend_op", RD::BLEND_OP_ADD},
-        {"attachment_src_color_blend_factor", RD::BLEND_FACTOR_ONE},
-        {"attachment_dst_color_blend_factor", RD::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA},
-        {"attachment_src_alpha_blend_factor", RD::BLEND_FACTOR_ONE},
-        {"attachment_dst_alpha_blend_factor", RD::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA},
-        {"print", true}
-    });
-    create_render_pipeline_with_clip(PIPELINE_LAYER_COMPOSITION, {
-        {"shader", shader_layer_composition},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"attachment_count", 2},
-    });
-
-    pipeline_clip_mask_set = internal_rendering_resources.create_render_pipeline({
-        {"shader", shader_clip_mask},
-        {"framebuffer_format", clip_mask_framebuffer_format},
-        {"vertex_format", geometry_vertex_format},
-        {"attachment_count", 0},
-
-        {"enable_stencil", true},
-        {"op_ref", 0x01},
-        {"op_write_mask", 0xff},
-        {"op_compare", RD::COMPARE_OP_ALWAYS},
-        {"op_compare_mask", 0xff},
-        {"op_pass", RD::STENCIL_OP_REPLACE},
-    });
-    pipeline_clip_mask_set_inverse = internal_rendering_resources.create_render_pipeline({
-        {"shader", shader_clip_mask},
-        {"framebuffer_format", clip_mask_framebuffer_format},
-        {"vertex_format", geometry_vertex_format},
-        {"attachment_count", 0},
-
-        {"enable_stencil", true},
-        {"op_ref", 0x01},
-        {"op_write_mask", 0xff},
-        {"op_compare", RD::COMPARE_OP_ALWAYS},
-        {"op_compare_mask", 0xff},
-        {"op_pass", RD::STENCIL_OP_REPLACE},
-    });
-    pipeline_clip_mask_intersect = internal_rendering_resources.create_render_pipeline({
-        {"shader", shader_clip_mask},
-        {"framebuffer_format", clip_mask_framebuffer_format},
-        {"vertex_format", geometry_vertex_format},
-        {"attachment_count", 0},
-
-        {"enable_stencil", true},
-        {"op_ref", 0x01},
-        {"op_write_mask", 0xff},
-        {"op_compare", RD::COMPARE_OP_ALWAYS},
-        {"op_compare_mask", 0xff},
-        {"op_pass", RD::STENCIL_OP_REPLACE},
-    });
-
-    pipeline_post_process = internal_rendering_resources.create_render_pipeline({
-        {"shader", shader_post_process},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"attachment_count", 2},
-    });
-
-    shaders[SHADER_FILTER_MODULATE] = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/filters/modulate.glsl"},
-        {"name", "rmlui_filter_modulate_shader"}
-    });
-    shaders[SHADER_FILTER_BLUR] = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/filters/blur.glsl"},
-        {"name", "rmlui_filter_blur_shader"}
-    });
-    shaders[SHADER_FILTER_DROP_SHADOW] = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/filters/drop_shadow.glsl"},
-        {"name", "rmlui_filter_drop_shadow_shader"}
-    });
-    shaders[SHADER_FILTER_COLOR_MATRIX] = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/filters/color_matrix.glsl"},
-        {"name", "rmlui_filter_color_matrix_shader"}
-    });
-    shaders[SHADER_FILTER_MASK] = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/filters/mask.glsl"},
-        {"name", "rmlui_filter_mask_shader"}
-    });
-
-    shaders[SHADER_GRADIENT] = internal_rendering_resources.create_shader({
-        {"path", "res://addons/rmlui/shaders/shaders/gradient.glsl"},
-        {"name", "rmlui_filter_gradient_shader"}
-    });
-
-    pipelines[PIPELINE_FILTER_MODULATE] = internal_rendering_resources.create_render_pipeline({
-        {"shader", shaders[SHADER_FILTER_MODULATE]},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"attachment_count", 2}
-    });
-    pipelines[PIPELINE_FILTER_BLUR] = internal_rendering_resources.create_render_pipeline({
-        {"shader", shaders[SHADER_FILTER_BLUR]},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"attachment_count", 2}
-    });
-    pipelines[PIPELINE_FILTER_DROP_SHADOW] = internal_rendering_resources.create_render_pipeline({
-        {"shader", shaders[SHADER_FILTER_DROP_SHADOW]},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"attachment_count", 2}
-    });
-    pipelines[PIPELINE_FILTER_COLOR_MATRIX] = internal_rendering_resources.create_render_pipeline({
-        {"shader", shaders[SHADER_FILTER_COLOR_MATRIX]},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"attachment_count", 2}
-    });
-    pipelines[PIPELINE_FILTER_MASK] = internal_rendering_resources.create_render_pipeline({
-        {"shader", shaders[SHADER_FILTER_MASK]},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"attachment_count", 2}
-    });
-    pipelines[PIPELINE_FILTER_MASK] = internal_rendering_resources.create_render_pipeline({
-        {"shader", shaders[SHADER_FILTER_MASK]},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"attachment_count", 2}
-    });
-
-    create_render_pipeline_with_clip(PIPELINE_GRADIENT, {
-        {"shader", shaders[SHADER_GRADIENT]},
-        {"framebuffer_format", geometry_framebuffer_format},
-        {"vertex_format", geometry_vertex_format},
-        {"attachment_count", 2}
-    });
-
-    sampler_nearest = internal_rendering_resources.create_sampler({});
-    sampler_linear = internal_rendering_resources.create_sampler({
-        {"filter", RD::SAMPLER_FILTER_LINEAR},
-        {"repeat_u", RD::SAMPLER_REPEAT_MODE_REPEAT},
-        {"repeat_v", RD::SAMPLER_REPEAT_MODE_REPEAT},
-        {"repeat_w", RD::SAMPLER_REPEAT_MODE_REPEAT},
-    });
-
-    PackedByteArray white_texture_buf, transparent_texture_buf;
-    // width * height * rgba
-    white_texture_buf.resize(4 * 4 * 4);
-    transparent_texture_buf.resize(4 * 4 * 4);
-    white_texture_buf.fill(255);
-    transparent_texture_buf.fill(0);
-
-    texture_white = internal_rendering_resources.create_texture({
-        {"texture_type", RD::TEXTURE_TYPE_2D},
-        {"width", 4},
-        {"height", 4},
-        {"format", RD::DATA_FORMAT_R8G8B8A8_UNORM},
-        {"usage_bits", RD::TEXTURE_USAGE_SAMPLING_BIT},
-        {"data", TypedArray<PackedByteArray>({white_texture_buf})}
-    });
-    texture_transparent = internal_rendering_resources.create_texture({
-        {"texture_type", RD::TEXTURE_TYPE_2D},
-        {"width", 4},
-        {"height", 4},
-        {"format", RD::DATA_FORMAT_R8G8B8A8_UNORM},
-        {"usage_bits", RD::TEXTURE_USAGE_SAMPLING_BIT},
-        {"data", TypedArray<PackedByteArray>({transparent_texture_buf})}
-    });
+    geometry_arena.initialize(&rendering_resources, geometry_vertex_format, vertex_stride, 3);
+
+    // Only what every document draws with is created upfront
+    shader_blit = internal_rendering_resources.get_or_create_shader({ "res://addons/rmlui/shaders/blit.glsl", "rmlui_blit_shader" });
+    shader_geometry = internal_rendering_resources.get_or_create_shader({ "res://addons/rmlui/shaders/geometry.glsl", "rmlui_geometry_shader" });
+    shader_clip_mask = internal_rendering_resources.get_or_create_shader({ "res://addons/rmlui/shaders/clip_mask.glsl", "rmlui_clip_mask_shader" });
+
+    RenderPipelineDesc blit_desc;
+    blit_desc.shader = shader_blit;
+    blit_desc.framebuffer_format = color_framebuffer_format;
+    blit_desc.attachment_count = 1;
+    pipeline_blit = internal_rendering_resources.get_or_create_render_pipeline(blit_desc);
+
+    RenderPipelineDesc geometry_desc;
+    geometry_desc.shader = shader_geometry;
+    geometry_desc.framebuffer_format = geometry_framebuffer_format;
+    geometry_desc.vertex_format = geometry_vertex_format;
+    geometry_desc.attachment_count = 2;
+    geometry_desc.blend.enable_blend = true;
+    geometry_desc.blend.color_blend_op = RD::BLEND_OP_ADD;
+    geometry_desc.blend.alpha_blend_op = RD::BLEND_OP_ADD;
+    geometry_desc.blend.src_color_blend_factor = RD::BLEND_FACTOR_ONE;
+    geometry_desc.blend.dst_color_blend_factor = RD::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    geometry_desc.blend.src_alpha_blend_factor = RD::BLEND_FACTOR_ONE;
+    geometry_desc.blend.dst_alpha_blend_factor = RD::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    create_render_pipeline_with_clip(PIPELINE_GEOMETRY, geometry_desc);
+
+    StencilOpDesc clip_write;
+    clip_write.reference = 0x01;
+    clip_write.write_mask = 0xff;
+    clip_write.compare = RD::COMPARE_OP_ALWAYS;
+    clip_write.compare_mask = 0xff;
+    clip_write.pass = RD::STENCIL_OP_REPLACE;
+
+    RenderPipelineDesc clip_mask_desc;
+    clip_mask_desc.shader = shader_clip_mask;
+    clip_mask_desc.framebuffer_format = clip_mask_framebuffer_format;
+    clip_mask_desc.vertex_format = geometry_vertex_format;
+    clip_mask_desc.attachment_count = 0;
+    clip_mask_desc.set_stencil(clip_write);
+
+    // The three operations draw with the same state, so they share a single pipeline
+    pipeline_clip_mask_set = internal_rendering_resources.get_or_create_render_pipeline(clip_mask_desc);
+    pipeline_clip_mask_set_inverse = internal_rendering_resources.get_or_create_render_pipeline(clip_mask_desc);
+    pipeline_clip_mask_intersect = internal_rendering_resources.get_or_create_render_pipeline(clip_mask_desc);
+
+    // Layers, filters and shaders are created by get_shader and get_pipeline the first time they're drawn
+    shader_descs[SHADER_LAYER_COMPOSITION] = { "res://addons/rmlui/shaders/layer_composition.glsl", "rmlui_layer_composition_shader" };
+    shader_descs[SHADER_POST_PROCESS] = { "res://addons/rmlui/shaders/post_process.glsl", "rmlui_post_process_shader" };
+    shader_descs[SHADER_FILTER_BLUR] = { "res://addons/rmlui/shaders/filters/blur.glsl", "rmlui_filter_blur_shader" };
+    shader_descs[SHADER_FILTER_DROP_SHADOW] = { "res://addons/rmlui/shaders/filters/drop_shadow.glsl", "rmlui_filter_drop_shadow_shader" };
+    shader_descs[SHADER_FILTER_COLOR_MATRIX] = { "res://addons/rmlui/shaders/filters/color_matrix.glsl", "rmlui_filter_color_matrix_shader" };
+    shader_descs[SHADER_FILTER_MASK] = { "res://addons/rmlui/shaders/filters/mask.glsl", "rmlui_filter_mask_shader" };
+    shader_descs[SHADER_FILTER_BLUR_DOWNSAMPLE] = { "res://addons/rmlui/shaders/filters/blur_downsample.glsl", "rmlui_filter_blur_downsample_shader" };
+    shader_descs[SHADER_FILTER_BLUR_UPSAMPLE] = { "res://addons/rmlui/shaders/filters/blur_upsample.glsl", "rmlui_filter_blur_upsample_shader" };
+    shader_descs[SHADER_GRADIENT] = { "res://addons/rmlui/shaders/shaders/gradient.glsl", "rmlui_filter_gradient_shader" };
+
+    // Drawn over both attachments of a layer, without blending
+    auto layer_pipeline = [&](uint64_t p_shader_id) {
+        PipelineDesc desc;
+        desc.shader_id = p_shader_id;
+        desc.render.framebuffer_format = geometry_framebuffer_format;
+        desc.render.attachment_count = 2;
+        return desc;
+    };
+    auto compute_pipeline = [&](uint64_t p_shader_id) {
+        PipelineDesc desc;
+        desc.shader_id = p_shader_id;
+        desc.compute = true;
+        return desc;
+    };
+
+    pipeline_descs[PIPELINE_LAYER_COMPOSITION] = layer_pipeline(SHADER_LAYER_COMPOSITION);
+    pipeline_descs[PIPELINE_POST_PROCESS] = layer_pipeline(SHADER_POST_PROCESS);
+    pipeline_descs[PIPELINE_FILTER_BLUR] = compute_pipeline(SHADER_FILTER_BLUR);
+    pipeline_descs[PIPELINE_FILTER_BLUR_DOWNSAMPLE] = compute_pipeline(SHADER_FILTER_BLUR_DOWNSAMPLE);
+    pipeline_descs[PIPELINE_FILTER_BLUR_UPSAMPLE] = layer_pipeline(SHADER_FILTER_BLUR_UPSAMPLE);
+    pipeline_descs[PIPELINE_FILTER_DROP_SHADOW] = layer_pipeline(SHADER_FILTER_DROP_SHADOW);
+    pipeline_descs[PIPELINE_FILTER_COLOR_MATRIX] = layer_pipeline(SHADER_FILTER_COLOR_MATRIX);
+    pipeline_descs[PIPELINE_FILTER_MASK] = layer_pipeline(SHADER_FILTER_MASK);
+    pipeline_descs[PIPELINE_GRADIENT] = layer_pipeline(SHADER_GRADIENT);
+    pipeline_descs[PIPELINE_GRADIENT].render.vertex_format = geometry_vertex_format;
+
+    sampler_nearest = internal_rendering_resources.get_or_create_sampler(SamplerDesc());
+
+    SamplerDesc linear_desc;
+    linear_desc.min_filter = RD::SAMPLER_FILTER_LINEAR;
+    linear_desc.mag_filter = RD::SAMPLER_FILTER_LINEAR;
+    linear_desc.repeat_u = RD::SAMPLER_REPEAT_MODE_REPEAT;
+    linear_desc.repeat_v = RD::SAMPLER_REPEAT_MODE_REPEAT;
+    linear_desc.repeat_w = RD::SAMPLER_REPEAT_MODE_REPEAT;
+    sampler_linear = internal_rendering_resources.get_or_create_sampler(linear_desc);
+
+    // 4x4 RGBA
+    TextureDesc white_desc;
+    white_desc.width = 4;
+    white_desc.height = 4;
+    white_desc.data.resize(4 * 4 * 4);
+    white_desc.data.fill(255);
+    texture_white = internal_rendering_resources.get_or_create_texture(white_desc);
+
+    TextureDesc transparent_desc = white_desc;
+    transparent_desc.data.fill(0);
+    texture_transparent = internal_rendering_resources.get_or_create_texture(transparent_desc);
+
+    UtilityFunctions::print_verbose(vformat(
+        "[RmlUi] Renderer initialized in %.2f ms, %d shaders loaded from the shader cache and %d compiled, %d pipelines deferred to first use",
+        (Time::get_singleton()->get_ticks_usec() - start_usec) / 1000.0,
+        internal_rendering_resources.get_shader_cache_hits(),
+        internal_rendering_resources.get_shader_cache_misses(),
+        (int64_t)pipeline_descs.size()
+    ));
 }
 
 void RDRenderInterfaceGodot::finalize() {
+    run_pending_releases();
+    evict_released_textures(true);
+    purge_uniform_sets(true);
+    run_canvas_releases(true);
+    // Kernel buffers are internal resources, freed below
+    blur_kernels.clear();
+    premultiplied_material.unref();
+    // Contexts still alive at this point don't get to release their targets
+    while (!shared_targets.empty()) {
+        SharedTargets *shared = shared_targets.begin()->second;
+        shared->users = 1;
+        release_shared_targets(shared);
+    }
+    geometry_arena.clear();
+    geometry_cache.clear();
+    if (instance_buffer.is_valid()) {
+        rendering_resources.free_storage_buffer(instance_buffer);
+        instance_buffer = RID();
+        instance_capacity = 0;
+    }
+    pipelines_with_clip.clear();
+    loaded_shaders.clear();
+    loaded_pipelines.clear();
     internal_rendering_resources.free_all_resources();
 }
 
@@ -336,17 +407,14 @@ void RDRenderInterfaceGodot::allocate_render_target(RenderTarget *p_target, cons
 	if (p_target->size == p_size) return;
 	free_render_target(p_target);
 
-    uint64_t main_usage = RD::TEXTURE_USAGE_COLOR_ATTACHMENT_BIT | RD::TEXTURE_USAGE_SAMPLING_BIT | RD::TEXTURE_USAGE_CAN_COPY_FROM_BIT | RD::TEXTURE_USAGE_CAN_COPY_TO_BIT;
-    p_target->color = rendering_resources.create_texture({
-        {"width", p_size.x},
-        {"height", p_size.y},
-        {"format", RD::DATA_FORMAT_R8G8B8A8_UNORM},
-        {"usage_bits", main_usage},
-    });
+    TextureDesc color_desc;
+    color_desc.width = p_size.x;
+    color_desc.height = p_size.y;
+    color_desc.usage_bits = RD::TEXTURE_USAGE_COLOR_ATTACHMENT_BIT | RD::TEXTURE_USAGE_SAMPLING_BIT | RD::TEXTURE_USAGE_CAN_COPY_FROM_BIT | RD::TEXTURE_USAGE_CAN_COPY_TO_BIT;
+    p_target->color = rendering_resources.create_texture(color_desc);
 
-    p_target->framebuffer = rendering_resources.create_framebuffer({
-        {"textures", TypedArray<RID>({ p_target->color, context->clip_mask })}
-    });
+    p_target->framebuffer = rendering_resources.get_or_create_framebuffer({ { p_target->color, context->shared->clip_mask } });
+    p_target->size = p_size;
 }
 
 void RDRenderInterfaceGodot::free_render_target(RenderTarget *p_target) {
@@ -359,71 +427,178 @@ void RDRenderInterfaceGodot::free_render_target(RenderTarget *p_target) {
         rendering_resources.free_texture(p_target->color);
         p_target->color = RID();
     }
+    p_target->size = Vector2i();
+}
+
+void RDRenderInterfaceGodot::allocate_storage_target(RenderTarget *p_target, const Vector2i &p_size) {
+    if (p_target->size == p_size) return;
+    free_render_target(p_target);
+
+    TextureDesc color_desc;
+    color_desc.width = p_size.x;
+    color_desc.height = p_size.y;
+    color_desc.usage_bits = RD::TEXTURE_USAGE_STORAGE_BIT | RD::TEXTURE_USAGE_SAMPLING_BIT;
+    p_target->color = rendering_resources.create_texture(color_desc);
+    p_target->size = p_size;
+}
+
+Vector2i RDRenderInterfaceGodot::get_bucket_size(const Vector2i &p_size) {
+    return Vector2i(
+        (p_size.x + TARGET_SIZE_GRANULARITY - 1) / TARGET_SIZE_GRANULARITY * TARGET_SIZE_GRANULARITY,
+        (p_size.y + TARGET_SIZE_GRANULARITY - 1) / TARGET_SIZE_GRANULARITY * TARGET_SIZE_GRANULARITY
+    );
+}
+
+RDRenderInterfaceGodot::SharedTargets *RDRenderInterfaceGodot::acquire_shared_targets(const Vector2i &p_size) {
+    uint64_t key = ((uint64_t)p_size.x << 32) | (uint32_t)p_size.y;
+    auto it = shared_targets.find(key);
+    if (it != shared_targets.end()) {
+        it->second->users++;
+        return it->second;
+    }
+
+    SharedTargets *shared = memnew(SharedTargets);
+    shared->size = p_size;
+    shared->users = 1;
+
+    // The clip mask is attached to every target of the bucket, so it can't be lazily allocated
+    TextureDesc clip_mask_desc;
+    clip_mask_desc.width = p_size.x;
+    clip_mask_desc.height = p_size.y;
+    clip_mask_desc.format = RD::DATA_FORMAT_S8_UINT;
+    clip_mask_desc.usage_bits = RD::TEXTURE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | RD::TEXTURE_USAGE_CAN_COPY_FROM_BIT | RD::TEXTURE_USAGE_CAN_COPY_TO_BIT;
+    shared->clip_mask = rendering_resources.create_texture(clip_mask_desc);
+    shared->clip_mask_framebuffer = rendering_resources.get_or_create_framebuffer({ { shared->clip_mask } });
+
+    shared_targets[key] = shared;
+    return shared;
+}
+
+void RDRenderInterfaceGodot::release_shared_targets(SharedTargets *p_shared) {
+    ERR_FAIL_COND(p_shared->users == 0);
+    p_shared->users--;
+    if (p_shared->users > 0) return;
+
+    for (int i = 0; i < TARGET_SLOT_MAX; i++) {
+        free_render_target(&p_shared->slots[i]);
+    }
+    for (RenderTarget *layer : p_shared->free_layers) {
+        free_render_target(layer);
+        memdelete(layer);
+    }
+    rendering_resources.free_framebuffer(p_shared->clip_mask_framebuffer);
+    rendering_resources.free_texture(p_shared->clip_mask);
+
+    shared_targets.erase(((uint64_t)p_shared->size.x << 32) | (uint32_t)p_shared->size.y);
+    memdelete(p_shared);
+}
+
+RDRenderInterfaceGodot::RenderTarget *RDRenderInterfaceGodot::borrow_layer_target() {
+    SharedTargets *shared = context->shared;
+
+    // Most recently returned first, the least used ones are left to be evicted
+    if (!shared->free_layers.empty()) {
+        RenderTarget *target = shared->free_layers.back();
+        shared->free_layers.pop_back();
+        return target;
+    }
+
+    RenderTarget *target = memnew(RenderTarget);
+    allocate_render_target(target, shared->size);
+    return target;
+}
+
+void RDRenderInterfaceGodot::return_layer_target(RenderTarget *p_target) {
+    // Passes are executed in the order they are recorded, so the target
+    // can be borrowed again by the next layer of the same frame
+    p_target->last_used_frame = Engine::get_singleton()->get_process_frames();
+    context->shared->free_layers.push_back(p_target);
+}
+
+void RDRenderInterfaceGodot::evict_idle_layer_targets() {
+    uint64_t frame = Engine::get_singleton()->get_process_frames();
+
+    for (const std::pair<const uint64_t, SharedTargets *> &it : shared_targets) {
+        std::vector<RenderTarget *> &free_layers = it.second->free_layers;
+
+        size_t evicted = 0;
+        while (evicted < free_layers.size() && frame - free_layers[evicted]->last_used_frame > LAYER_TARGET_MAX_IDLE_FRAMES) {
+            free_render_target(free_layers[evicted]);
+            memdelete(free_layers[evicted]);
+            evicted++;
+        }
+        free_layers.erase(free_layers.begin(), free_layers.begin() + evicted);
+    }
+}
+
+RDRenderInterfaceGodot::RenderTarget *RDRenderInterfaceGodot::get_slot_target(TargetSlot p_slot) {
+    ERR_FAIL_INDEX_V(p_slot, TARGET_SLOT_MAX, nullptr);
+
+    RenderTarget *target = &context->shared->slots[p_slot];
+    if (!target->color.is_valid()) {
+        if (p_slot >= TARGET_SLOT_BLUR0) {
+            allocate_storage_target(target, context->shared->size);
+        } else {
+            allocate_render_target(target, context->shared->size);
+        }
+    }
+    return target;
 }
 
 void RDRenderInterfaceGodot::allocate_context(Context *p_ctx, const Vector2i &p_size) {
     if (p_ctx->size == p_size) {
         return;
     }
+
+    // Within the same bucket the targets are kept, only the drawn region changes
+    Vector2i target_size = get_bucket_size(p_size);
+    if (p_ctx->target_size == target_size) {
+        p_ctx->size = p_size;
+        p_ctx->has_frame = false;
+        return;
+    }
     free_context(p_ctx);
 
     p_ctx->size = p_size;
+    p_ctx->target_size = target_size;
+    p_ctx->has_frame = false;
 
     RenderingServer *rs = RenderingServer::get_singleton();
 
-    p_ctx->clip_mask = rendering_resources.create_texture({
-        {"width", p_size.x},
-        {"height", p_size.y},
-        {"format", RD::DATA_FORMAT_S8_UINT},
-        {"usage_bits", RD::TEXTURE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | RD::TEXTURE_USAGE_CAN_COPY_FROM_BIT | RD::TEXTURE_USAGE_CAN_COPY_TO_BIT},
-    });
-    p_ctx->clip_mask_framebuffer = rendering_resources.create_framebuffer({
-        {"textures", TypedArray<RID>({ p_ctx->clip_mask })}
-    });
+    p_ctx->shared = acquire_shared_targets(target_size);
 
-    allocate_render_target(&p_ctx->main_target, p_size);
-    allocate_render_target(&p_ctx->back_buffer0, p_size);
-    allocate_render_target(&p_ctx->back_buffer1, p_size);
-    allocate_render_target(&p_ctx->back_buffer2, p_size);
-    allocate_render_target(&p_ctx->blend_target, p_size);
+    allocate_render_target(&p_ctx->main_target, target_size);
     p_ctx->main_tex = rs->texture_rd_create(p_ctx->main_target.color);
 	p_ctx->target_stack.push_back(&p_ctx->main_target);
 }
 
 void RDRenderInterfaceGodot::free_context(Context *p_ctx) {
     RenderingServer *rs = RenderingServer::get_singleton();
+
+    if (p_ctx->main_tex.is_valid()) {
+        rs->free_rid(p_ctx->main_tex);
+        p_ctx->main_tex = RID();
+    }
     
     free_render_target(&p_ctx->main_target);
-    free_render_target(&p_ctx->back_buffer0);
-    free_render_target(&p_ctx->back_buffer1);
-    free_render_target(&p_ctx->back_buffer2);
-    free_render_target(&p_ctx->blend_target);
 
-	for (auto render_target : p_ctx->target_stack) {
-		free_render_target(render_target);
-	}
+	// Layer targets are only borrowed during a frame, they belong to the shared pool
 	p_ctx->target_stack.clear();
     
-    if (p_ctx->clip_mask_framebuffer.is_valid()) {
-        rendering_resources.free_framebuffer(p_ctx->clip_mask_framebuffer);
-        p_ctx->clip_mask_framebuffer = RID();
+    if (p_ctx->shared != nullptr) {
+        release_shared_targets(p_ctx->shared);
+        p_ctx->shared = nullptr;
     }
 
-    if (p_ctx->clip_mask.is_valid()) {
-        rendering_resources.free_texture(p_ctx->clip_mask);
-        p_ctx->clip_mask = RID();
-    }
-    if (p_ctx->main_tex.is_valid()) {
-        rs->free_rid(p_ctx->main_tex);
-        p_ctx->main_tex = RID();
-    }
+    p_ctx->size = Vector2i();
+    p_ctx->target_size = Vector2i();
 }
 
 RDRenderInterfaceGodot::RenderTarget *RDRenderInterfaceGodot::get_render_target() {
 	return context->target_stack[context->target_stack_ptr];
 }
 
-void RDRenderInterfaceGodot::push_context(void *&p_ctx, const Vector2i &p_size) {
+void RDRenderInterfaceGodot::push_context(void *&p_ctx, const Vector2i &p_size, bool p_incremental, bool p_direct) {
     Context *ctx = static_cast<Context *>(p_ctx);
     if (ctx == nullptr) {
         ctx = memnew(Context);
@@ -431,32 +606,95 @@ void RDRenderInterfaceGodot::push_context(void *&p_ctx, const Vector2i &p_size)
     }
     context = ctx;
 
-    allocate_context(ctx, p_size);
+    if (gpu_profiling_enabled) {
+        resolve_timestamps();
+    }
 
-    RD *rd = rendering_resources.device();
-    rd->texture_clear(ctx->main_target.color, Color(0, 0, 0, 0), 0, 1, 0, 1);
+    if (ctx->direct_rendering != p_direct) {
+        ctx->direct_rendering = p_direct;
+        direct_rendering_contexts += p_direct ? 1 : -1;
+    }
+    ctx->direct_eligible = p_direct;
+    ctx->canvas_draws.clear();
+
+    allocate_context(ctx, p_size);
 
     context->target_stack_ptr = 0;
+    context->commands.clear();
+    context->signature = 0;
+    context->incremental = p_incremental;
+    context->draws.clear();
+    context->damage_tracking = true;
+    update_submission_capacities();
+
+    render_pass(clear_pass(context->main_target.framebuffer));
 
     clear_debug_commands();
 }
 
 void RDRenderInterfaceGodot::pop_context() {
     ERR_FAIL_COND_MSG(!check_if_can_render_with_scissor(), "Cannot happen, scissor must be cleared before finishing rendering");
-    render_pass(blit_pass(context->main_target.color, context->back_buffer0.framebuffer));
 
-    RenderPass pass;
-    pass.debug_name = "GodotRmlUi_PostProcess";
-	pass.shader = shader_post_process;
-	pass.pipeline = pipeline_post_process;
-	
-	pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-	pass.framebuffer = context->main_target.framebuffer;
+    // Geometry is drawn straight into the canvas by draw_context, main_target isn't needed
+    context->direct_frame = context->direct_rendering && context->direct_eligible;
+    if (context->direct_frame) {
+        context->commands.clear();
+        context->has_frame = false;
+        context->has_draw_history = false;
+        finish_context();
+        return;
+    }
+    context->canvas_draws.clear();
 
-	render_pass(pass);
+    // Otherwise main_target is composited premultiplied by draw_context, without any extra pass
+    if (post_process_enabled) {
+        render_pass(blit_pass(context->main_target.color, TARGET_SLOT_BACK_BUFFER0));
+
+        RenderPass pass;
+        pass.debug_name = "GodotRmlUi_PostProcess";
+        pass.shader = get_shader(SHADER_POST_PROCESS);
+        pass.pipeline = get_pipeline(PIPELINE_POST_PROCESS);
+
+        pass.uniform_textures.push_back(TextureBinding(TARGET_SLOT_BACK_BUFFER0));
+        pass.framebuffer = context->main_target.framebuffer;
+
+        render_pass(pass);
+    }
+
+    // The same commands over the same resources produce the same image,
+    // so the previous frame in main_target can be kept as is
+    bool unchanged = context->incremental && context->has_frame && context->signature == context->last_signature;
+    if (!unchanged) {
+        Rect2i damage;
+        if (context->incremental && compute_damage(damage)) {
+            restrict_commands(damage);
+        }
+        execute_commands();
+        context->has_frame = true;
+        context->last_signature = context->signature;
+    }
+    context->commands.clear();
+
+    context->last_draws.swap(context->draws);
+    context->has_draw_history = context->damage_tracking;
+
+    finish_context();
+}
+
+void RDRenderInterfaceGodot::finish_context() {
+    stats.submission_allocations += update_submission_capacities();
+
+    evict_idle_layer_targets();
+    evict_released_textures();
+    if (uniform_sets.size() > UNIFORM_SET_CACHE_PURGE_SIZE) {
+        purge_uniform_sets();
+    }
+    run_canvas_releases();
 
     context = nullptr;
 
+    run_pending_releases();
+
     flush_debug_commands();
 }
 
@@ -464,18 +702,43 @@ void RDRenderInterfaceGodot::draw_context(void *&p_ctx, const RID &p_canvas_item
     Context *ctx = static_cast<Context *>(p_ctx);
     RenderingServer *rs = RenderingServer::get_singleton();
 
+    if (ctx->direct_frame) {
+        draw_canvas_draws(ctx, p_canvas_item);
+        return;
+    }
+
     Vector2i size = ctx->size;
 
-    rs->canvas_item_add_texture_rect(
-		p_canvas_item,
+    // main_target holds premultiplied colors unless the post process pass un-multiplied them
+    RID item = p_canvas_item;
+    if (!post_process_enabled) {
+        item = prepare_canvas_item(ctx, 0, p_canvas_item);
+    }
+    clear_canvas_items(ctx, post_process_enabled ? 0 : 1);
+
+    rs->canvas_item_add_texture_rect_region(
+		item,
 		Rect2(0, 0, size.x, size.y),
-		ctx->get_texture()
+		ctx->get_texture(),
+		Rect2(0, 0, size.x, size.y)
 	);
 }
 
 void RDRenderInterfaceGodot::free_context(void *&p_ctx) {
     Context *ctx = static_cast<Context *>(p_ctx);
     if (ctx == nullptr) return;
+
+    if (ctx->direct_rendering) {
+        direct_rendering_contexts--;
+    }
+    RenderingServer *rs = RenderingServer::get_singleton();
+    for (const RID &item : ctx->canvas_items) {
+        rs->free_rid(item);
+    }
+
+    for (auto it = pending_timestamps.begin(); it != pending_timestamps.end();) {
+        it = it->second.context == ctx ? pending_timestamps.erase(it) : std::next(it);
+    }
     
     free_context(ctx);
     memdelete(ctx);
@@ -483,31 +746,532 @@ void RDRenderInterfaceGodot::free_context(void *&p_ctx) {
     p_ctx = nullptr;
 }
 
-void RDRenderInterfaceGodot::render_pass(const RenderPass &p_pass) {
-	RD *rd = rendering_resources.device();
+void RDRenderInterfaceGodot::queue_release(const std::function<void()> &p_release) {
+    // Resources released while a context is recording may still be referenced by its commands
+    if (context != nullptr) {
+        pending_releases.push_back(p_release);
+    } else {
+        p_release();
+    }
+}
 
-	TypedArray<RDUniform> uniforms;
-	uniforms.resize(p_pass.uniform_textures.size());
-	for (int i = p_pass.uniform_textures.size() - 1; i >= 0; i--) {
-		Ref<RDUniform> uniform = memnew(RDUniform);
-		uniform->set_uniform_type(RD::UNIFORM_TYPE_SAMPLER_WITH_TEXTURE);
-		uniform->set_binding(i);
-		uniform->add_id(p_pass.uniform_textures[i].second ? sampler_linear : sampler_nearest);
-		uniform->add_id(p_pass.uniform_textures[i].first);
-		uniforms[i] = uniform;
-	}
+void RDRenderInterfaceGodot::run_pending_releases() {
+    for (const std::function<void()> &release : pending_releases) {
+        release();
+    }
+    pending_releases.clear();
+}
 
-	if (p_pass.uniform_buffer.is_valid()) {
-		Ref<RDUniform> uniform = memnew(RDUniform);
-		uniform->set_uniform_type(RD::UNIFORM_TYPE_STORAGE_BUFFER);
-		uniform->set_binding(uniforms.size());
-		uniform->add_id(p_pass.uniform_buffer);
-		uniforms.append(uniform);
-	}
+uint64_t RDRenderInterfaceGodot::hash_pass(const RenderPass &p_pass, uint64_t p_hash) {
+    uint64_t h = p_hash;
+    h = hash_djb2_one_64(p_pass.pipeline.get_id(), h);
+    h = hash_djb2_one_64(p_pass.framebuffer.get_id(), h);
+    h = hash_djb2_one_64(p_pass.image.get_id(), h);
+    h = hash_djb2_one_64(p_pass.region_scale, h);
+    if (p_pass.instanced) {
+        uint64_t translation;
+        memcpy(&translation, &p_pass.translation, sizeof(translation));
+        h = hash_djb2_one_64(translation, h);
+    }
+    if (p_pass.mesh_data) {
+        h = hash_djb2_one_64(p_pass.mesh_data->vertex_array.get_id(), h);
+        h = hash_djb2_one_64(p_pass.mesh_data->index_array.get_id(), h);
+    }
+    for (const TextureBinding &tex : p_pass.uniform_textures) {
+        h = hash_djb2_one_64(tex.texture.get_id(), h);
+        h = hash_djb2_one_64(tex.linear_filtering, h);
+        h = hash_djb2_one_64(tex.version, h);
+    }
+    h = hash_djb2_one_64(p_pass.uniform_buffer.get_id(), h);
+
+    const uint8_t *push_const = p_pass.push_const.ptr();
+    for (int64_t i = 0; i + 4 <= p_pass.push_const.size(); i += 4) {
+        uint32_t word;
+        memcpy(&word, push_const + i, 4);
+        h = hash_djb2_one_64(word, h);
+    }
+
+    h = hash_djb2_one_64((int64_t)p_pass.draw_flags, h);
+    h = hash_djb2_one_64(p_pass.clear_stencil, h);
+    for (const Color &c : p_pass.clear_colors) {
+        h = hash_djb2_one_64(c.to_rgba64(), h);
+    }
+    h = hash_djb2_one_64(p_pass.region.position.x, h);
+    h = hash_djb2_one_64(p_pass.region.position.y, h);
+    h = hash_djb2_one_64(p_pass.region.size.x, h);
+    h = hash_djb2_one_64(p_pass.region.size.y, h);
+
+    h = hash_djb2_one_64(p_pass.scissor_enabled, h);
+    if (p_pass.scissor_enabled) {
+        h = hash_djb2_one_64((int64_t)p_pass.scissor_region.position.x, h);
+        h = hash_djb2_one_64((int64_t)p_pass.scissor_region.position.y, h);
+        h = hash_djb2_one_64((int64_t)p_pass.scissor_region.size.x, h);
+        h = hash_djb2_one_64((int64_t)p_pass.scissor_region.size.y, h);
+    }
+
+    return h;
+}
+
+bool RDRenderInterfaceGodot::get_draw_bounds(const RenderPass &p_pass, const Rml::Vector2f &p_translation, Rect2i &r_bounds) const {
+    if (p_pass.mesh_data == nullptr) return false;
+
+    Rml::Matrix4f transform = get_final_transform(drawing_matrix, p_translation);
+    const Rect2 &bounds = p_pass.mesh_data->bounds;
+    Vector2 corners[4] = {
+        bounds.position,
+        bounds.position + Vector2(bounds.size.x, 0),
+        bounds.position + Vector2(0, bounds.size.y),
+        bounds.get_end()
+    };
+
+    Rect2 screen_bounds;
+    for (int i = 0; i < 4; i++) {
+        Rml::Vector4f p = transform * Rml::Vector4f(corners[i].x, corners[i].y, 0, 1);
+        // Projected as the shaders do, which take xy without dividing by w
+        Vector2 point = Vector2(p.x, p.y);
+        if (i == 0) {
+            screen_bounds = Rect2(point, Vector2());
+        } else {
+            screen_bounds = screen_bounds.expand(point);
+        }
+    }
+
+    // Account for rasterization rounding
+    screen_bounds = screen_bounds.grow(1.0);
+    if (p_pass.scissor_enabled) {
+        screen_bounds = screen_bounds.intersection(p_pass.scissor_region);
+    }
+    screen_bounds = screen_bounds.intersection(Rect2(Vector2(), context->size));
+
+    Vector2i begin = screen_bounds.position.floor();
+    Vector2i end = screen_bounds.get_end().ceil();
+    r_bounds = Rect2i(begin, end - begin);
+    return true;
+}
+
+void RDRenderInterfaceGodot::track_draw(const Rml::Vector2f &p_translation, bool p_unbounded) {
+    if (!context->damage_tracking) return;
+
+    const RenderPass &pass = context->commands.back();
+
+    DrawRecord record;
+    record.hash = hash_pass(pass, 0);
+    record.unbounded = p_unbounded || !get_draw_bounds(pass, p_translation, record.bounds);
+
+    context->draws.push_back(record);
+}
+
+void RDRenderInterfaceGodot::track_layer_content(const Rml::Vector2f &p_translation) {
+    // Layers only, the main target is always drawn as a whole
+    if (context->target_stack_ptr == 0) return;
+
+    Rect2i bounds;
+    if (!get_draw_bounds(context->commands.back(), p_translation, bounds)) {
+        bounds = Rect2i(Vector2i(), context->size);
+    }
+    extend_layer_content(get_render_target(), bounds);
+}
+
+void RDRenderInterfaceGodot::extend_layer_content(RenderTarget *p_target, const Rect2i &p_bounds) {
+    if (!p_bounds.has_area()) return;
+    p_target->content_bounds = p_target->content_bounds.has_area() ? p_target->content_bounds.merge(p_bounds) : p_bounds;
+}
+
+RDRenderInterfaceGodot::DrawCount *RDRenderInterfaceGodot::find_draw_count(uint64_t p_hash) {
+    auto it = std::lower_bound(damage_counts.begin(), damage_counts.end(), p_hash, [](const DrawCount &p_count, uint64_t p_value) {
+        return p_count.hash < p_value;
+    });
+    return it != damage_counts.end() && it->hash == p_hash ? &*it : nullptr;
+}
+
+uint32_t RDRenderInterfaceGodot::update_submission_capacities() {
+    const size_t capacities[SUBMISSION_BUFFER_COUNT] = {
+        context->commands.capacity(),
+        // Swapped every frame, so only their total can tell a growth
+        context->draws.capacity() + context->last_draws.capacity(),
+        context->canvas_draws.capacity(),
+        context->target_stack.capacity(),
+        damage_counts.capacity(),
+        damage_last_order.capacity(),
+        damage_current_order.capacity(),
+        damage_changed.capacity(),
+        instance_capacity
+    };
+
+    uint32_t grown = 0;
+    for (int i = 0; i < SUBMISSION_BUFFER_COUNT; i++) {
+        if (capacities[i] > submission_capacities[i]) {
+            grown++;
+        }
+        submission_capacities[i] = capacities[i];
+    }
+    return grown;
+}
+
+bool RDRenderInterfaceGodot::compute_damage(Rect2i &r_damage) {
+    if (!context->has_frame || !context->damage_tracking || !context->has_draw_history) {
+        return false;
+    }
+
+    // Draws present in only one of the frames damage the area they cover. Counted in a sorted
+    // array reused between frames rather than a map, which would allocate a node per draw
+    damage_counts.clear();
+    for (const DrawRecord &record : context->draws) {
+        DrawCount count;
+        count.hash = record.hash;
+        damage_counts.push_back(count);
+    }
+    std::sort(damage_counts.begin(), damage_counts.end(), [](const DrawCount &p_a, const DrawCount &p_b) {
+        return p_a.hash < p_b.hash;
+    });
+    size_t distinct = 0;
+    for (size_t i = 0; i < damage_counts.size(); i++) {
+        if (distinct == 0 || damage_counts[distinct - 1].hash != damage_counts[i].hash) {
+            damage_counts[distinct++] = damage_counts[i];
+        }
+        damage_counts[distinct - 1].available++;
+    }
+    damage_counts.resize(distinct);
+
+    damage_last_order.clear();
+    damage_current_order.clear();
+    damage_changed.clear();
+
+    for (const DrawRecord &record : context->last_draws) {
+        DrawCount *count = find_draw_count(record.hash);
+        if (count != nullptr && count->available > 0) {
+            count->available--;
+            count->matched++;
+            damage_last_order.push_back(record.hash);
+        } else {
+            damage_changed.push_back(&record);
+        }
+    }
+    for (const DrawRecord &record : context->draws) {
+        DrawCount *count = find_draw_count(record.hash);
+        if (count != nullptr && count->matched > 0) {
+            count->matched--;
+            damage_current_order.push_back(record.hash);
+        } else {
+            damage_changed.push_back(&record);
+        }
+    }
+
+    // Reordered draws may blend differently anywhere they overlap
+    if (damage_last_order != damage_current_order) {
+        return false;
+    }
+
+    Rect2i damage;
+    for (const DrawRecord *record : damage_changed) {
+        if (record->unbounded) {
+            return false;
+        }
+        if (!record->bounds.has_area()) continue;
+        damage = damage.has_area() ? damage.merge(record->bounds) : record->bounds;
+    }
+
+    // Past half of the context, restricting every pass is not worth it
+    if ((int64_t)damage.get_area() * 2 > (int64_t)context->size.x * context->size.y) {
+        return false;
+    }
+
+    r_damage = damage;
+    return true;
+}
+
+void RDRenderInterfaceGodot::restrict_commands(const Rect2i &p_damage) {
+    size_t kept = 0;
+    for (RenderPass &pass : context->commands) {
+        Rect2i region = pass.region.has_area() ? pass.region.intersection(p_damage) : p_damage;
+        if (!region.has_area()) continue;
+        pass.region = region;
+
+        Rect2 scissor = pass.scissor_enabled ? pass.scissor_region.intersection(Rect2(p_damage)) : Rect2(p_damage);
+        if (!scissor.has_area()) {
+            // Nothing to draw, but the attachments must still be cleared inside the damaged region
+            if ((int64_t)pass.draw_flags == RD::DRAW_DEFAULT_ALL) continue;
+            pass.pipeline = RID();
+        }
+        pass.scissor_enabled = true;
+        pass.scissor_region = scissor;
+
+        context->commands[kept++] = pass;
+    }
+
+    context->commands.resize(kept);
+}
+
+void RDRenderInterfaceGodot::execute_commands() {
+    prepare_instances();
+
+    // At most a timestamp per pass plus the closing one, frames without room for them go unmeasured
+    timing_execution = gpu_profiling_enabled && reserve_timestamps(context->commands.size() + 1);
+    execution_serial++;
+
+    for (const RenderPass &pass : context->commands) {
+        // Merged into the first draw of its run
+        if (pass.instance_count == 0) continue;
+        execute_pass(pass);
+    }
+    flush_batch();
+
+    if (timing_execution) {
+        capture_timestamp(nullptr);
+        timing_execution = false;
+    }
+}
+
+bool RDRenderInterfaceGodot::reserve_timestamps(uint32_t p_count) {
+    uint64_t frame = Engine::get_singleton()->get_frames_drawn();
+    if (frame != timestamp_frame) {
+        timestamp_frame = frame;
+        timestamps_used = 0;
+    }
+    if (timestamps_used + p_count > timestamp_budget) {
+        return false;
+    }
+    timestamps_used += p_count;
+    return true;
+}
+
+void RDRenderInterfaceGodot::capture_timestamp(const char *p_kind) {
+    uint64_t serial = ++timestamp_serial;
+
+    TimestampRecord &record = pending_timestamps[serial];
+    record.context = context;
+    record.execution = execution_serial;
+    record.kind = p_kind;
+
+    rendering_resources.device()->capture_timestamp(vformat("%s%d", TIMESTAMP_PREFIX, serial));
+}
+
+void RDRenderInterfaceGodot::resolve_timestamps() {
+    if (pending_timestamps.empty()) return;
+
+    RD *rd = rendering_resources.device();
+    uint64_t frame = rd->get_captured_timestamps_frame();
+    if (frame == resolved_timestamp_frame) return;
+    resolved_timestamp_frame = frame;
+
+    // Ours among the timestamps of the frame, in the order they were captured
+    std::vector<std::pair<uint64_t, uint64_t>> captured;
+    String prefix = TIMESTAMP_PREFIX;
+    uint32_t count = rd->get_captured_timestamps_count();
+    for (uint32_t i = 0; i < count; i++) {
+        String name = rd->get_captured_timestamp_name(i);
+        if (!name.begins_with(prefix)) continue;
+        captured.push_back({ (uint64_t)name.substr(prefix.length()).to_int(), rd->get_captured_timestamp_gpu_time(i) });
+    }
+    if (captured.empty()) return;
+
+    // Each kind lasts until the next timestamp of the same commands
+    std::map<Context *, std::map<String, uint64_t>> frame_times;
+    for (size_t i = 0; i + 1 < captured.size(); i++) {
+        auto start = pending_timestamps.find(captured[i].first);
+        auto end = pending_timestamps.find(captured[i + 1].first);
+        if (start == pending_timestamps.end() || end == pending_timestamps.end()) continue;
+        if (start->second.kind == nullptr || start->second.execution != end->second.execution) continue;
+
+        uint64_t usec = captured[i + 1].second - captured[i].second;
+        std::map<String, uint64_t> &times = frame_times[start->second.context];
+        times[String(start->second.kind).trim_prefix(PASS_NAME_PREFIX)] += usec;
+        times["Total"] += usec;
+    }
+    for (auto &it : frame_times) {
+        it.first->gpu_times = std::move(it.second);
+    }
+
+    // Anything captured up to here either was resolved now or won't ever be
+    pending_timestamps.erase(pending_timestamps.begin(), pending_timestamps.upper_bound(captured.back().first));
+}
+
+Dictionary RDRenderInterfaceGodot::get_context_gpu_times(void *&p_ctx) {
+    Dictionary times;
+    Context *ctx = static_cast<Context *>(p_ctx);
+    if (ctx == nullptr) return times;
+
+    for (const auto &it : ctx->gpu_times) {
+        times[it.first] = it.second;
+    }
+    return times;
+}
+
+bool RDRenderInterfaceGodot::can_instance(const RenderPass &p_first, const RenderPass &p_next) {
+    if (!p_next.instanced ||
+        p_next.pipeline != p_first.pipeline ||
+        p_next.mesh_data != p_first.mesh_data ||
+        p_next.framebuffer != p_first.framebuffer ||
+        p_next.region != p_first.region ||
+        p_next.scissor_enabled != p_first.scissor_enabled ||
+        (p_first.scissor_enabled && p_next.scissor_region != p_first.scissor_region) ||
+        p_next.uniform_textures.size() != p_first.uniform_textures.size() ||
+        p_next.push_const.size() != p_first.push_const.size()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < p_first.uniform_textures.size(); i++) {
+        if (p_next.uniform_textures[i].texture != p_first.uniform_textures[i].texture ||
+            p_next.uniform_textures[i].linear_filtering != p_first.uniform_textures[i].linear_filtering) {
+            return false;
+        }
+    }
+    return memcmp(p_next.push_const.ptr(), p_first.push_const.ptr(), p_first.push_const.size()) == 0;
+}
+
+void RDRenderInterfaceGodot::prepare_instances() {
+    std::vector<RenderPass> &commands = context->commands;
+
+    uint32_t instance_count = 0;
+    for (size_t i = 0; i < commands.size();) {
+        if (!commands[i].instanced) {
+            i++;
+            continue;
+        }
+
+        size_t run_end = i + 1;
+        while (batching_enabled && run_end < commands.size() && can_instance(commands[i], commands[run_end])) {
+            commands[run_end].instance_count = 0;
+            run_end++;
+        }
+        commands[i].instance_offset = instance_count;
+        commands[i].instance_count = run_end - i;
+        instance_count += run_end - i;
+        i = run_end;
+    }
+    if (instance_count == 0) return;
+
+    if (instance_count > instance_capacity) {
+        if (instance_buffer.is_valid()) {
+            rendering_resources.free_storage_buffer(instance_buffer);
+        }
+        instance_capacity = MAX(MIN_INSTANCE_CAPACITY, next_power_of_2(instance_count));
+        instance_data.resize(instance_capacity * sizeof(Rml::Vector2f));
+        instance_buffer = rendering_resources.create_storage_buffer({ instance_data });
+    }
+
+    // Runs are made of consecutive passes, so translations are written in command order
+    Rml::Vector2f *translations = (Rml::Vector2f *)instance_data.ptrw();
+    uint32_t index = 0;
+    for (RenderPass &pass : commands) {
+        if (!pass.instanced) continue;
+        translations[index++] = pass.translation;
+        pass.uniform_buffer = instance_buffer;
+    }
+
+    rendering_resources.device()->buffer_update(instance_buffer, 0, instance_count * sizeof(Rml::Vector2f), instance_data);
+}
+
+RID RDRenderInterfaceGodot::get_uniform_set(const RenderPass &p_pass) {
+    RD *rd = rendering_resources.device();
+
+    uint64_t h = hash_djb2_one_64(p_pass.shader.get_id());
+    for (const TextureBinding &tex : p_pass.uniform_textures) {
+        h = hash_djb2_one_64(tex.texture.get_id(), h);
+        h = hash_djb2_one_64(tex.linear_filtering, h);
+    }
+    h = hash_djb2_one_64(p_pass.uniform_buffer.get_id(), h);
+    h = hash_djb2_one_64(p_pass.image.get_id(), h);
+
+    auto it = uniform_sets.find(h);
+    if (it != uniform_sets.end()) {
+        const UniformSetEntry &entry = it->second;
+        bool matches = entry.shader == p_pass.shader &&
+            entry.uniform_buffer == p_pass.uniform_buffer &&
+            entry.image == p_pass.image &&
+            entry.textures.size() == p_pass.uniform_textures.size();
+        for (size_t i = 0; matches && i < entry.textures.size(); i++) {
+            matches = entry.textures[i].texture == p_pass.uniform_textures[i].texture &&
+                entry.textures[i].linear_filtering == p_pass.uniform_textures[i].linear_filtering;
+        }
+        // Sets are freed along with any of their textures or buffers
+        if (matches && rd->uniform_set_is_valid(entry.uniform_set)) {
+            return entry.uniform_set;
+        }
+        if (rd->uniform_set_is_valid(entry.uniform_set)) {
+            rd->free_rid(entry.uniform_set);
+        }
+        uniform_sets.erase(it);
+    }
+
+    TypedArray<RDUniform> uniforms;
+    uniforms.resize(p_pass.uniform_textures.size());
+    for (int i = p_pass.uniform_textures.size() - 1; i >= 0; i--) {
+        Ref<RDUniform> uniform = memnew(RDUniform);
+        uniform->set_uniform_type(RD::UNIFORM_TYPE_SAMPLER_WITH_TEXTURE);
+        uniform->set_binding(i);
+        uniform->add_id(p_pass.uniform_textures[i].linear_filtering ? sampler_linear : sampler_nearest);
+        uniform->add_id(p_pass.uniform_textures[i].texture);
+        uniforms[i] = uniform;
+    }
+
+    if (p_pass.uniform_buffer.is_valid()) {
+        Ref<RDUniform> uniform = memnew(RDUniform);
+        uniform->set_uniform_type(RD::UNIFORM_TYPE_STORAGE_BUFFER);
+        uniform->set_binding(uniforms.size());
+        uniform->add_id(p_pass.uniform_buffer);
+        uniforms.append(uniform);
+    }
+
+    if (p_pass.image.is_valid()) {
+        Ref<RDUniform> uniform = memnew(RDUniform);
+        uniform->set_uniform_type(RD::UNIFORM_TYPE_IMAGE);
+        uniform->set_binding(uniforms.size());
+        uniform->add_id(p_pass.image);
+        uniforms.append(uniform);
+    }
+
+    UniformSetEntry entry;
+    entry.uniform_set = rd->uniform_set_create(uniforms, p_pass.shader, 0);
+    entry.shader = p_pass.shader;
+    entry.uniform_buffer = p_pass.uniform_buffer;
+    entry.image = p_pass.image;
+    entry.textures = p_pass.uniform_textures;
+
+    RID uniform_set = entry.uniform_set;
+    uniform_sets[h] = std::move(entry);
+    return uniform_set;
+}
+
+void RDRenderInterfaceGodot::purge_uniform_sets(bool p_free_all) {
+    RD *rd = rendering_resources.device();
+
+    for (auto it = uniform_sets.begin(); it != uniform_sets.end();) {
+        bool valid = rd->uniform_set_is_valid(it->second.uniform_set);
+        if (valid && !p_free_all) {
+            it++;
+            continue;
+        }
+        if (valid) {
+            rd->free_rid(it->second.uniform_set);
+        }
+        it = uniform_sets.erase(it);
+    }
+}
 
+bool RDRenderInterfaceGodot::can_batch_pass(const RenderPass &p_pass) const {
+    // Passes that clear their attachments must open their own draw list
+    return batching_enabled && 
+        batch.is_open() && 
+        batch.framebuffer == p_pass.framebuffer && 
+        batch.region == p_pass.region && 
+        (int64_t)p_pass.draw_flags == RD::DRAW_DEFAULT_ALL &&
+        // Timestamps can't be captured inside a draw list, so each kind gets its own while profiling
+        (!timing_execution || strcmp(batch.debug_name, p_pass.debug_name) == 0);
+}
+
+void RDRenderInterfaceGodot::begin_batch(const RenderPass &p_pass) {
+    RD *rd = rendering_resources.device();
+
+    if (timing_execution) {
+        capture_timestamp(p_pass.debug_name);
+    }
     rd->draw_command_begin_label(p_pass.debug_name, Color(0, 0, 0, 0));
 
-	int64_t draw_list = rd->draw_list_begin(
+    batch = DrawBatch();
+    batch.debug_name = p_pass.debug_name;
+    batch.framebuffer = p_pass.framebuffer;
+    batch.region = p_pass.region;
+	batch.draw_list = rd->draw_list_begin(
 		p_pass.framebuffer,
 		p_pass.draw_flags,
 		p_pass.clear_colors,
@@ -516,45 +1280,191 @@ void RDRenderInterfaceGodot::render_pass(const RenderPass &p_pass) {
         Rect2(p_pass.region)
 	);
 
-	if (scissor_enabled) {
-		rd->draw_list_enable_scissor(draw_list, scissor_region);
-	} else {
-		rd->draw_list_disable_scissor(draw_list);
+    // Force the first pass to set the scissor state
+    batch.scissor_enabled = !p_pass.scissor_enabled;
+}
+
+void RDRenderInterfaceGodot::flush_batch() {
+    if (!batch.is_open()) return;
+
+    RD *rd = rendering_resources.device();
+
+	rd->draw_list_end();
+    rd->draw_command_end_label();
+
+    batch = DrawBatch();
+}
+
+void RDRenderInterfaceGodot::render_pass(const RenderPass &p_pass) {
+    ERR_FAIL_NULL_MSG(context, "Passes can only be rendered between push_context and pop_context");
+
+    // Recorded with the scissor state at the time of the call, executed on pop_context
+    context->commands.push_back(p_pass);
+    RenderPass &pass = context->commands.back();
+    pass.scissor_enabled = scissor_enabled;
+    pass.scissor_region = scissor_region;
+
+    if (pass.framebuffer_slot != TARGET_SLOT_NONE) {
+        RenderTarget *target = get_slot_target(pass.framebuffer_slot);
+        if (pass.compute) {
+            pass.image = target->color;
+        } else {
+            pass.framebuffer = target->framebuffer;
+        }
+    }
+    for (TextureBinding &tex : pass.uniform_textures) {
+        if (tex.slot != TARGET_SLOT_NONE) {
+            tex.texture = get_slot_target(tex.slot)->color;
+        }
+    }
+
+    context->signature = hash_pass(pass, context->signature);
+}
+
+void RDRenderInterfaceGodot::execute_pass(const RenderPass &p_pass) {
+	RD *rd = rendering_resources.device();
+
+    if (p_pass.compute) {
+        flush_batch();
+        execute_compute_pass(p_pass);
+        return;
+    }
+
+    if (!can_batch_pass(p_pass)) {
+        flush_batch();
+        begin_batch(p_pass);
+    }
+    int64_t draw_list = batch.draw_list;
+
+    // Clear only pass
+    if (!p_pass.pipeline.is_valid()) {
+        return;
+    }
+    batch.pass_count++;
+    stats.render_passes++;
+
+	if (p_pass.scissor_enabled != batch.scissor_enabled || (p_pass.scissor_enabled && p_pass.scissor_region != batch.scissor_region)) {
+        if (p_pass.scissor_enabled) {
+            rd->draw_list_enable_scissor(draw_list, p_pass.scissor_region);
+        } else {
+            rd->draw_list_disable_scissor(draw_list);
+        }
+        batch.scissor_enabled = p_pass.scissor_enabled;
+        batch.scissor_region = p_pass.scissor_region;
 	}
 
+    if (batch.pipeline != p_pass.pipeline) {
+        rd->draw_list_bind_render_pipeline(draw_list, p_pass.pipeline);
+        batch.pipeline = p_pass.pipeline;
+        // Binding a pipeline of another shader may invalidate the bound set
+        batch.uniform_set = RID();
+    }
+
 	bool procedural = true;
-	rd->draw_list_bind_render_pipeline(draw_list, p_pass.pipeline);
 	if (p_pass.mesh_data) {
-		rd->draw_list_bind_vertex_array(draw_list, p_pass.mesh_data->vertex_array);
-		rd->draw_list_bind_index_array(draw_list, p_pass.mesh_data->index_array);
+        if (batch.vertex_array != p_pass.mesh_data->vertex_array) {
+		    rd->draw_list_bind_vertex_array(draw_list, p_pass.mesh_data->vertex_array);
+            batch.vertex_array = p_pass.mesh_data->vertex_array;
+        }
+        if (batch.index_array != p_pass.mesh_data->index_array) {
+		    rd->draw_list_bind_index_array(draw_list, p_pass.mesh_data->index_array);
+            batch.index_array = p_pass.mesh_data->index_array;
+        }
 		procedural = false;
 	}
-	if (!uniforms.is_empty()) {
-		RID uniform_set = UniformSetCacheRD::get_cache(p_pass.shader, 0, uniforms);
-		rd->draw_list_bind_uniform_set(draw_list, uniform_set, 0);
+
+    if (!p_pass.uniform_textures.empty() || p_pass.uniform_buffer.is_valid()) {
+		RID uniform_set = get_uniform_set(p_pass);
+        if (batch.uniform_set != uniform_set) {
+		    rd->draw_list_bind_uniform_set(draw_list, uniform_set, 0);
+            batch.uniform_set = uniform_set;
+        }
 	}
 	if (!p_pass.push_const.is_empty()) {
-		rd->draw_list_set_push_constant(draw_list, p_pass.push_const, p_pass.push_const.size());
+        // Not shared with anything else, writing to it doesn't copy
+        memcpy(push_const_buffer.ptrw(), p_pass.push_const.ptr(), p_pass.push_const.size());
+        if (p_pass.instanced) {
+            ((uint32_t *)push_const_buffer.ptrw())[2] = p_pass.instance_offset;
+        }
+        if (p_pass.region_scale > 0) {
+            region_to_pointer((int32_t *)push_const_buffer.ptrw(), get_filter_region(p_pass));
+        }
+		rd->draw_list_set_push_constant(draw_list, push_const_buffer, p_pass.push_const.size());
 	}
 
-	if (procedural) {
-		rd->draw_list_draw(draw_list, false, 1, 3);
-	} else {
-		rd->draw_list_draw(draw_list, true, 1);
-	}
+	if (procedural) {
+		rd->draw_list_draw(draw_list, false, 1, 3);
+	} else {
+		rd->draw_list_draw(draw_list, true, p_pass.instance_count);
+	}
+    stats.draw_calls++;
+
+    if (!batching_enabled) {
+        flush_batch();
+    }
+}
+
+void RDRenderInterfaceGodot::execute_compute_pass(const RenderPass &p_pass) {
+    RD *rd = rendering_resources.device();
+
+    Rect2i region = get_filter_region(p_pass);
+    if (!region.has_area()) return;
+
+    // Same texel range as blur_region_start and blur_region_end in the shaders
+    const int32_t scale = MAX(p_pass.region_scale, 1);
+    Vector2i start = region.position / scale;
+    Vector2i end = (region.get_end() + Vector2i(scale - 1, scale - 1)) / scale;
+    Vector2i groups = (end - start + Vector2i(COMPUTE_GROUP_SIZE - 1, COMPUTE_GROUP_SIZE - 1)) / COMPUTE_GROUP_SIZE;
+
+    memcpy(push_const_buffer.ptrw(), p_pass.push_const.ptr(), p_pass.push_const.size());
+    region_to_pointer((int32_t *)push_const_buffer.ptrw(), region);
 
-	rd->draw_list_end();
+    if (timing_execution) {
+        capture_timestamp(p_pass.debug_name);
+    }
+    rd->draw_command_begin_label(p_pass.debug_name, Color(0, 0, 0, 0));
+
+    int64_t compute_list = rd->compute_list_begin();
+    rd->compute_list_bind_compute_pipeline(compute_list, p_pass.pipeline);
+    rd->compute_list_bind_uniform_set(compute_list, get_uniform_set(p_pass), 0);
+    rd->compute_list_set_push_constant(compute_list, push_const_buffer, p_pass.push_const.size());
+    rd->compute_list_dispatch(compute_list, groups.x, groups.y, 1);
+    rd->compute_list_end();
+    stats.render_passes++;
+    stats.draw_calls++;
 
     rd->draw_command_end_label();
 }
 
-RDRenderInterfaceGodot::RenderPass RDRenderInterfaceGodot::blit_pass(const RID &p_tex, const RID &p_framebuffer, const Vector2i &p_dst_pos, const Vector2i &p_src_pos, const Vector2i &p_size) {
+Rect2i RDRenderInterfaceGodot::get_filter_region(const RenderPass &p_pass) const {
+    // Filters are composited with the scissor set to the region of the element
+    Rect2i region = Rect2i(Vector2i(), context->size);
+    if (p_pass.scissor_enabled) {
+        region = region.intersection(Rect2i(p_pass.scissor_region));
+    }
+    if (p_pass.region.has_area()) {
+        region = region.intersection(p_pass.region);
+    }
+    return region;
+}
+
+RDRenderInterfaceGodot::RenderPass RDRenderInterfaceGodot::clear_pass(const RID &p_framebuffer) {
+    RenderPass pass;
+    pass.debug_name = "GodotRmlUi_ClearPass";
+    pass.framebuffer = p_framebuffer;
+    pass.draw_flags = RD::DRAW_CLEAR_COLOR_0;
+    pass.clear_colors = clear_colors_transparent;
+
+    return pass;
+}
+
+RDRenderInterfaceGodot::RenderPass RDRenderInterfaceGodot::blit_pass(const TextureBinding &p_tex, const RID &p_framebuffer, const Vector2i &p_dst_pos, const Vector2i &p_src_pos, const Vector2i &p_size) {
     RenderPass pass;
     pass.debug_name = "GodotRmlUi_BlitPass";
 	pass.shader = shader_blit;
 	pass.pipeline = pipeline_blit;
 	
-	pass.uniform_textures.push_back(std::make_pair(p_tex, false));
+	pass.uniform_textures.push_back(p_tex);
 	pass.framebuffer = p_framebuffer;
 
     pass.push_const.resize(16);
@@ -567,76 +1477,104 @@ RDRenderInterfaceGodot::RenderPass RDRenderInterfaceGodot::blit_pass(const RID &
     return pass;
 }
 
+RDRenderInterfaceGodot::RenderPass RDRenderInterfaceGodot::blit_pass(const TextureBinding &p_tex, TargetSlot p_framebuffer_slot) {
+    RenderPass pass = blit_pass(p_tex, RID());
+    pass.framebuffer_slot = p_framebuffer_slot;
+
+    return pass;
+}
+
 bool RDRenderInterfaceGodot::check_if_can_render_with_scissor() const {
     return !scissor_enabled || (scissor_region.size.x > 0 && scissor_region.size.y > 0);
 }
 
-Rml::CompiledGeometryHandle RDRenderInterfaceGodot::CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) {
-    MeshData *mesh_data = memnew(MeshData);
+static inline uint64_t geometry_fmix64(uint64_t p_hash) {
+    p_hash ^= p_hash >> 33;
+    p_hash *= 0xff51afd7ed558ccdULL;
+    p_hash ^= p_hash >> 33;
+    p_hash *= 0xc4ceb9fe1a85ec53ULL;
+    p_hash ^= p_hash >> 33;
+    return p_hash;
+}
 
-    RD *rd = rendering_resources.device();
+// Vertices and indices are made of 32-bit fields, so both hashes consume the content in words:
+// FNV-1a for the first and a MurmurHash64-style mix for the second
+static void hash_geometry_words(const uint8_t *p_data, size_t p_size, uint64_t &r_h0, uint64_t &r_h1) {
+    for (size_t i = 0; i + 4 <= p_size; i += 4) {
+        uint32_t word;
+        memcpy(&word, p_data + i, 4);
 
-    PackedByteArray position_array, color_array, uv_array, indices_array;
-    position_array.resize(vertices.size() * 2 * 4);
-    color_array.resize(vertices.size() * 4 * 4);
-    uv_array.resize(vertices.size() * 2 * 4);
-    indices_array.resize(indices.size() * 4);
+        r_h0 = (r_h0 ^ word) * 0x100000001b3ULL;
 
-    float *position_ptr = (float *)(position_array.ptrw());
-    float *color_ptr = (float *)(color_array.ptrw());
-    float *uv_ptr = (float *)(uv_array.ptrw());
-    int *index_ptr = (int *)(indices_array.ptrw());
+        uint64_t k = (uint64_t)word * 0x87c37b91114253d5ULL;
+        k = (k << 31) | (k >> 33);
+        r_h1 ^= k * 0x4cf5ad432745937fULL;
+        r_h1 = ((r_h1 << 27) | (r_h1 >> 37)) * 5 + 0x52dce729;
+    }
+}
 
-    int vert_count = vertices.size();
-    int index_count = indices.size();
+RDRenderInterfaceGodot::GeometryKey RDRenderInterfaceGodot::hash_geometry(Rml::Span<const Rml::Vertex> p_vertices, Rml::Span<const int> p_indices) {
+    const size_t vertex_size = p_vertices.size() * sizeof(Rml::Vertex);
+    const size_t index_size = p_indices.size() * sizeof(int);
+
+    uint64_t h0 = 0xcbf29ce484222325ULL;
+    uint64_t h1 = 0x9e3779b97f4a7c15ULL;
+    hash_geometry_words((const uint8_t *)p_vertices.data(), vertex_size, h0, h1);
+    // Mark the split so the same bytes can't match with a different vertex/index count
+    h0 = (h0 ^ p_vertices.size()) * 0x100000001b3ULL;
+    h1 ^= geometry_fmix64(p_vertices.size());
+    hash_geometry_words((const uint8_t *)p_indices.data(), index_size, h0, h1);
+
+    GeometryKey key;
+    key.h0 = geometry_fmix64(h0 ^ index_size);
+    key.h1 = geometry_fmix64(h1 ^ (vertex_size + index_size));
+    return key;
+}
 
-    for (int i = vert_count - 1; i >= 0; i--) {
-        const Rml::Vertex &v = vertices[i];
-        position_ptr[i * 2 + 0] = v.position.x;
-        position_ptr[i * 2 + 1] = v.position.y;
-        color_ptr[i * 4 + 0] = v.colour.red / 255.0;
-        color_ptr[i * 4 + 1] = v.colour.green / 255.0;
-        color_ptr[i * 4 + 2] = v.colour.blue / 255.0;
-        color_ptr[i * 4 + 3] = v.colour.alpha / 255.0;
-        uv_ptr[i * 2 + 0] = v.tex_coord.x;
-        uv_ptr[i * 2 + 1] = v.tex_coord.y;
+Rml::CompiledGeometryHandle RDRenderInterfaceGodot::CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) {
+    stats.geometry_compiled++;
+
+    // Repeated elements, e.g. rows of a list, compile the same backgrounds, borders and icons
+    GeometryKey content_key = hash_geometry(vertices, indices);
+    auto it = geometry_cache.find(content_key);
+    if (it != geometry_cache.end()) {
+        MeshData *mesh_data = it->second;
+        mesh_data->references++;
+        if (direct_rendering_contexts > 0 && !mesh_data->canvas_mesh.is_valid()) {
+            mesh_data->canvas_mesh = create_canvas_mesh(vertices, indices);
+        }
+        return reinterpret_cast<uintptr_t>(mesh_data);
     }
 
-    for (int i = index_count - 1; i >= 0; i--) {
-        index_ptr[i] = indices[i];
+    GeometryArena::Allocation allocation = geometry_arena.allocate(
+        (const uint8_t *)vertices.data(), vertices.size(),
+        indices.data(), indices.size()
+    );
+    if (!allocation.is_valid()) {
+        return 0;
     }
 
-    RID position_buffer = rendering_resources.create_vertex_buffer({
-        {"data", position_array}
-    });
-    RID color_buffer = rendering_resources.create_vertex_buffer({
-        {"data", color_array}
-    });
-    RID uv_buffer = rendering_resources.create_vertex_buffer({
-        {"data", uv_array}
-    });
-    RID index_buffer = rendering_resources.create_index_buffer({
-        {"data", indices_array},
-        {"count", index_count},
-        {"format", RD::INDEX_BUFFER_FORMAT_UINT32}
-    });
+    MeshData *mesh_data = memnew(MeshData);
+    mesh_data->allocation = allocation;
+    mesh_data->vertex_array = allocation.get_vertex_array();
+    mesh_data->index_array = allocation.index_array;
+
+    Rml::Vector2f min = vertices[0].position;
+    Rml::Vector2f max = vertices[0].position;
+    for (const Rml::Vertex &vertex : vertices) {
+        min.x = MIN(min.x, vertex.position.x);
+        min.y = MIN(min.y, vertex.position.y);
+        max.x = MAX(max.x, vertex.position.x);
+        max.y = MAX(max.y, vertex.position.y);
+    }
+    mesh_data->bounds = Rect2(min.x, min.y, max.x - min.x, max.y - min.y);
 
-    RID vertex_array = rendering_resources.create_vertex_array({
-        {"count", vert_count},
-        {"format", geometry_vertex_format},
-        {"buffers", TypedArray<RID>({position_buffer, color_buffer, uv_buffer})}
-    });
-    RID index_array = rendering_resources.create_index_array({
-        {"count", index_count},
-        {"buffer", index_buffer}
-    });
+    if (direct_rendering_contexts > 0) {
+        mesh_data->canvas_mesh = create_canvas_mesh(vertices, indices);
+    }
 
-    mesh_data->position_buffer = position_buffer;
-    mesh_data->color_buffer = color_buffer;
-    mesh_data->uv_buffer = uv_buffer;
-    mesh_data->index_buffer = index_buffer;
-    mesh_data->vertex_array = vertex_array;
-    mesh_data->index_array = index_array;
+    mesh_data->content_key = content_key;
+    geometry_cache[content_key] = mesh_data;
 
     return reinterpret_cast<uintptr_t>(mesh_data);
 }
@@ -651,38 +1589,57 @@ void RDRenderInterfaceGodot::RenderGeometry(Rml::CompiledGeometryHandle geometry
 
 	pass.mesh_data = reinterpret_cast<MeshData *>(geometry);
 
+    // The translation isn't part of the push constant, so draws of the same geometry can be instanced
+    pass.instanced = true;
+    pass.translation = translation;
 	pass.push_const.resize(80);
     float *push_const = (float *)pass.push_const.ptrw();
-    push_const[0] = 1.0 / context->size.x;
-    push_const[1] = 1.0 / context->size.y;
-    matrix_to_pointer(push_const + 4, get_final_transform(drawing_matrix, translation));
+    push_const[0] = 1.0 / context->target_size.x;
+    push_const[1] = 1.0 / context->target_size.y;
+    matrix_to_pointer(push_const + 4, drawing_matrix);
 	
 	if (texture != 0) {
-		TextureData *tex = reinterpret_cast<TextureData *>(texture);
-		pass.uniform_textures.push_back(std::make_pair(tex->rid, tex->linear_filtering));
+		pass.uniform_textures.push_back(get_texture_binding(reinterpret_cast<TextureData *>(texture)));
 	} else {
-		pass.uniform_textures.push_back(std::make_pair(texture_white, false));
+		pass.uniform_textures.push_back(TextureBinding(texture_white, false));
 	}
 	pass.framebuffer = get_render_target()->framebuffer;
 
 	render_pass(pass);
+    track_draw(translation);
+    track_layer_content(translation);
+
+    if (context->direct_eligible) {
+        record_canvas_draw(pass.mesh_data, translation, texture);
+    }
 }
 
 void RDRenderInterfaceGodot::ReleaseGeometry(Rml::CompiledGeometryHandle geometry) {
 	MeshData *mesh_data = reinterpret_cast<MeshData *>(geometry);
     ERR_FAIL_NULL(mesh_data);
 
-    RenderingServer *rs = RenderingServer::get_singleton();
-    RD *rd = rs->get_rendering_device();
-    
-    rendering_resources.free_vertex_array(mesh_data->vertex_array);
-    rendering_resources.free_index_array(mesh_data->index_array);
-    rendering_resources.free_vertex_buffer(mesh_data->position_buffer);
-    rendering_resources.free_vertex_buffer(mesh_data->color_buffer);
-    rendering_resources.free_vertex_buffer(mesh_data->uv_buffer);
-    rendering_resources.free_index_buffer(mesh_data->index_buffer);
+    ERR_FAIL_COND(mesh_data->references == 0);
+    stats.geometry_released++;
+    mesh_data->references--;
+    if (mesh_data->references > 0) return;
+
+    // A colliding geometry may have replaced it in the cache
+    auto it = geometry_cache.find(mesh_data->content_key);
+    if (it != geometry_cache.end() && it->second == mesh_data) {
+        geometry_cache.erase(it);
+    }
+
+    if (mesh_data->canvas_mesh.is_valid()) {
+        RID canvas_mesh = mesh_data->canvas_mesh;
+        queue_canvas_release([canvas_mesh]() {
+            RenderingServer::get_singleton()->free_rid(canvas_mesh);
+        });
+    }
 
-    memdelete(mesh_data);
+    queue_release([this, mesh_data]() {
+        geometry_arena.free(mesh_data->allocation);
+        memdelete(mesh_data);
+    });
 }
 
 Rml::TextureHandle RDRenderInterfaceGodot::LoadTexture(Rml::Vector2i& texture_dimensions, const Rml::String& source) {
@@ -703,28 +1660,74 @@ Rml::TextureHandle RDRenderInterfaceGodot::LoadTexture(Rml::Vector2i& texture_di
     TextureData *tex_data = memnew(TextureData());
     tex_data->tex_ref = tex;
     tex_data->rid = rs->texture_get_rd_texture(tex->get_rid());
+    // Imported textures only change when reimported, which loads them again
+    tex_data->mutable_content = !tex->is_class("CompressedTexture2D");
 
     return reinterpret_cast<uintptr_t>(tex_data);
 }
 
+RDRenderInterfaceGodot::TextureBinding RDRenderInterfaceGodot::get_texture_binding(TextureData *p_texture) {
+    // A version never used before makes the frame signature differ every time it's drawn
+    uint64_t version = p_texture->mutable_content ? ++texture_version : p_texture->version;
+    return TextureBinding(p_texture->rid, p_texture->linear_filtering, version);
+}
+
 Rml::TextureHandle RDRenderInterfaceGodot::GenerateTexture(Rml::Span<const Rml::byte> source, Rml::Vector2i source_dimensions) {
+    Vector2i size = Vector2i(source_dimensions.x, source_dimensions.y);
+    uint32_t pixel_count = size.x * size.y;
+    ERR_FAIL_COND_V(source.size() < pixel_count * 4, 0);
+    stats.textures_generated++;
+
+    // Glyphs of plain fonts come premultiplied with every channel set to the coverage
+    bool single_channel = true;
+    for (uint32_t i = 0; i < pixel_count && single_channel; i++) {
+        const Rml::byte *pixel = source.data() + i * 4;
+        single_channel = pixel[0] == pixel[3] && pixel[1] == pixel[3] && pixel[2] == pixel[3];
+    }
+
+    uint32_t bytes_per_pixel = single_channel ? 1 : 4;
 	PackedByteArray p_data;
-    p_data.resize(source.size());
+    p_data.resize(pixel_count * bytes_per_pixel);
 
     uint8_t *ptrw = p_data.ptrw();
+    if (single_channel) {
+        for (uint32_t i = 0; i < pixel_count; i++) {
+            ptrw[i] = source[i * 4 + 3];
+        }
+    } else {
+        memcpy(ptrw, source.data(), pixel_count * 4);
+    }
 
-    memcpy(ptrw, source.data(), source.size());
+    uint32_t row_size = size.x * bytes_per_pixel;
+    std::vector<uint64_t> row_hashes(size.y);
+    for (int32_t y = 0; y < size.y; y++) {
+        const uint8_t *row = ptrw + y * row_size;
+        row_hashes[y] = ((uint64_t)hash_murmur3_buffer(row, row_size) << 32) | hash_djb2_buffer(row, row_size);
+    }
 
-    RD *rd = rendering_resources.device();
+    TextureData *reused = reuse_released_texture(p_data, size, single_channel, row_hashes);
+    if (reused != nullptr) {
+        return reinterpret_cast<uintptr_t>(reused);
+    }
+
+    TextureDesc desc;
+    desc.width = size.x;
+    desc.height = size.y;
+    desc.format = single_channel ? RD::DATA_FORMAT_R8_UNORM : RD::DATA_FORMAT_R8G8B8A8_UNORM;
+    desc.usage_bits = RD::TEXTURE_USAGE_SAMPLING_BIT | RD::TEXTURE_USAGE_CAN_UPDATE_BIT | RD::TEXTURE_USAGE_CAN_COPY_TO_BIT;
+    desc.data = p_data;
+    if (single_channel) {
+        // Sampled as premultiplied white, the same as the RGBA data would be
+        desc.swizzle_g = RD::TEXTURE_SWIZZLE_R;
+        desc.swizzle_b = RD::TEXTURE_SWIZZLE_R;
+        desc.swizzle_a = RD::TEXTURE_SWIZZLE_R;
+    }
 
     TextureData *tex_data = memnew(TextureData());
-    tex_data->rid = rendering_resources.create_texture({
-        {"width", source_dimensions.x},
-        {"height", source_dimensions.y},
-        {"format", RD::DATA_FORMAT_R8G8B8A8_UNORM},
-        {"usage_bits", RD::TEXTURE_USAGE_SAMPLING_BIT},
-        {"data", TypedArray<PackedByteArray>({ p_data })}
-    });
+    tex_data->rid = rendering_resources.create_texture(desc);
+    tex_data->size = size;
+    tex_data->single_channel = single_channel;
+    tex_data->row_hashes = std::move(row_hashes);
 
     return reinterpret_cast<uintptr_t>(tex_data);
 }
@@ -732,11 +1735,244 @@ Rml::TextureHandle RDRenderInterfaceGodot::GenerateTexture(Rml::Span<const Rml::
 void RDRenderInterfaceGodot::ReleaseTexture(Rml::TextureHandle texture) {
 	TextureData *tex_data = reinterpret_cast<TextureData *>(texture);
 
+    queue_release([this, tex_data]() {
+        // Kept around in case it's generated again
+        if (!tex_data->row_hashes.empty()) {
+            tex_data->released_frame = Engine::get_singleton()->get_process_frames();
+            released_textures.push_back(tex_data);
+            return;
+        }
+        if (tex_data->canvas_texture.is_valid()) {
+            queue_canvas_release([this, tex_data]() {
+                free_texture_data(tex_data);
+            });
+            return;
+        }
+        free_texture_data(tex_data);
+    });
+}
+
+void RDRenderInterfaceGodot::free_texture_data(TextureData *p_texture) {
+    if (p_texture->canvas_texture.is_valid()) {
+        RenderingServer::get_singleton()->free_rid(p_texture->canvas_texture);
+    }
     // Is a generated texture
-    if (!tex_data->tex_ref.is_valid()) {
-        rendering_resources.free_texture(tex_data->rid);
+    if (!p_texture->tex_ref.is_valid()) {
+        rendering_resources.free_texture(p_texture->rid);
+    }
+    memdelete(p_texture);
+}
+
+RDRenderInterfaceGodot::TextureData *RDRenderInterfaceGodot::reuse_released_texture(const PackedByteArray &p_pixels, const Vector2i &p_size, bool p_single_channel, const std::vector<uint64_t> &p_row_hashes) {
+    TextureData *tex_data = nullptr;
+    for (auto it = released_textures.rbegin(); it != released_textures.rend(); it++) {
+        if ((*it)->size == p_size && (*it)->single_channel == p_single_channel) {
+            tex_data = *it;
+            released_textures.erase(std::next(it).base());
+            break;
+        }
+    }
+    if (tex_data == nullptr) {
+        return nullptr;
+    }
+
+    int32_t first_row = 0;
+    while (first_row < p_size.y && tex_data->row_hashes[first_row] == p_row_hashes[first_row]) {
+        first_row++;
+    }
+    if (first_row == p_size.y) {
+        // Same content, nothing to upload
+        return tex_data;
+    }
+
+    int32_t last_row = p_size.y - 1;
+    while (last_row > first_row && tex_data->row_hashes[last_row] == p_row_hashes[last_row]) {
+        last_row--;
+    }
+    // Only once both ends of the changed rows were found against the uploaded content
+    tex_data->row_hashes = p_row_hashes;
+
+    RD *rd = rendering_resources.device();
+
+    uint32_t row_size = p_size.x * (p_single_channel ? 1 : 4);
+    int32_t row_count = last_row - first_row + 1;
+
+    if (row_count == p_size.y) {
+        rd->texture_update(tex_data->rid, 0, p_pixels);
+    } else {
+        PackedByteArray data;
+        data.resize(row_count * row_size);
+        memcpy(data.ptrw(), p_pixels.ptr() + first_row * row_size, row_count * row_size);
+
+        // Only the rows that changed are uploaded, then copied into place on the GPU
+        TextureDesc staging_desc;
+        staging_desc.width = p_size.x;
+        staging_desc.height = row_count;
+        staging_desc.format = p_single_channel ? RD::DATA_FORMAT_R8_UNORM : RD::DATA_FORMAT_R8G8B8A8_UNORM;
+        staging_desc.usage_bits = RD::TEXTURE_USAGE_CAN_COPY_FROM_BIT;
+        staging_desc.data = data;
+        RID staging = rendering_resources.create_texture(staging_desc);
+        rd->texture_copy(
+            staging, tex_data->rid,
+            Vector3(0, 0, 0), Vector3(0, first_row, 0), Vector3(p_size.x, row_count, 1),
+            0, 0, 0, 0
+        );
+        rendering_resources.free_texture(staging);
+    }
+
+    // Frames that drew the previous content must not be considered unchanged
+    tex_data->version = ++texture_version;
+
+    return tex_data;
+}
+
+void RDRenderInterfaceGodot::evict_released_textures(bool p_all) {
+    uint64_t frame = Engine::get_singleton()->get_process_frames();
+
+    size_t evicted = 0;
+    while (evicted < released_textures.size() && (p_all || frame - released_textures[evicted]->released_frame > RELEASED_TEXTURE_MAX_IDLE_FRAMES)) {
+        free_texture_data(released_textures[evicted]);
+        evicted++;
+    }
+    released_textures.erase(released_textures.begin(), released_textures.begin() + evicted);
+}
+
+RID RDRenderInterfaceGodot::create_canvas_mesh(Rml::Span<const Rml::Vertex> p_vertices, Rml::Span<const int> p_indices) {
+    RenderingServer *rs = RenderingServer::get_singleton();
+
+    PackedVector2Array points;
+    PackedColorArray colors;
+    PackedVector2Array uvs;
+    PackedInt32Array indices;
+    points.resize(p_vertices.size());
+    colors.resize(p_vertices.size());
+    uvs.resize(p_vertices.size());
+    indices.resize(p_indices.size());
+
+    Vector2 *points_ptr = points.ptrw();
+    Color *colors_ptr = colors.ptrw();
+    Vector2 *uvs_ptr = uvs.ptrw();
+    for (size_t i = 0; i < p_vertices.size(); i++) {
+        const Rml::Vertex &vertex = p_vertices[i];
+        points_ptr[i] = Vector2(vertex.position.x, vertex.position.y);
+        colors_ptr[i] = Color(vertex.colour.red / 255.0, vertex.colour.green / 255.0, vertex.colour.blue / 255.0, vertex.colour.alpha / 255.0);
+        uvs_ptr[i] = Vector2(vertex.tex_coord.x, vertex.tex_coord.y);
+    }
+    memcpy(indices.ptrw(), p_indices.data(), p_indices.size() * sizeof(int));
+
+    Array arrays;
+    arrays.resize(RenderingServer::ARRAY_MAX);
+    arrays[RenderingServer::ARRAY_VERTEX] = points;
+    arrays[RenderingServer::ARRAY_COLOR] = colors;
+    arrays[RenderingServer::ARRAY_TEX_UV] = uvs;
+    arrays[RenderingServer::ARRAY_INDEX] = indices;
+
+    RID mesh = rs->mesh_create();
+    rs->mesh_add_surface_from_arrays(mesh, RenderingServer::PRIMITIVE_TRIANGLES, arrays);
+    return mesh;
+}
+
+RID RDRenderInterfaceGodot::get_canvas_texture(TextureData *p_texture) {
+    if (p_texture->tex_ref.is_valid()) {
+        return p_texture->tex_ref->get_rid();
+    }
+    if (!p_texture->canvas_texture.is_valid()) {
+        p_texture->canvas_texture = RenderingServer::get_singleton()->texture_rd_create(p_texture->rid);
+    }
+    return p_texture->canvas_texture;
+}
+
+void RDRenderInterfaceGodot::queue_canvas_release(const std::function<void()> &p_release) {
+    canvas_releases.push_back({ p_release, Engine::get_singleton()->get_process_frames() });
+}
+
+void RDRenderInterfaceGodot::run_canvas_releases(bool p_all) {
+    uint64_t frame = Engine::get_singleton()->get_process_frames();
+
+    size_t released = 0;
+    while (released < canvas_releases.size() && (p_all || frame - canvas_releases[released].second > CANVAS_RELEASE_DELAY_FRAMES)) {
+        canvas_releases[released].first();
+        released++;
+    }
+    canvas_releases.erase(canvas_releases.begin(), canvas_releases.begin() + released);
+}
+
+void RDRenderInterfaceGodot::record_canvas_draw(MeshData *p_mesh_data, const Rml::Vector2f &p_translation, Rml::TextureHandle p_texture) {
+    // Anything drawn into layers or through the clip mask needs the offscreen targets
+    if (context->target_stack_ptr != 0 || clip_mask_enabled || !p_mesh_data->canvas_mesh.is_valid()) {
+        context->direct_eligible = false;
+        context->canvas_draws.clear();
+        return;
+    }
+
+    // The geometry shader ignores z and w as well, so the 2D part of the transform is exact
+    Rml::Matrix4f transform = get_final_transform(drawing_matrix, p_translation);
+
+    CanvasDraw draw;
+    draw.mesh = p_mesh_data->canvas_mesh;
+    draw.texture = p_texture != 0 ? get_canvas_texture(reinterpret_cast<TextureData *>(p_texture)) : RID();
+    draw.transform = Transform2D(
+        Vector2(transform[0].x, transform[0].y),
+        Vector2(transform[1].x, transform[1].y),
+        Vector2(transform[3].x, transform[3].y)
+    );
+    draw.scissor_enabled = scissor_enabled;
+    draw.scissor_region = scissor_region;
+
+    context->canvas_draws.push_back(draw);
+}
+
+void RDRenderInterfaceGodot::draw_canvas_draws(Context *p_ctx, const RID &p_canvas_item) {
+    RenderingServer *rs = RenderingServer::get_singleton();
+
+    // Canvas items can only clip to their rect, so every run of draws sharing
+    // a scissor region is drawn into a child item clipping to it
+    uint32_t item_count = 0;
+    RID item;
+    const CanvasDraw *previous = nullptr;
+    for (const CanvasDraw &draw : p_ctx->canvas_draws) {
+        bool same_scissor = previous != nullptr && 
+            previous->scissor_enabled == draw.scissor_enabled && 
+            (!draw.scissor_enabled || previous->scissor_region == draw.scissor_region);
+        if (!same_scissor) {
+            item = prepare_canvas_item(p_ctx, item_count, p_canvas_item);
+            rs->canvas_item_set_custom_rect(item, draw.scissor_enabled, draw.scissor_region);
+            rs->canvas_item_set_clip(item, draw.scissor_enabled);
+            item_count++;
+        }
+
+        rs->canvas_item_add_mesh(item, draw.mesh, draw.transform, Color(1, 1, 1, 1), draw.texture);
+        previous = &draw;
+    }
+
+    clear_canvas_items(p_ctx, item_count);
+}
+
+RID RDRenderInterfaceGodot::prepare_canvas_item(Context *p_ctx, uint32_t p_index, const RID &p_parent) {
+    RenderingServer *rs = RenderingServer::get_singleton();
+
+    if (p_index == p_ctx->canvas_items.size()) {
+        RID new_item = rs->canvas_item_create();
+        rs->canvas_item_set_material(new_item, premultiplied_material->get_rid());
+        rs->canvas_item_set_default_texture_filter(new_item, RenderingServer::CANVAS_ITEM_TEXTURE_FILTER_LINEAR);
+        p_ctx->canvas_items.push_back(new_item);
+    }
+
+    RID item = p_ctx->canvas_items[p_index];
+    rs->canvas_item_clear(item);
+    rs->canvas_item_set_parent(item, p_parent);
+    rs->canvas_item_set_draw_index(item, p_index);
+    rs->canvas_item_set_custom_rect(item, false);
+    rs->canvas_item_set_clip(item, false);
+    return item;
+}
+
+void RDRenderInterfaceGodot::clear_canvas_items(Context *p_ctx, uint32_t p_from) {
+    RenderingServer *rs = RenderingServer::get_singleton();
+
+    for (uint32_t i = p_from; i < p_ctx->canvas_items.size(); i++) {
+        rs->canvas_item_clear(p_ctx->canvas_items[i]);
     }
-    memdelete(tex_data);
 }
 
 void RDRenderInterfaceGodot::EnableScissorRegion(bool enable) {
@@ -785,8 +2021,8 @@ void RDRenderInterfaceGodot::RenderToClipMask(Rml::ClipMaskOperation operation,
 
 	pass.push_const.resize(80);
     float *push_const = (float *)pass.push_const.ptrw();
-    push_const[0] = 1.0 / context->size.x;
-    push_const[1] = 1.0 / context->size.y;
+    push_const[0] = 1.0 / context->target_size.x;
+    push_const[1] = 1.0 / context->target_size.y;
     matrix_to_pointer(push_const + 4, get_final_transform(drawing_matrix, translation));
 	
     uint64_t clear_flags = RD::DRAW_CLEAR_STENCIL;
@@ -798,11 +2034,13 @@ void RDRenderInterfaceGodot::RenderToClipMask(Rml::ClipMaskOperation operation,
         clear_flags = RD::DRAW_DEFAULT_ALL;
     }
 
-	pass.framebuffer = context->clip_mask_framebuffer;
+	pass.framebuffer = context->shared->clip_mask_framebuffer;
     pass.draw_flags = clear_flags;
     pass.clear_stencil = clear_stencil_value;
 
 	render_pass(pass);
+    // Clearing the clip mask affects the whole context
+    track_draw(translation, clear_flags != RD::DRAW_DEFAULT_ALL);
 }
 
 void RDRenderInterfaceGodot::SetTransform(const Rml::Matrix4f* transform) {
@@ -824,19 +2062,21 @@ void RDRenderInterfaceGodot::SetTransform(const Rml::Matrix4f* transform) {
 
 Rml::LayerHandle RDRenderInterfaceGodot::PushLayer() {
     PUSH_DEBUG_COMMAND("PushLayer");
+    stats.layers_pushed++;
     context->target_stack_ptr++;
-    RenderTarget *target;
+    RenderTarget *target = borrow_layer_target();
     if (context->target_stack_ptr == context->target_stack.size()) {
-        target = memnew(RenderTarget);
         context->target_stack.push_back(target);
     } else {
-        target = context->target_stack[context->target_stack_ptr];
+        context->target_stack[context->target_stack_ptr] = target;
     }
 
-    allocate_render_target(target, context->size);
+    // Filters sample outside of the damaged region, so frames using layers are fully redrawn
+    context->damage_tracking = false;
+    context->direct_eligible = false;
 
-    RD *rd = rendering_resources.device();
-    rd->texture_clear(target->color, Color(0, 0, 0, 0), 0, 1, 0, 1);
+    render_pass(clear_pass(target->framebuffer));
+    target->content_bounds = Rect2i();
 
     return context->target_stack_ptr;
 }
@@ -847,41 +2087,91 @@ void RDRenderInterfaceGodot::CompositeLayers(Rml::LayerHandle source, Rml::Layer
     RenderTarget *source_target = context->target_stack[source];
     RenderTarget *destination_target = context->target_stack[destination];
 
-    render_pass(blit_pass(source_target->color, context->back_buffer0.framebuffer));
+    // Composition can only change pixels inside the scissor region. Blending also leaves the pixels
+    // the source layer has no content at untouched, unless a filter spreads it, e.g. blurs
+    Rect2i region = Rect2i(Vector2i(), context->size);
+    if (scissor_enabled) {
+        region = region.intersection(Rect2i(scissor_region));
+    }
+    bool bounded = blend_mode == Rml::BlendMode::Blend && source > 0;
+    for (auto it : filters) {
+        bounded = bounded && reinterpret_cast<RenderPasses *>(it)->preserves_transparency;
+    }
+    if (bounded) {
+        region = region.intersection(source_target->content_bounds);
+    }
+    if (!region.has_area()) return;
+
+    auto render_region_pass = [&](RenderPass p_pass) {
+        p_pass.region = region;
+        render_pass(p_pass);
+    };
+
+    render_region_pass(blit_pass(source_target->color, TARGET_SLOT_BACK_BUFFER0));
+
+    // Runs of color matrix filters are multiplied into a single pass
+    Rml::Matrix4f fused_matrix = Rml::Matrix4f::Identity();
+    uint32_t fused_count = 0;
+    auto render_fused = [&]() {
+        if (fused_count > 0) {
+            render_region_pass(color_matrix_pass(fused_matrix, "GodotRmlUi_ColorMatrix"));
+            render_region_pass(blit_pass(TARGET_SLOT_BACK_BUFFER1, TARGET_SLOT_BACK_BUFFER0));
+        }
+        fused_matrix = Rml::Matrix4f::Identity();
+        fused_count = 0;
+    };
+
     for (auto it : filters) {
         RenderPasses *passes = reinterpret_cast<RenderPasses *>(it);
-        for (auto pass : passes->passes) {
-            render_pass(pass);
+        if (passes->color_matrix) {
+            // Applied after the filters before it
+            fused_matrix = passes->matrix * fused_matrix;
+            fused_count++;
+            continue;
+        }
+
+        render_fused();
+        for (const RenderPass &pass : passes->passes) {
+            render_region_pass(pass);
         }
     }
-    render_pass(blit_pass(context->back_buffer0.color, context->back_buffer1.framebuffer));
+    render_fused();
+    render_region_pass(blit_pass(TARGET_SLOT_BACK_BUFFER0, TARGET_SLOT_BACK_BUFFER1));
 
     RenderPass pass;
     pass.debug_name = "GodotRmlUi_CompositeLayers";
-	pass.shader = shader_layer_composition;
+	pass.shader = get_shader(SHADER_LAYER_COMPOSITION);
     pass.pipeline = get_shader_pipeline(PIPELINE_LAYER_COMPOSITION);
 
 	pass.push_const.resize(16);
     unsigned int *push_const = (unsigned int *)pass.push_const.ptrw();
     push_const[0] = (unsigned int)blend_mode;
 	
-    pass.uniform_textures.push_back(std::make_pair(destination_target->color, false));
-    pass.uniform_textures.push_back(std::make_pair(context->back_buffer1.color, false));
+    pass.uniform_textures.push_back(TextureBinding(destination_target->color, false));
+    pass.uniform_textures.push_back(TextureBinding(TARGET_SLOT_BACK_BUFFER1));
 
-	pass.framebuffer = context->back_buffer0.framebuffer;
+	pass.framebuffer_slot = TARGET_SLOT_BACK_BUFFER0;
 
-	render_pass(pass);
-    render_pass(blit_pass(context->back_buffer0.color, destination_target->framebuffer));
+	render_region_pass(pass);
+    render_region_pass(blit_pass(TARGET_SLOT_BACK_BUFFER0, destination_target->framebuffer));
+
+    if (destination > 0) {
+        extend_layer_content(destination_target, region);
+    }
 }
 
 void RDRenderInterfaceGodot::PopLayer() {
     PUSH_DEBUG_COMMAND("PopLayer");
+    return_layer_target(context->target_stack[context->target_stack_ptr]);
+    context->target_stack[context->target_stack_ptr] = nullptr;
     context->target_stack_ptr--;
 }
 
 Rml::TextureHandle RDRenderInterfaceGodot::SaveLayerAsTexture() {
     PUSH_DEBUG_COMMAND("SaveLayerAsTexture");
     RenderTarget *target = get_render_target();
+    context->damage_tracking = false;
+    context->direct_eligible = false;
 
     Rect2i region = Rect2i(0, 0, context->size.x, context->size.y);
     if (scissor_enabled) {
@@ -890,19 +2180,20 @@ Rml::TextureHandle RDRenderInterfaceGodot::SaveLayerAsTexture() {
     }
 
     TextureData *tex_data = memnew(TextureData());
-    tex_data->rid = rendering_resources.create_texture({
-        {"width", region.size.x},
-        {"height", region.size.y},
-        {"format", RD::DATA_FORMAT_R8G8B8A8_UNORM},
-        {"usage_bits", RD::TEXTURE_USAGE_COLOR_ATTACHMENT_BIT | RD::TEXTURE_USAGE_SAMPLING_BIT | RD::TEXTURE_USAGE_CAN_COPY_FROM_BIT | RD::TEXTURE_USAGE_CAN_COPY_TO_BIT}
-    });
+    TextureDesc desc;
+    desc.width = region.size.x;
+    desc.height = region.size.y;
+    desc.usage_bits = RD::TEXTURE_USAGE_COLOR_ATTACHMENT_BIT | RD::TEXTURE_USAGE_SAMPLING_BIT | RD::TEXTURE_USAGE_CAN_COPY_FROM_BIT | RD::TEXTURE_USAGE_CAN_COPY_TO_BIT;
+    tex_data->rid = rendering_resources.create_texture(desc);
     tex_data->linear_filtering = false;
 
     RD *rd = rendering_resources.device();
     RID fb = rd->framebuffer_create({ tex_data->rid });
 
     render_pass(blit_pass(target->color, fb, Vector2i(), region.position, region.size));
-    rd->free_rid(fb);
+    queue_release([rd, fb]() {
+        rd->free_rid(fb);
+    });
 
     return reinterpret_cast<uintptr_t>(tex_data);
 }
@@ -910,324 +2201,224 @@ Rml::TextureHandle RDRenderInterfaceGodot::SaveLayerAsTexture() {
 Rml::CompiledFilterHandle RDRenderInterfaceGodot::SaveLayerAsMaskImage() {
     PUSH_DEBUG_COMMAND("SaveLayerAsMaskImage");
     RenderTarget *target = get_render_target();
+    context->damage_tracking = false;
+    context->direct_eligible = false;
 
     RenderPasses *passes = memnew(RenderPasses);
+    passes->preserves_transparency = true;
 
     bool valid = check_if_can_render_with_scissor();
     if (valid) {
-        render_pass(blit_pass(target->color, context->blend_target.framebuffer));
+        render_pass(blit_pass(target->color, TARGET_SLOT_BLEND));
     }
 
     RenderPass pass;
     pass.debug_name = "GodotRmlUi_SaveLayerAsMaskImage";
-	pass.shader = shaders[SHADER_FILTER_MASK];
-    pass.pipeline = pipelines[PIPELINE_FILTER_MASK];
+	pass.shader = get_shader(SHADER_FILTER_MASK);
+    pass.pipeline = get_pipeline(PIPELINE_FILTER_MASK);
 	
-    pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
+    pass.uniform_textures.push_back(TextureBinding(TARGET_SLOT_BACK_BUFFER0));
     if (valid) {
-        pass.uniform_textures.push_back(std::make_pair(context->blend_target.color, false));
+        pass.uniform_textures.push_back(TextureBinding(TARGET_SLOT_BLEND));
     } else {
-        pass.uniform_textures.push_back(std::make_pair(texture_transparent, false));
+        pass.uniform_textures.push_back(TextureBinding(texture_transparent, false));
     }
 
-	pass.framebuffer = context->back_buffer1.framebuffer;
+	pass.framebuffer_slot = TARGET_SLOT_BACK_BUFFER1;
     passes->passes.push_back(pass);
 
-    passes->passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
+    passes->passes.push_back(blit_pass(TARGET_SLOT_BACK_BUFFER1, TARGET_SLOT_BACK_BUFFER0));
 
     return reinterpret_cast<uintptr_t>(passes);
 }
 
-Rml::CompiledFilterHandle RDRenderInterfaceGodot::CompileFilter(const Rml::String& name, const Rml::Dictionary& parameters) {
-    RenderPasses params;
-
-    // For the created passes array, 
-    // the first pass must read from back_buffer0 and the last write to back_buffer0
-
-    if (name == "opacity") {
-        const float value = Rml::Get(parameters, "value", 1.f);
+const RDRenderInterfaceGodot::BlurKernel &RDRenderInterfaceGodot::get_blur_kernel(float p_sigma) {
+    uint32_t key = (uint32_t)Math::round(CLAMP(p_sigma, 0.0f, MAX_BLUR_KERNEL_SIGMA) * 8.0f);
+    auto it = blur_kernels.find(key);
+    if (it != blur_kernels.end()) {
+        return it->second;
+    }
 
-        RenderPass pass;
-        pass.debug_name = "GodotRmlUi_Opacity";
-        pass.shader = shaders[SHADER_FILTER_MODULATE];
-        pass.pipeline = pipelines[PIPELINE_FILTER_MODULATE];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
+    const float sigma = key / 8.0f;
+    const int radius = (int)Math::ceil(sigma * 3.0f);
 
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(32);
+    std::vector<float> weights(radius + 1);
+    float total = 0.0f;
+    for (int i = 0; i <= radius; i++) {
+        weights[i] = sigma > 0.0f ? Math::exp(-(float)(i * i) / (2.0f * sigma * sigma)) : 1.0f;
+        total += i == 0 ? weights[i] : 2.0f * weights[i];
+    }
+    for (float &w : weights) {
+        w /= total;
+    }
 
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        push_const_ptr[0] = 1.0f;
-        push_const_ptr[1] = 1.0f;
-        push_const_ptr[2] = 1.0f;
-        push_const_ptr[3] = value;
-        push_const_ptr[4] = 0;
+    // Center tap, then pairs of texels merged into a single linear fetch between them
+    PackedFloat32Array taps;
+    taps.push_back(0.0f);
+    taps.push_back(weights[0]);
+    for (int i = 1; i <= radius; i += 2) {
+        float w0 = weights[i];
+        float w1 = i + 1 <= radius ? weights[i + 1] : 0.0f;
+        taps.push_back((i * w0 + (i + 1) * w1) / (w0 + w1));
+        taps.push_back(w0 + w1);
+    }
 
-        params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
-    } else if (name == "blur") {
-        const float sigma = Rml::Get(parameters, "sigma", 0.f);
+    BlurKernel kernel;
+    kernel.tap_count = taps.size() / 2;
+    kernel.buffer = internal_rendering_resources.create_storage_buffer({ taps.to_byte_array() });
 
-        RenderPass pass;
-        pass.debug_name = "GodotRmlUi_BlurH";
-        pass.shader = shaders[SHADER_FILTER_BLUR];
-        pass.pipeline = pipelines[PIPELINE_FILTER_BLUR];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-        
-        // Horizontal pass
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(32);
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        push_const_ptr[0] = 1.0f;
-        push_const_ptr[1] = 0.0f;
-        push_const_ptr[2] = 0.0f;
-        push_const_ptr[3] = 0.0f;
-        push_const_ptr[4] = sigma;
+    return blur_kernels[key] = kernel;
+}
 
-        params.passes.push_back(pass);
+void RDRenderInterfaceGodot::add_blur_passes(RenderPasses &r_passes, float p_sigma, const Vector2 &p_offset, TargetSlot p_output) {
+    // Large blurs run on a downsampled copy, with the sigma scaled down along with it
+    int32_t scale = 1;
+    while (scale < MAX_BLUR_SCALE && p_sigma / scale > MAX_BLUR_SIGMA) {
+        scale *= 2;
+    }
 
-        // Vertial pass
-        pass.debug_name = "GodotRmlUi_BlurV";
-        pass.uniform_textures.clear();
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer1.color, false));
-        pass.framebuffer = context->back_buffer0.framebuffer;
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(32);
-        push_const_ptr = (float *)pass.push_const.ptrw();
-        push_const_ptr[0] = 0.0f;
-        push_const_ptr[1] = 1.0f;
-        push_const_ptr[2] = 0.0f;
-        push_const_ptr[3] = 0.0f;
-        push_const_ptr[4] = sigma;
+    PushConstant push_const;
+    push_const.resize(48);
+    float *push_const_ptr = (float *)push_const.ptrw();
+    int32_t *push_const_int_ptr = (int32_t *)push_const.ptrw();
+    // [0..3] receives the filter region when executed
+    push_const_ptr[6] = p_offset.x;
+    push_const_ptr[7] = p_offset.y;
+    push_const_int_ptr[8] = scale;
+
+    TextureBinding source = TextureBinding(TARGET_SLOT_BACK_BUFFER0);
+    source.linear_filtering = true;
+
+    if (p_sigma > 0.0f) {
+        if (scale > 1) {
+            RenderPass pass;
+            pass.debug_name = "GodotRmlUi_BlurDownsample";
+            pass.shader = get_shader(SHADER_FILTER_BLUR_DOWNSAMPLE);
+            pass.pipeline = get_pipeline(PIPELINE_FILTER_BLUR_DOWNSAMPLE);
+            pass.compute = true;
+            pass.region_scale = scale;
+            pass.push_const = push_const;
+            pass.uniform_textures.push_back(source);
+            pass.framebuffer_slot = TARGET_SLOT_BLUR0;
+            r_passes.passes.push_back(pass);
+
+            source = TextureBinding(TARGET_SLOT_BLUR0);
+            source.linear_filtering = true;
+        }
 
-        params.passes.push_back(pass);
-    } else if (name == "drop-shadow") {
-        const float sigma = Rml::Get(parameters, "sigma", 0.f);
-        const Rml::Colourb color = Rml::Get(parameters, "color", Rml::Colourb());
-        const Rml::Vector2f offset = Rml::Get(parameters, "offset", Rml::Vector2f());
+        const BlurKernel &kernel = get_blur_kernel(p_sigma / scale);
 
-        // Blur horizontal pass
         RenderPass pass;
-        pass.debug_name = "GodotRmlUi_DropShadowBlurH";
-        pass.shader = shaders[SHADER_FILTER_BLUR];
-        pass.pipeline = pipelines[PIPELINE_FILTER_BLUR];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(32);
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        push_const_ptr[0] = 1.0f;
-        push_const_ptr[1] = 0.0f;
-        push_const_ptr[2] = offset.x;
-        push_const_ptr[3] = offset.y;
-        push_const_ptr[4] = sigma;
-
-        params.passes.push_back(pass);
-
-        // Blur vertial pass
-        pass.debug_name = "GodotRmlUi_DropShadowBlurV";
-        pass.uniform_textures.clear();
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer1.color, false));
-        pass.framebuffer = context->back_buffer2.framebuffer;
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(32);
+        pass.debug_name = "GodotRmlUi_BlurH";
+        pass.shader = get_shader(SHADER_FILTER_BLUR);
+        pass.pipeline = get_pipeline(PIPELINE_FILTER_BLUR);
+        pass.compute = true;
+        pass.region_scale = scale;
+        pass.uniform_buffer = kernel.buffer;
+        pass.shared_uniform_buffer = true;
+        pass.push_const = push_const;
         push_const_ptr = (float *)pass.push_const.ptrw();
-        push_const_ptr[0] = 0.0f;
-        push_const_ptr[1] = 1.0f;
-        push_const_ptr[2] = 0;
-        push_const_ptr[3] = 0;
-        push_const_ptr[4] = sigma;
-
-        params.passes.push_back(pass);
-
-        // Drop shadow pass
-        pass.debug_name = "GodotRmlUi_DropShadow";
-        pass.shader = shaders[SHADER_FILTER_DROP_SHADOW];
-        pass.pipeline = pipelines[PIPELINE_FILTER_DROP_SHADOW];
-        pass.uniform_textures.clear();
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer2.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
+        push_const_ptr[4] = 1.0f;
+        push_const_ptr[5] = 0.0f;
+        ((uint32_t *)push_const_ptr)[9] = kernel.tap_count;
+        pass.uniform_textures.push_back(source);
+        pass.framebuffer_slot = TARGET_SLOT_BLUR1;
+        r_passes.passes.push_back(pass);
 
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(16);
+        pass.debug_name = "GodotRmlUi_BlurV";
         push_const_ptr = (float *)pass.push_const.ptrw();
-        push_const_ptr[0] = color.red / 255.0;
-        push_const_ptr[1] = color.green / 255.0;
-        push_const_ptr[2] = color.blue / 255.0;
-        push_const_ptr[3] = color.alpha / 255.0;
+        push_const_ptr[4] = 0.0f;
+        push_const_ptr[5] = 1.0f;
+        pass.uniform_textures.clear();
+        pass.uniform_textures.push_back(TextureBinding(TARGET_SLOT_BLUR1));
+        pass.uniform_textures[0].linear_filtering = true;
+        pass.framebuffer_slot = TARGET_SLOT_BLUR0;
+        r_passes.passes.push_back(pass);
 
-        params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
-    } else if (name == "brightness") {
-        const float value = Rml::Get(parameters, "value", 1.f);
+        source = TextureBinding(TARGET_SLOT_BLUR0);
+        source.linear_filtering = true;
+    }
 
-        RenderPass pass;
-        pass.debug_name = "GodotRmlUi_Brightness";
-        pass.shader = shaders[SHADER_FILTER_MODULATE];
-        pass.pipeline = pipelines[PIPELINE_FILTER_MODULATE];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(32);
-        
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        push_const_ptr[0] = value;
-        push_const_ptr[1] = value;
-        push_const_ptr[2] = value;
-        push_const_ptr[3] = 1.0f;
-        push_const_ptr[4] = 0;
+    // Back to full resolution, also applies the offset of drop shadows
+    RenderPass pass;
+    pass.debug_name = "GodotRmlUi_BlurUpsample";
+    pass.shader = get_shader(SHADER_FILTER_BLUR_UPSAMPLE);
+    pass.pipeline = get_pipeline(PIPELINE_FILTER_BLUR_UPSAMPLE);
+    pass.region_scale = scale;
+    pass.push_const = push_const;
+    pass.uniform_textures.push_back(source);
+    pass.framebuffer_slot = p_output;
+    r_passes.passes.push_back(pass);
+}
 
-        params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
-    } else if (name == "contrast") {
-        const float value = Rml::Get(parameters, "value", 1.f);
-        const float gray = 0.5f - 0.5f * value;
+RDRenderInterfaceGodot::RenderPass RDRenderInterfaceGodot::color_matrix_pass(const Rml::Matrix4f &p_matrix, const char *p_debug_name) {
+    RenderPass pass;
+    pass.debug_name = p_debug_name;
+    pass.shader = get_shader(SHADER_FILTER_COLOR_MATRIX);
+    pass.pipeline = get_pipeline(PIPELINE_FILTER_COLOR_MATRIX);
+    pass.uniform_textures.push_back(TextureBinding(TARGET_SLOT_BACK_BUFFER0));
+    pass.framebuffer_slot = TARGET_SLOT_BACK_BUFFER1;
 
-        Rml::Matrix4f color_matrix = Rml::Matrix4f::Diag(value, value, value, 1.0f);
-        color_matrix.SetColumn(3, Rml::Vector4f(gray, gray, gray, 1.0f));
+    pass.push_const.resize(64);
+    matrix_to_pointer((float *)pass.push_const.ptrw(), p_matrix);
 
-        RenderPass pass;
-        pass.debug_name = "GodotRmlUi_Contrast";
-        pass.shader = shaders[SHADER_FILTER_COLOR_MATRIX];
-        pass.pipeline = pipelines[PIPELINE_FILTER_COLOR_MATRIX];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(64);
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        matrix_to_pointer(push_const_ptr, color_matrix);
+    return pass;
+}
 
-        params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
-    } else if (name == "invert") {
-        const float value = Rml::Get(parameters, "value", 0.f);
-        const float inverted = 1.f - 2.f * value;
+RDRenderInterfaceGodot::RenderPasses RDRenderInterfaceGodot::color_matrix_passes(const Rml::Matrix4f &p_matrix, const char *p_debug_name) {
+    RenderPasses passes;
+    passes.color_matrix = true;
+    passes.preserves_transparency = true;
+    passes.matrix = p_matrix;
 
-        Rml::Matrix4f color_matrix = Rml::Matrix4f::Diag(inverted, inverted, inverted, 1.f);
-        color_matrix.SetColumn(3, Rml::Vector4f(value, value, value, 1.f));
+    passes.passes.push_back(color_matrix_pass(p_matrix, p_debug_name));
+    passes.passes.push_back(blit_pass(TARGET_SLOT_BACK_BUFFER1, TARGET_SLOT_BACK_BUFFER0));
 
-        RenderPass pass;
-        pass.debug_name = "GodotRmlUi_Invert";
-        pass.shader = shaders[SHADER_FILTER_COLOR_MATRIX];
-        pass.pipeline = pipelines[PIPELINE_FILTER_COLOR_MATRIX];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(64);
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        matrix_to_pointer(push_const_ptr, color_matrix);
+    return passes;
+}
 
-        params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
-    } else if (name == "grayscale") {
-        const float value = Rml::Get(parameters, "value", 1.f);
-        const float rev_value = 1.f - value;
-		const Rml::Vector3f gray = value * Rml::Vector3f(0.2126f, 0.7152f, 0.0722f);
-
-        Rml::Matrix4f color_matrix = Rml::Matrix4f::FromRows(
-			{gray.x + rev_value, gray.y,             gray.z,             0.f},
-			{gray.x,             gray.y + rev_value, gray.z,             0.f},
-			{gray.x,             gray.y,             gray.z + rev_value, 0.f},
-			{0.f,                0.f,                0.f,                1.f}
-		);
+Rml::CompiledFilterHandle RDRenderInterfaceGodot::CompileFilter(const Rml::String& name, const Rml::Dictionary& parameters) {
+    RenderPasses params;
 
-        RenderPass pass;
-        pass.debug_name = "GodotRmlUi_Grayscale";
-        pass.shader = shaders[SHADER_FILTER_COLOR_MATRIX];
-        pass.pipeline = pipelines[PIPELINE_FILTER_COLOR_MATRIX];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(64);
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        matrix_to_pointer(push_const_ptr, color_matrix);
+    // For the created passes array, 
+    // the first pass must read from back_buffer0 and the last write to back_buffer0
 
-        params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
-    } else if (name == "sepia") {
-        const float value = Rml::Get(parameters, "value", 1.f);
-        const float rev_value = 1.f - value;
-		const Rml::Vector3f r_mix = value * Rml::Vector3f(0.393f, 0.769f, 0.189f);
-		const Rml::Vector3f g_mix = value * Rml::Vector3f(0.349f, 0.686f, 0.168f);
-		const Rml::Vector3f b_mix = value * Rml::Vector3f(0.272f, 0.534f, 0.131f);
-
-        Rml::Matrix4f color_matrix = Rml::Matrix4f::FromRows(
-			{r_mix.x + rev_value, r_mix.y,             r_mix.z,             0.f},
-			{g_mix.x,             g_mix.y + rev_value, g_mix.z,             0.f},
-			{b_mix.x,             b_mix.y,             b_mix.z + rev_value, 0.f},
-			{0.f,                 0.f,                 0.f,                 1.f}
-		);
+    Rml::Matrix4f color_matrix;
+    if (rml_filter_color_matrix(name, parameters, color_matrix)) {
+        params = color_matrix_passes(color_matrix, COLOR_MATRIX_DEBUG_NAMES.at(name));
+    } else if (name == "blur") {
+        const float sigma = Rml::Get(parameters, "sigma", 0.f);
 
-        RenderPass pass;
-        pass.debug_name = "GodotRmlUi_Sepia";
-        pass.shader = shaders[SHADER_FILTER_COLOR_MATRIX];
-        pass.pipeline = pipelines[PIPELINE_FILTER_COLOR_MATRIX];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(64);
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        matrix_to_pointer(push_const_ptr, color_matrix);
+        // No passes leave back_buffer0 untouched
+        if (sigma > 0.0f) {
+            add_blur_passes(params, sigma, Vector2(), TARGET_SLOT_BACK_BUFFER0);
+        }
+    } else if (name == "drop-shadow") {
+        const float sigma = Rml::Get(parameters, "sigma", 0.f);
+        const Rml::Colourb color = Rml::Get(parameters, "color", Rml::Colourb());
+        const Rml::Vector2f offset = Rml::Get(parameters, "offset", Rml::Vector2f());
 
-        params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
-    } else if (name == "hue-rotate") {
-        const float value = Rml::Get(parameters, "value", 0.f);
+        add_blur_passes(params, sigma, Vector2(offset.x, offset.y), TARGET_SLOT_BACK_BUFFER2);
 
+        // Drop shadow pass
         RenderPass pass;
-        pass.debug_name = "GodotRmlUi_HueRotate";
-        pass.shader = shaders[SHADER_FILTER_MODULATE];
-        pass.pipeline = pipelines[PIPELINE_FILTER_MODULATE];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(32);
-        float *push_const_ptr = (float *)pass.push_const.ptrw();
-        unsigned int *push_const_int_ptr = (unsigned int *)pass.push_const.ptrw();
-        push_const_ptr[0] = value / Math_TAU;
-        push_const_ptr[1] = 1.0f;
-        push_const_ptr[2] = 1.0f;
-        push_const_ptr[3] = 1.0f;
-        push_const_int_ptr[4] = 1; // HSV
-
-        params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
-    } else if (name == "saturate") {
-        const float value = Rml::Get(parameters, "value", 1.f);
-
-		Rml::Matrix4f color_matrix = Rml::Matrix4f::FromRows(
-			{0.213f + 0.787f * value,  0.715f - 0.715f * value,  0.072f - 0.072f * value,  0.f},
-			{0.213f - 0.213f * value,  0.715f + 0.285f * value,  0.072f - 0.072f * value,  0.f},
-			{0.213f - 0.213f * value,  0.715f - 0.715f * value,  0.072f + 0.928f * value,  0.f},
-			{0.f,                      0.f,                      0.f,                      1.f}
-		);
+        pass.debug_name = "GodotRmlUi_DropShadow";
+        pass.shader = get_shader(SHADER_FILTER_DROP_SHADOW);
+        pass.pipeline = get_pipeline(PIPELINE_FILTER_DROP_SHADOW);
+        pass.uniform_textures.push_back(TextureBinding(TARGET_SLOT_BACK_BUFFER0));
+        pass.uniform_textures.push_back(TextureBinding(TARGET_SLOT_BACK_BUFFER2));
+        pass.framebuffer_slot = TARGET_SLOT_BACK_BUFFER1;
 
-        RenderPass pass;
-        pass.debug_name = "GodotRmlUi_Saturate";
-        pass.shader = shaders[SHADER_FILTER_COLOR_MATRIX];
-        pass.pipeline = pipelines[PIPELINE_FILTER_COLOR_MATRIX];
-        pass.uniform_textures.push_back(std::make_pair(context->back_buffer0.color, false));
-        pass.framebuffer = context->back_buffer1.framebuffer;
-
-        pass.push_const = PackedByteArray();
-        pass.push_const.resize(64);
+        pass.push_const.resize(16);
         float *push_const_ptr = (float *)pass.push_const.ptrw();
-        matrix_to_pointer(push_const_ptr, color_matrix);
+        push_const_ptr[0] = color.red / 255.0;
+        push_const_ptr[1] = color.green / 255.0;
+        push_const_ptr[2] = color.blue / 255.0;
+        push_const_ptr[3] = color.alpha / 255.0;
 
         params.passes.push_back(pass);
-        params.passes.push_back(blit_pass(context->back_buffer1.color, context->back_buffer0.framebuffer));
+        params.passes.push_back(blit_pass(TARGET_SLOT_BACK_BUFFER1, TARGET_SLOT_BACK_BUFFER0));
     }
-
     RenderPasses *passes = memnew(RenderPasses(std::move(params)));
     return reinterpret_cast<uintptr_t>(passes);
 }
@@ -1235,20 +2426,22 @@ Rml::CompiledFilterHandle RDRenderInterfaceGodot::CompileFilter(const Rml::Strin
 void RDRenderInterfaceGodot::ReleaseFilter(Rml::CompiledFilterHandle filter) {
     RenderPasses *passes = reinterpret_cast<RenderPasses *>(filter);
 
-    for (auto pass : passes->passes) {
-        if (pass.uniform_buffer.is_valid()) {
-            rendering_resources.free_storage_buffer(pass.uniform_buffer);
+    queue_release([this, passes]() {
+        for (auto pass : passes->passes) {
+            if (pass.uniform_buffer.is_valid() && !pass.shared_uniform_buffer) {
+                rendering_resources.free_storage_buffer(pass.uniform_buffer);
+            }
         }
-    }
 
-    memdelete(passes);
+        memdelete(passes);
+    });
 }
 
 Rml::CompiledShaderHandle RDRenderInterfaceGodot::CompileShader(const Rml::String& name, const Rml::Dictionary& parameters) {
     ShaderInfo params;
 
     if (name == "linear-gradient" || name == "radial-gradient" || name == "conic-gradient") {
-        params.shader = shaders[SHADER_GRADIENT];
+        params.shader = get_shader(SHADER_GRADIENT);
         params.pipeline_id = PIPELINE_GRADIENT;
 
         const bool repeating = Rml::Get(parameters, "repeating", false);
@@ -1287,11 +2480,8 @@ Rml::CompiledShaderHandle RDRenderInterfaceGodot::CompileShader(const Rml::Strin
             buffer_ptr[i * 5 + 4] = position;
         }
 
-        params.uniform_buffer = rendering_resources.create_storage_buffer({
-            {"data", storage_buffer}
-        });
+        params.uniform_buffer = rendering_resources.create_storage_buffer({ storage_buffer });
 
-        params.push_const = PackedByteArray();
         params.push_const.resize(112);
         float *push_const_ptr = (float *)params.push_const.ptrw();
         unsigned int *push_const_uint_ptr = (unsigned int *)params.push_const.ptrw();
@@ -1311,6 +2501,8 @@ void RDRenderInterfaceGodot::RenderShader(Rml::CompiledShaderHandle shader, Rml:
     if (!check_if_can_render_with_scissor()) return;
     PUSH_DEBUG_COMMAND("RenderShader");
     ShaderInfo *info = reinterpret_cast<ShaderInfo *>(shader);
+    // Shaders have no canvas equivalent
+    context->direct_eligible = false;
 
     RenderPass pass;
     pass.debug_name = "GodotRmlUi_RenderShader";
@@ -1321,29 +2513,31 @@ void RDRenderInterfaceGodot::RenderShader(Rml::CompiledShaderHandle shader, Rml:
 
 	pass.push_const = info->push_const;
     float *push_const = (float *)pass.push_const.ptrw();
-    push_const[0] = 1.0 / context->size.x;
-    push_const[1] = 1.0 / context->size.y;
+    push_const[0] = 1.0 / context->target_size.x;
+    push_const[1] = 1.0 / context->target_size.y;
     matrix_to_pointer(push_const + 4, get_final_transform(drawing_matrix, translation));
 
     pass.uniform_buffer = info->uniform_buffer;
 	
 	if (texture != 0) {
-		TextureData *tex = reinterpret_cast<TextureData *>(texture);
-		pass.uniform_textures.push_back(std::make_pair(tex->rid, tex->linear_filtering));
+		pass.uniform_textures.push_back(get_texture_binding(reinterpret_cast<TextureData *>(texture)));
 	} else {
-		pass.uniform_textures.push_back(std::make_pair(texture_white, false));
+		pass.uniform_textures.push_back(TextureBinding(texture_white, false));
 	}
 	pass.framebuffer = get_render_target()->framebuffer;
 
 	render_pass(pass);
+    track_draw(translation);
+    track_layer_content(translation);
 }
 
 void RDRenderInterfaceGodot::ReleaseShader(Rml::CompiledShaderHandle shader) {
     ShaderInfo *info = reinterpret_cast<ShaderInfo *>(shader);
 
-    if (info->uniform_buffer.is_valid()) {
-        rendering_resources.free_storage_buffer(info->uniform_buffer);
-    }
-    
-    memdelete(info);
+    queue_release([this, info]() {
+        if (info->uniform_buffer.is_valid()) {
+            rendering_resources.free_storage_buffer(info->uniform_buffer);
+        }
+        memdelete(info);
+    });
 }
\ No newline at end of file
@@ -1,91 +1,364 @@
 #pragma once
 #include <RmlUi/Core/RenderInterface.h>
 #include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/canvas_item_material.hpp>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "render_interface_godot.h"
 #include "../rendering/rendering_resources.h"
+#include "../rendering/geometry_arena.h"
 
 namespace godot {
 
 class RDRenderInterfaceGodot: public RenderInterfaceGodot {
+    // Two independent 64-bit hashes of the geometry content, wide enough to share meshes
+    // without keeping their data around to compare against
+    struct GeometryKey {
+        uint64_t h0 = 0;
+        uint64_t h1 = 0;
+
+        bool operator==(const GeometryKey &p_other) const { return h0 == p_other.h0 && h1 == p_other.h1; }
+    };
+
+    struct GeometryKeyHasher {
+        size_t operator()(const GeometryKey &p_key) const { return (size_t)(p_key.h0 ^ p_key.h1); }
+    };
+
 	struct MeshData {
-        RID position_buffer;
-        RID color_buffer;
-        RID uv_buffer;
-        RID index_buffer;
+        GeometryArena::Allocation allocation;
         RID vertex_array;
         RID index_array;
+        // Untransformed bounds of the vertices
+        Rect2 bounds;
+        // Only created while a context renders directly into the canvas
+        RID canvas_mesh;
+
+        // Identical geometry compiled again shares the same data
+        GeometryKey content_key;
+        uint32_t references = 1;
     };
 
     struct TextureData {
         RID rid;
         Ref<Texture> tex_ref;
         bool linear_filtering = true;
+        // RenderingServer texture wrapping rid, created once drawn directly into the canvas
+        RID canvas_texture;
+
+        // Generated textures only, used to reuse the texture when it's regenerated
+        Vector2i size;
+        // Alpha only data stored as R8 and read back as RRRR
+        bool single_channel = false;
+        std::vector<uint64_t> row_hashes;
+        // Bumped when the content of the texture changes in place
+        uint64_t version = 0;
+        uint64_t released_frame = 0;
+        // Loaded textures that can change in place without us knowing, e.g. an ImageTexture
+        // updated by a script, so frames drawing them never count as unchanged
+        bool mutable_content = false;
     };
 
 	struct RenderTarget {
         RID color;
         RID framebuffer;
 		Vector2i size;
+        // Process frame in which a pooled layer target was last returned
+        uint64_t last_used_frame = 0;
+        // Region drawn to since a layer was pushed, composition is limited to it
+        Rect2i content_bounds;
     };
 
-	struct Context {
-		std::vector<RenderTarget *> target_stack;
-		uintptr_t target_stack_ptr = 0;
+    // Back buffers are shared between contexts and only allocated once a frame needs them,
+    // so passes compiled ahead of time refer to them by slot, resolved when recorded
+    enum TargetSlot {
+        TARGET_SLOT_NONE = -1,
+        TARGET_SLOT_BACK_BUFFER0,
+        TARGET_SLOT_BACK_BUFFER1,
+        TARGET_SLOT_BACK_BUFFER2,
+        TARGET_SLOT_BLEND,
+        // Storage images written by the blur compute passes, without framebuffer
+        TARGET_SLOT_BLUR0,
+        TARGET_SLOT_BLUR1,
+        TARGET_SLOT_MAX
+    };
 
-		RenderTarget main_target;
-		RenderTarget back_buffer0;
-        RenderTarget back_buffer1;
-        RenderTarget back_buffer2;
-        RenderTarget blend_target;
-		
-		RID main_tex;
-		RID clip_mask, clip_mask_framebuffer;
+    struct TextureBinding {
+        RID texture;
+        bool linear_filtering = false;
+        TargetSlot slot = TARGET_SLOT_NONE;
+        uint64_t version = 0;
 
-		Vector2i size;
+        TextureBinding() {}
+        TextureBinding(const RID &p_texture, bool p_linear_filtering = false, uint64_t p_version = 0) : texture(p_texture), linear_filtering(p_linear_filtering), version(p_version) {}
+        TextureBinding(TargetSlot p_slot) : slot(p_slot) {}
+    };
 
-		bool is_valid() { return main_tex.is_valid(); }
+    // Scratch targets of every context in the same size bucket. Contexts render one after
+    // another, so they never need them at the same time
+    struct SharedTargets {
+        Vector2i size;
+        uint32_t users = 0;
 
-        RID get_texture() { return main_tex; }
-	};
+        RID clip_mask, clip_mask_framebuffer;
+        RenderTarget slots[TARGET_SLOT_MAX];
+
+        // Layer targets not borrowed by any context, least recently used first
+        std::vector<RenderTarget *> free_layers;
+    };
+
+    // Fixed capacity storage kept inline, so passes can be built and copied without allocating
+    template <typename T, uint32_t N>
+    struct InlineArray {
+        T items[N];
+        uint32_t count = 0;
+
+        void push_back(const T &p_item) {
+            ERR_FAIL_COND_MSG(count >= N, "Inline array capacity exceeded");
+            items[count++] = p_item;
+        }
+        void clear() { count = 0; }
+        uint32_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        T &operator[](uint32_t p_index) { return items[p_index]; }
+        const T &operator[](uint32_t p_index) const { return items[p_index]; }
+        T *begin() { return items; }
+        T *end() { return items + count; }
+        const T *begin() const { return items; }
+        const T *end() const { return items + count; }
+    };
+
+    // Push constant data, sized to the 128 bytes every device is guaranteed to support
+    struct PushConstant {
+        alignas(16) uint8_t data[128];
+        uint32_t length = 0;
+
+        void resize(uint32_t p_size) {
+            ERR_FAIL_COND(p_size > sizeof(data));
+            if (p_size > length) {
+                memset(data + length, 0, p_size - length);
+            }
+            length = p_size;
+        }
+        uint8_t *ptrw() { return data; }
+        const uint8_t *ptr() const { return data; }
+        int64_t size() const { return length; }
+        bool is_empty() const { return length == 0; }
+    };
+
+    static const uint32_t MAX_PASS_TEXTURES = 4;
+    typedef InlineArray<TextureBinding, MAX_PASS_TEXTURES> TextureBindings;
 
 	struct RenderPass {
-        String debug_name = "Pass_";
+        const char *debug_name = "Pass_";
 
 		RID shader;
 		RID pipeline;
 
 		MeshData *mesh_data = nullptr;
 
-		PackedByteArray push_const;
+		PushConstant push_const;
 
-		std::vector<std::pair<RID, bool>> uniform_textures;
+		TextureBindings uniform_textures;
 		RID uniform_buffer = RID();
 
 		RID framebuffer;
+        TargetSlot framebuffer_slot = TARGET_SLOT_NONE;
+
+        // Compute passes write to the image of their target slot instead of a framebuffer
+        bool compute = false;
+        RID image;
+        // Passes over the scissor region get it written to the first 16 bytes of their push
+        // constant when executed, compute passes are dispatched over it divided by this scale
+        int32_t region_scale = 0;
+        // Cached by the interface, e.g. blur kernels, not freed along with the pass
+        bool shared_uniform_buffer = false;
+
+        // Geometry translated per instance, consecutive draws of the same geometry that only
+        // differ in translation are merged into the first one when executed
+        bool instanced = false;
+        Rml::Vector2f translation;
+        uint32_t instance_offset = 0;
+        uint32_t instance_count = 1;
 
 		BitField<RenderingDevice::DrawFlags> draw_flags = RenderingDevice::DRAW_DEFAULT_ALL;
 		PackedColorArray clear_colors = {};
 		unsigned int clear_stencil = 0;
         Rect2i region = Rect2i(0, 0, 0, 0);
+
+        // Scissor state at the time the pass was recorded
+        bool scissor_enabled = false;
+        Rect2 scissor_region = Rect2();
+	};
+
+    // A draw recorded on the main target, compared between frames to find the damaged region
+    struct DrawRecord {
+        uint64_t hash = 0;
+        Rect2i bounds;
+        // Affects pixels outside of its geometry, e.g. clears the clip mask
+        bool unbounded = false;
+    };
+
+    // Geometry drawn straight into the canvas by draw_context
+    struct CanvasDraw {
+        RID mesh;
+        RID texture;
+        Transform2D transform;
+        bool scissor_enabled = false;
+        Rect2 scissor_region;
+    };
+
+	struct Context {
+		std::vector<RenderTarget *> target_stack;
+		uintptr_t target_stack_ptr = 0;
+
+		RenderTarget main_target;
+		SharedTargets *shared = nullptr;
+		
+		RID main_tex;
+
+		// Size of the document, targets are allocated with the bucket size
+		Vector2i size;
+		Vector2i target_size;
+
+		// Passes recorded during the frame, executed on pop_context
+		std::vector<RenderPass> commands;
+		uint64_t signature = 0;
+		uint64_t last_signature = 0;
+		bool has_frame = false;
+		bool incremental = false;
+
+		// Draws of this and the last executed frame, only kept while no layers are used
+		std::vector<DrawRecord> draws;
+		std::vector<DrawRecord> last_draws;
+		bool damage_tracking = true;
+		bool has_draw_history = false;
+
+		// Frames using no layers, filters, clip masks or shaders skip main_target
+		// and are drawn as canvas meshes instead
+		bool direct_rendering = false;
+		bool direct_eligible = false;
+		bool direct_frame = false;
+		std::vector<CanvasDraw> canvas_draws;
+		// Child items of the canvas item drawn into with the premultiplied material,
+		// one per scissor region for direct frames, a single one for main_target otherwise
+		std::vector<RID> canvas_items;
+
+		// GPU microseconds by pass kind of the last frame whose timestamps were resolved
+		std::map<String, uint64_t> gpu_times;
+
+		bool is_valid() { return main_tex.is_valid(); }
+
+        RID get_texture() { return main_tex; }
 	};
 
+    // Uniform set created for a combination of shader and bindings
+    struct UniformSetEntry {
+        RID uniform_set;
+        RID shader;
+        RID uniform_buffer;
+        RID image;
+        TextureBindings textures;
+    };
+
+    // Gaussian weights folded into linear sampling taps, shared by every blur of the same sigma
+    struct BlurKernel {
+        RID buffer;
+        uint32_t tap_count = 0;
+    };
+
     struct RenderPasses {
         std::vector<RenderPass> passes;
+        // Filters expressible as a color matrix, fused with their neighbours when composited
+        bool color_matrix = false;
+        Rml::Matrix4f matrix = Rml::Matrix4f::Identity();
+        // Transparent pixels stay transparent, so the filter doesn't spread the content of the layer
+        bool preserves_transparency = false;
     };
 
     struct ShaderInfo {
         RID shader;
         RID uniform_buffer = RID();
         uint64_t pipeline_id;
-        PackedByteArray push_const;
+        PushConstant push_const;
+    };
+
+    // Draw list kept open between passes targeting the same framebuffer,
+    // along with the last bound state to skip redundant binds
+    struct DrawBatch {
+        int64_t draw_list = -1;
+        RID framebuffer;
+        Rect2i region;
+        uint32_t pass_count = 0;
+
+        RID pipeline;
+        RID vertex_array;
+        RID index_array;
+        RID uniform_set;
+        bool scissor_enabled = false;
+        Rect2 scissor_region;
+        const char *debug_name = nullptr;
+
+        bool is_open() const { return draw_list != -1; }
+    };
+
+    // Timestamp captured before the passes of a kind, or closing the commands of a context
+    struct TimestampRecord {
+        Context *context = nullptr;
+        uint64_t execution = 0;
+        // Null for the closing timestamp
+        const char *kind = nullptr;
     };
 
 	Context *context = nullptr;
 
+    DrawBatch batch;
+    bool batching_enabled = true;
+    // Un-premultiplies main_target with an extra pass, instead of compositing it premultiplied
+    bool post_process_enabled = false;
+
+    // Passes are timed with device timestamps, read back a few frames later once the GPU is done
+    bool gpu_profiling_enabled = false;
+    bool timing_execution = false;
+    uint32_t timestamp_budget = 0;
+    uint32_t timestamps_used = 0;
+    uint64_t timestamp_frame = 0;
+    uint64_t timestamp_serial = 0;
+    uint64_t execution_serial = 0;
+    uint64_t resolved_timestamp_frame = 0;
+    // Keyed by the serial in the timestamp name
+    std::map<uint64_t, TimestampRecord> pending_timestamps;
+
+    // Releases requested while recording, deferred until the commands are executed
+    std::vector<std::function<void()>> pending_releases;
+
+    std::map<uint64_t, SharedTargets *> shared_targets;
+
+    std::unordered_map<uint64_t, UniformSetEntry> uniform_sets;
+
+    std::unordered_map<GeometryKey, MeshData *, GeometryKeyHasher> geometry_cache;
+    // Translations of the instanced draws of the commands being executed
+    RID instance_buffer;
+    uint32_t instance_capacity = 0;
+    PackedByteArray instance_data;
+
+    // Keyed by the sigma in eighths of a texel
+    std::map<uint32_t, BlurKernel> blur_kernels;
+
+    // Canvas meshes are only created while a context renders directly
+    uint32_t direct_rendering_contexts = 0;
+    Ref<CanvasItemMaterial> premultiplied_material;
+    // Releases of resources the canvas may still draw with until it's redrawn,
+    // along with the process frame they were requested in
+    std::vector<std::pair<std::function<void()>, uint64_t>> canvas_releases;
+
 	RenderingResources internal_rendering_resources;
     RenderingResources rendering_resources;
+    GeometryArena geometry_arena;
 
 	int64_t color_framebuffer_format;
     int64_t geometry_framebuffer_format;
@@ -95,20 +368,24 @@ class RDRenderInterfaceGodot: public RenderInterfaceGodot {
     RID shader_blit;
     RID shader_geometry;
     RID shader_clip_mask;
-    RID shader_layer_composition;
-    RID shader_post_process;
 
     RID pipeline_blit;
-    RID pipeline_geometry;
-    RID pipeline_geometry_clipping;
     RID pipeline_clip_mask_set;
     RID pipeline_clip_mask_set_inverse;
     RID pipeline_clip_mask_intersect;
-    RID pipeline_layer_composition;
-    RID pipeline_post_process;
 
-    std::map<uint64_t, RID> shaders;
-    std::map<uint64_t, RID> pipelines;
+    struct PipelineDesc {
+        uint64_t shader_id = 0;
+        bool compute = false;
+        // Left without a shader, get_pipeline_desc fills in the one of shader_id
+        RenderPipelineDesc render;
+    };
+
+    // Shaders and pipelines created on first use, and the ones created so far
+    std::map<uint64_t, ShaderDesc> shader_descs;
+    std::map<uint64_t, PipelineDesc> pipeline_descs;
+    std::unordered_map<uint64_t, RID> loaded_shaders;
+    std::unordered_map<uint64_t, RID> loaded_pipelines;
     std::map<uint64_t, std::tuple<RID, RID>> pipelines_with_clip;
 
     RID sampler_nearest;
@@ -116,36 +393,130 @@ class RDRenderInterfaceGodot: public RenderInterfaceGodot {
 
     RID texture_white, texture_transparent;
 
+    // Generated textures released recently, most recent last. RmlUi regenerates font
+    // atlases as a whole, so the same size is usually generated again right after
+    std::vector<TextureData *> released_textures;
+    uint64_t texture_version = 0;
+
+    PackedColorArray clear_colors_transparent;
+    // Reused to submit push constants without allocating
+    PackedByteArray push_const_buffer;
+
+    // Scratch of compute_damage, kept to match the draws of two frames without allocating
+    struct DrawCount {
+        uint64_t hash = 0;
+        uint32_t available = 0;
+        uint32_t matched = 0;
+    };
+    std::vector<DrawCount> damage_counts;
+    std::vector<uint64_t> damage_last_order;
+    std::vector<uint64_t> damage_current_order;
+    std::vector<const DrawRecord *> damage_changed;
+
+    // Capacities of the buffers above and of the context ones when its frame started
+    static constexpr int SUBMISSION_BUFFER_COUNT = 9;
+    size_t submission_capacities[SUBMISSION_BUFFER_COUNT] = {};
+
     bool scissor_enabled = false;
     Rect2 scissor_region = Rect2();
     bool clip_mask_enabled = false;
 
     Rml::Matrix4f drawing_matrix = Rml::Matrix4f::Identity();
 
-	void create_render_pipeline_with_clip(uint64_t p_id, const std::map<String, Variant> &p_params);
-    RID get_shader_pipeline(uint64_t p_id) const;
+	void create_render_pipeline_with_clip(uint64_t p_id, const RenderPipelineDesc &p_desc);
+    RID get_shader_pipeline(uint64_t p_id);
+    RID get_shader(uint64_t p_id);
+    RID get_pipeline(uint64_t p_id);
+    RenderPipelineDesc get_pipeline_desc(uint64_t p_id);
 
 	RenderTarget *get_render_target();
 	
 	void allocate_render_target(RenderTarget *p_target, const Vector2i &p_size);
     void free_render_target(RenderTarget *p_target);
+    void allocate_storage_target(RenderTarget *p_target, const Vector2i &p_size);
+
+    static Vector2i get_bucket_size(const Vector2i &p_size);
+    SharedTargets *acquire_shared_targets(const Vector2i &p_size);
+    void release_shared_targets(SharedTargets *p_shared);
+    RenderTarget *get_slot_target(TargetSlot p_slot);
+
+    RenderTarget *borrow_layer_target();
+    void return_layer_target(RenderTarget *p_target);
+    void evict_idle_layer_targets();
+
+    TextureData *reuse_released_texture(const PackedByteArray &p_pixels, const Vector2i &p_size, bool p_single_channel, const std::vector<uint64_t> &p_row_hashes);
+    void evict_released_textures(bool p_all = false);
+
+    RID create_canvas_mesh(Rml::Span<const Rml::Vertex> p_vertices, Rml::Span<const int> p_indices);
+    RID get_canvas_texture(TextureData *p_texture);
+    void queue_canvas_release(const std::function<void()> &p_release);
+    void run_canvas_releases(bool p_all = false);
+    void free_texture_data(TextureData *p_texture);
+    void record_canvas_draw(MeshData *p_mesh_data, const Rml::Vector2f &p_translation, Rml::TextureHandle p_texture);
+    void draw_canvas_draws(Context *p_ctx, const RID &p_canvas_item);
+    RID prepare_canvas_item(Context *p_ctx, uint32_t p_index, const RID &p_parent);
+    void clear_canvas_items(Context *p_ctx, uint32_t p_from = 0);
 
 	void allocate_context(Context *p_context, const Vector2i &p_size);
 	void free_context(Context *p_context);
 
-	void render_pass(const RenderPass &p_pass);
+	void finish_context();
 
-    RenderPass blit_pass(const RID &p_tex, const RID &p_framebuffer, const Vector2i &p_dst_pos = Vector2i(), const Vector2i &p_src_pos = Vector2i(), const Vector2i &p_size = Vector2i());
+	void render_pass(const RenderPass &p_pass);
+    void execute_pass(const RenderPass &p_pass);
+    void execute_compute_pass(const RenderPass &p_pass);
+    Rect2i get_filter_region(const RenderPass &p_pass) const;
+    void execute_commands();
+    void prepare_instances();
+    static bool can_instance(const RenderPass &p_first, const RenderPass &p_next);
+
+    static uint64_t hash_pass(const RenderPass &p_pass, uint64_t p_hash);
+    TextureBinding get_texture_binding(TextureData *p_texture);
+    static GeometryKey hash_geometry(Rml::Span<const Rml::Vertex> p_vertices, Rml::Span<const int> p_indices);
+
+    bool get_draw_bounds(const RenderPass &p_pass, const Rml::Vector2f &p_translation, Rect2i &r_bounds) const;
+    void track_draw(const Rml::Vector2f &p_translation, bool p_unbounded = false);
+    void track_layer_content(const Rml::Vector2f &p_translation);
+    void extend_layer_content(RenderTarget *p_target, const Rect2i &p_bounds);
+    bool compute_damage(Rect2i &r_damage);
+    DrawCount *find_draw_count(uint64_t p_hash);
+    uint32_t update_submission_capacities();
+    void restrict_commands(const Rect2i &p_damage);
+
+    void queue_release(const std::function<void()> &p_release);
+    void run_pending_releases();
+
+    RID get_uniform_set(const RenderPass &p_pass);
+    void purge_uniform_sets(bool p_free_all = false);
+
+    bool reserve_timestamps(uint32_t p_count);
+    void capture_timestamp(const char *p_kind);
+    void resolve_timestamps();
+
+    bool can_batch_pass(const RenderPass &p_pass) const;
+    void begin_batch(const RenderPass &p_pass);
+    void flush_batch();
+
+    RenderPass clear_pass(const RID &p_framebuffer);
+    RenderPass blit_pass(const TextureBinding &p_tex, const RID &p_framebuffer, const Vector2i &p_dst_pos = Vector2i(), const Vector2i &p_src_pos = Vector2i(), const Vector2i &p_size = Vector2i());
+    RenderPass blit_pass(const TextureBinding &p_tex, TargetSlot p_framebuffer_slot);
+
+    RenderPass color_matrix_pass(const Rml::Matrix4f &p_matrix, const char *p_debug_name);
+    RenderPasses color_matrix_passes(const Rml::Matrix4f &p_matrix, const char *p_debug_name);
+
+    const BlurKernel &get_blur_kernel(float p_sigma);
+    void add_blur_passes(RenderPasses &r_passes, float p_sigma, const Vector2 &p_offset, TargetSlot p_output);
 
     bool check_if_can_render_with_scissor() const;
 public:
 	void initialize() override;
     void finalize() override;
 
-    void push_context(void *&p_ctx, const Vector2i &p_size) override;
+    void push_context(void *&p_ctx, const Vector2i &p_size, bool p_incremental, bool p_direct) override;
     void pop_context() override;
     void draw_context(void *&p_ctx, const RID &p_canvas_item) override;
 	void free_context(void *&p_ctx) override;
+    Dictionary get_context_gpu_times(void *&p_ctx) override;
 
 	Rml::CompiledGeometryHandle CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) override;
 	void RenderGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) override;
@@ -0,0 +1,675 @@
+#include "render_capture.h"
+#include <RmlUi/Core/DecorationTypes.h>
+#include <RmlUi/Core/Log.h>
+#include <RmlUi/Core/Variant.h>
+
+#include <cstring>
+#include <utility>
+
+// RenderCaptureInterface
+
+void RenderCaptureInterface::write_command(RenderCaptureCommand p_command) {
+	stream.push_back(p_command);
+}
+
+void RenderCaptureInterface::write_data(const void *p_data, size_t p_size) {
+	const uint8_t *bytes = static_cast<const uint8_t *>(p_data);
+	stream.insert(stream.end(), bytes, bytes + p_size);
+}
+
+void RenderCaptureInterface::write_string(const Rml::String &p_string) {
+	write<uint32_t>(p_string.size());
+	write_data(p_string.data(), p_string.size());
+}
+
+void RenderCaptureInterface::write_dictionary(const Rml::Dictionary &p_dictionary) {
+	write<uint32_t>(p_dictionary.size());
+
+	for (const auto &it : p_dictionary) {
+		write_string(it.first);
+
+		// Only the types filters and shaders are compiled with, others replay as empty values
+		const Rml::Variant &value = it.second;
+		switch (value.GetType()) {
+			case Rml::Variant::BOOL: {
+				write<uint8_t>(Rml::Variant::BOOL);
+				write<uint8_t>(value.Get<bool>());
+			} break;
+			case Rml::Variant::BYTE:
+			case Rml::Variant::CHAR:
+			case Rml::Variant::INT:
+			case Rml::Variant::INT64:
+			case Rml::Variant::UINT:
+			case Rml::Variant::UINT64: {
+				write<uint8_t>(Rml::Variant::INT64);
+				write<int64_t>(value.Get<int64_t>());
+			} break;
+			case Rml::Variant::FLOAT:
+			case Rml::Variant::DOUBLE: {
+				write<uint8_t>(Rml::Variant::DOUBLE);
+				write<double>(value.Get<double>());
+			} break;
+			case Rml::Variant::STRING: {
+				write<uint8_t>(Rml::Variant::STRING);
+				write_string(value.Get<Rml::String>());
+			} break;
+			case Rml::Variant::VECTOR2: {
+				write<uint8_t>(Rml::Variant::VECTOR2);
+				write(value.Get<Rml::Vector2f>());
+			} break;
+			case Rml::Variant::VECTOR3: {
+				write<uint8_t>(Rml::Variant::VECTOR3);
+				write(value.Get<Rml::Vector3f>());
+			} break;
+			case Rml::Variant::VECTOR4: {
+				write<uint8_t>(Rml::Variant::VECTOR4);
+				write(value.Get<Rml::Vector4f>());
+			} break;
+			case Rml::Variant::COLOURF: {
+				write<uint8_t>(Rml::Variant::COLOURF);
+				write(value.Get<Rml::Colourf>());
+			} break;
+			case Rml::Variant::COLOURB: {
+				write<uint8_t>(Rml::Variant::COLOURB);
+				write(value.Get<Rml::Colourb>());
+			} break;
+			case Rml::Variant::COLORSTOPLIST: {
+				const Rml::ColorStopList &stops = value.GetReference<Rml::ColorStopList>();
+				write<uint8_t>(Rml::Variant::COLORSTOPLIST);
+				write<uint32_t>(stops.size());
+				for (const Rml::ColorStop &stop : stops) {
+					write(stop.color);
+					write(stop.position.number);
+					write<uint32_t>((uint32_t)stop.position.unit);
+				}
+			} break;
+			default: {
+				write<uint8_t>(Rml::Variant::NONE);
+			} break;
+		}
+	}
+}
+
+void RenderCaptureInterface::write_compile_geometry(uintptr_t p_handle, Rml::Span<const Rml::Vertex> p_vertices, Rml::Span<const int> p_indices) {
+	write_command(CAPTURE_COMPILE_GEOMETRY);
+	write<uint64_t>(p_handle);
+	write<uint32_t>(p_vertices.size());
+	write<uint32_t>(p_indices.size());
+	write_data(p_vertices.data(), p_vertices.size() * sizeof(Rml::Vertex));
+	write_data(p_indices.data(), p_indices.size() * sizeof(int));
+}
+
+void RenderCaptureInterface::write_load_texture(uintptr_t p_handle, const Rml::String &p_source) {
+	write_command(CAPTURE_LOAD_TEXTURE);
+	write<uint64_t>(p_handle);
+	write_string(p_source);
+}
+
+void RenderCaptureInterface::write_generate_texture(uintptr_t p_handle, Rml::Span<const Rml::byte> p_source, Rml::Vector2i p_dimensions) {
+	write_command(CAPTURE_GENERATE_TEXTURE);
+	write<uint64_t>(p_handle);
+	write(p_dimensions);
+	write<uint32_t>(p_source.size());
+	write_data(p_source.data(), p_source.size());
+}
+
+void RenderCaptureInterface::write_compile_program(RenderCaptureCommand p_command, uintptr_t p_handle, const CompiledProgram &p_program) {
+	write_command(p_command);
+	write<uint64_t>(p_handle);
+	write_string(p_program.name);
+	write_dictionary(p_program.parameters);
+}
+
+void RenderCaptureInterface::begin(Rml::Vector2i p_size) {
+	stream.clear();
+	recording = true;
+
+	write(RENDER_CAPTURE_MAGIC);
+	write(RENDER_CAPTURE_VERSION);
+	write(p_size);
+
+	// Recreated from their payloads instead of releasing RmlUi's resources to have them compiled again
+	for (const auto &it : geometries) {
+		write_compile_geometry(it.first, it.second.vertices, it.second.indices);
+	}
+	for (const auto &it : textures) {
+		if (it.second.loaded) {
+			write_load_texture(it.first, it.second.source);
+		} else {
+			write_generate_texture(it.first, it.second.data, it.second.dimensions);
+		}
+	}
+	for (const auto &it : filters) {
+		write_compile_program(CAPTURE_COMPILE_FILTER, it.first, it.second);
+	}
+	for (const auto &it : shaders) {
+		write_compile_program(CAPTURE_COMPILE_SHADER, it.first, it.second);
+	}
+}
+
+std::vector<uint8_t> RenderCaptureInterface::end() {
+	recording = false;
+	return std::move(stream);
+}
+
+Rml::CompiledGeometryHandle RenderCaptureInterface::CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) {
+	Rml::CompiledGeometryHandle handle = target->CompileGeometry(vertices, indices);
+	if (handle == 0) return handle;
+
+	GeometryPayload &payload = geometries[handle];
+	payload.vertices.assign(vertices.begin(), vertices.end());
+	payload.indices.assign(indices.begin(), indices.end());
+	if (recording) {
+		write_compile_geometry(handle, vertices, indices);
+	}
+	return handle;
+}
+
+void RenderCaptureInterface::RenderGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) {
+	if (recording) {
+		write_command(CAPTURE_RENDER_GEOMETRY);
+		write<uint64_t>(geometry);
+		write(translation);
+		write<uint64_t>(texture);
+	}
+	target->RenderGeometry(geometry, translation, texture);
+}
+
+void RenderCaptureInterface::ReleaseGeometry(Rml::CompiledGeometryHandle geometry) {
+	geometries.erase(geometry);
+	if (recording) {
+		write_command(CAPTURE_RELEASE_GEOMETRY);
+		write<uint64_t>(geometry);
+	}
+	target->ReleaseGeometry(geometry);
+}
+
+Rml::TextureHandle RenderCaptureInterface::LoadTexture(Rml::Vector2i& texture_dimensions, const Rml::String& source) {
+	Rml::TextureHandle handle = target->LoadTexture(texture_dimensions, source);
+	if (handle == 0) return handle;
+
+	TexturePayload &payload = textures[handle];
+	payload.loaded = true;
+	payload.source = source;
+	if (recording) {
+		write_load_texture(handle, source);
+	}
+	return handle;
+}
+
+Rml::TextureHandle RenderCaptureInterface::GenerateTexture(Rml::Span<const Rml::byte> source, Rml::Vector2i source_dimensions) {
+	Rml::TextureHandle handle = target->GenerateTexture(source, source_dimensions);
+	if (handle == 0) return handle;
+
+	TexturePayload &payload = textures[handle];
+	payload.dimensions = source_dimensions;
+	payload.data.assign(source.begin(), source.end());
+	if (recording) {
+		write_generate_texture(handle, source, source_dimensions);
+	}
+	return handle;
+}
+
+void RenderCaptureInterface::ReleaseTexture(Rml::TextureHandle texture) {
+	textures.erase(texture);
+	if (recording) {
+		write_command(CAPTURE_RELEASE_TEXTURE);
+		write<uint64_t>(texture);
+	}
+	target->ReleaseTexture(texture);
+}
+
+void RenderCaptureInterface::EnableScissorRegion(bool enable) {
+	if (recording) {
+		write_command(CAPTURE_ENABLE_SCISSOR_REGION);
+		write<uint8_t>(enable);
+	}
+	target->EnableScissorRegion(enable);
+}
+
+void RenderCaptureInterface::SetScissorRegion(Rml::Rectanglei region) {
+	if (recording) {
+		write_command(CAPTURE_SET_SCISSOR_REGION);
+		write(region.Position());
+		write(region.Size());
+	}
+	target->SetScissorRegion(region);
+}
+
+void RenderCaptureInterface::EnableClipMask(bool enable) {
+	if (recording) {
+		write_command(CAPTURE_ENABLE_CLIP_MASK);
+		write<uint8_t>(enable);
+	}
+	target->EnableClipMask(enable);
+}
+
+void RenderCaptureInterface::RenderToClipMask(Rml::ClipMaskOperation operation, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation) {
+	if (recording) {
+		write_command(CAPTURE_RENDER_TO_CLIP_MASK);
+		write<uint8_t>((uint8_t)operation);
+		write<uint64_t>(geometry);
+		write(translation);
+	}
+	target->RenderToClipMask(operation, geometry, translation);
+}
+
+void RenderCaptureInterface::SetTransform(const Rml::Matrix4f* transform) {
+	if (recording) {
+		write_command(CAPTURE_SET_TRANSFORM);
+		write<uint8_t>(transform != nullptr);
+		if (transform != nullptr) {
+			write_data(transform->data(), sizeof(float) * 16);
+		}
+	}
+	target->SetTransform(transform);
+}
+
+Rml::LayerHandle RenderCaptureInterface::PushLayer() {
+	Rml::LayerHandle handle = target->PushLayer();
+	if (recording) {
+		write_command(CAPTURE_PUSH_LAYER);
+		write<uint64_t>(handle);
+	}
+	return handle;
+}
+
+void RenderCaptureInterface::CompositeLayers(Rml::LayerHandle source, Rml::LayerHandle destination, Rml::BlendMode blend_mode, Rml::Span<const Rml::CompiledFilterHandle> filters) {
+	if (recording) {
+		write_command(CAPTURE_COMPOSITE_LAYERS);
+		write<uint64_t>(source);
+		write<uint64_t>(destination);
+		write<uint8_t>((uint8_t)blend_mode);
+		write<uint32_t>(filters.size());
+		for (Rml::CompiledFilterHandle filter : filters) {
+			write<uint64_t>(filter);
+		}
+	}
+	target->CompositeLayers(source, destination, blend_mode, filters);
+}
+
+void RenderCaptureInterface::PopLayer() {
+	if (recording) {
+		write_command(CAPTURE_POP_LAYER);
+	}
+	target->PopLayer();
+}
+
+Rml::TextureHandle RenderCaptureInterface::SaveLayerAsTexture() {
+	Rml::TextureHandle handle = target->SaveLayerAsTexture();
+	if (recording) {
+		write_command(CAPTURE_SAVE_LAYER_AS_TEXTURE);
+		write<uint64_t>(handle);
+	}
+	return handle;
+}
+
+Rml::CompiledFilterHandle RenderCaptureInterface::SaveLayerAsMaskImage() {
+	Rml::CompiledFilterHandle handle = target->SaveLayerAsMaskImage();
+	if (recording) {
+		write_command(CAPTURE_SAVE_LAYER_AS_MASK_IMAGE);
+		write<uint64_t>(handle);
+	}
+	return handle;
+}
+
+Rml::CompiledFilterHandle RenderCaptureInterface::CompileFilter(const Rml::String& name, const Rml::Dictionary& parameters) {
+	Rml::CompiledFilterHandle handle = target->CompileFilter(name, parameters);
+	if (handle == 0) return handle;
+
+	CompiledProgram &program = filters[handle];
+	program = { name, parameters };
+	if (recording) {
+		write_compile_program(CAPTURE_COMPILE_FILTER, handle, program);
+	}
+	return handle;
+}
+
+void RenderCaptureInterface::ReleaseFilter(Rml::CompiledFilterHandle filter) {
+	filters.erase(filter);
+	if (recording) {
+		write_command(CAPTURE_RELEASE_FILTER);
+		write<uint64_t>(filter);
+	}
+	target->ReleaseFilter(filter);
+}
+
+Rml::CompiledShaderHandle RenderCaptureInterface::CompileShader(const Rml::String& name, const Rml::Dictionary& parameters) {
+	Rml::CompiledShaderHandle handle = target->CompileShader(name, parameters);
+	if (handle == 0) return handle;
+
+	CompiledProgram &program = shaders[handle];
+	program = { name, parameters };
+	if (recording) {
+		write_compile_program(CAPTURE_COMPILE_SHADER, handle, program);
+	}
+	return handle;
+}
+
+void RenderCaptureInterface::RenderShader(Rml::CompiledShaderHandle shader, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) {
+	if (recording) {
+		write_command(CAPTURE_RENDER_SHADER);
+		write<uint64_t>(shader);
+		write<uint64_t>(geometry);
+		write(translation);
+		write<uint64_t>(texture);
+	}
+	target->RenderShader(shader, geometry, translation, texture);
+}
+
+void RenderCaptureInterface::ReleaseShader(Rml::CompiledShaderHandle shader) {
+	shaders.erase(shader);
+	if (recording) {
+		write_command(CAPTURE_RELEASE_SHADER);
+		write<uint64_t>(shader);
+	}
+	target->ReleaseShader(shader);
+}
+
+// RenderCapturePlayer
+
+namespace {
+
+class CaptureReader {
+	const uint8_t *ptr;
+	const uint8_t *end;
+	bool failed = false;
+
+public:
+	CaptureReader(const uint8_t *p_data, size_t p_size) : ptr(p_data), end(p_data + p_size) {}
+
+	bool has_failed() const { return failed; }
+	bool at_end() const { return ptr >= end; }
+
+	const uint8_t *read_data(size_t p_size) {
+		if (failed || (size_t)(end - ptr) < p_size) {
+			failed = true;
+			return nullptr;
+		}
+		const uint8_t *data = ptr;
+		ptr += p_size;
+		return data;
+	}
+
+	template <typename T>
+	T read() {
+		T value = T();
+		const uint8_t *data = read_data(sizeof(T));
+		if (data != nullptr) {
+			memcpy(&value, data, sizeof(T));
+		}
+		return value;
+	}
+
+	Rml::String read_string() {
+		uint32_t length = read<uint32_t>();
+		const uint8_t *data = read_data(length);
+		return data != nullptr ? Rml::String((const char *)data, length) : Rml::String();
+	}
+
+	Rml::Dictionary read_dictionary() {
+		Rml::Dictionary dictionary;
+		uint32_t count = read<uint32_t>();
+
+		for (uint32_t i = 0; i < count && !failed; i++) {
+			Rml::String key = read_string();
+			Rml::Variant &value = dictionary[key];
+
+			switch (read<uint8_t>()) {
+				case Rml::Variant::NONE: break;
+				case Rml::Variant::BOOL: value = (bool)read<uint8_t>(); break;
+				case Rml::Variant::INT64: value = read<int64_t>(); break;
+				// Parameters are read back as float, the type filters and shaders expect
+				case Rml::Variant::DOUBLE: value = (float)read<double>(); break;
+				case Rml::Variant::STRING: value = read_string(); break;
+				case Rml::Variant::VECTOR2: value = read<Rml::Vector2f>(); break;
+				case Rml::Variant::VECTOR3: value = read<Rml::Vector3f>(); break;
+				case Rml::Variant::VECTOR4: value = read<Rml::Vector4f>(); break;
+				case Rml::Variant::COLOURF: value = read<Rml::Colourf>(); break;
+				case Rml::Variant::COLOURB: value = read<Rml::Colourb>(); break;
+				case Rml::Variant::COLORSTOPLIST: {
+					Rml::ColorStopList stops(read<uint32_t>());
+					for (Rml::ColorStop &stop : stops) {
+						stop.color = read<Rml::ColourbPremultiplied>();
+						stop.position.number = read<float>();
+						stop.position.unit = (Rml::Unit)read<uint32_t>();
+					}
+					value = std::move(stops);
+				} break;
+				default: failed = true; break;
+			}
+		}
+		return dictionary;
+	}
+};
+
+// Recorded handles mapped to the ones the target created
+struct HandleMap {
+	std::map<uint64_t, uintptr_t> handles;
+
+	void add(uint64_t p_recorded, uintptr_t p_handle) { handles[p_recorded] = p_handle; }
+	// Zero is the base layer or no texture, and stays so
+	uintptr_t get(uint64_t p_recorded) const {
+		auto it = handles.find(p_recorded);
+		return it != handles.end() ? it->second : 0;
+	}
+	bool take(uint64_t p_recorded, uintptr_t &r_handle) {
+		auto it = handles.find(p_recorded);
+		if (it == handles.end()) return false;
+		r_handle = it->second;
+		handles.erase(it);
+		return true;
+	}
+};
+
+}
+
+bool RenderCapturePlayer::load(std::vector<uint8_t> p_data) {
+	data = std::move(p_data);
+
+	CaptureReader reader(data.data(), data.size());
+	uint32_t magic = reader.read<uint32_t>();
+	uint32_t version = reader.read<uint32_t>();
+	size = reader.read<Rml::Vector2i>();
+
+	if (reader.has_failed() || magic != RENDER_CAPTURE_MAGIC) {
+		Rml::Log::Message(Rml::Log::LT_ERROR, "Not a render capture");
+		data.clear();
+		return false;
+	}
+	if (version != RENDER_CAPTURE_VERSION) {
+		Rml::Log::Message(Rml::Log::LT_ERROR, "Unsupported render capture version %u, expected %u", version, RENDER_CAPTURE_VERSION);
+		data.clear();
+		return false;
+	}
+
+	commands_offset = sizeof(uint32_t) * 2 + sizeof(Rml::Vector2i);
+	return true;
+}
+
+int64_t RenderCapturePlayer::replay(Rml::RenderInterface *p_target) const {
+	if (data.empty()) return -1;
+
+	CaptureReader reader(data.data() + commands_offset, data.size() - commands_offset);
+	HandleMap geometries, textures, layers, filters, shaders;
+	std::vector<Rml::CompiledFilterHandle> composite_filters;
+	int64_t command_count = 0;
+
+	while (!reader.at_end() && !reader.has_failed()) {
+		uint8_t command = reader.read<uint8_t>();
+
+		switch (command) {
+			case CAPTURE_COMPILE_GEOMETRY: {
+				uint64_t recorded = reader.read<uint64_t>();
+				uint32_t vertex_count = reader.read<uint32_t>();
+				uint32_t index_count = reader.read<uint32_t>();
+				const uint8_t *vertices = reader.read_data(vertex_count * sizeof(Rml::Vertex));
+				const uint8_t *indices = reader.read_data(index_count * sizeof(int));
+				if (reader.has_failed()) break;
+
+				// The stream holds no alignment guarantees, copy before handing spans over
+				std::vector<Rml::Vertex> vertex_data(vertex_count);
+				std::vector<int> index_data(index_count);
+				memcpy(vertex_data.data(), vertices, vertex_count * sizeof(Rml::Vertex));
+				memcpy(index_data.data(), indices, index_count * sizeof(int));
+				geometries.add(recorded, p_target->CompileGeometry(vertex_data, index_data));
+			} break;
+			case CAPTURE_RENDER_GEOMETRY: {
+				uint64_t geometry = reader.read<uint64_t>();
+				Rml::Vector2f translation = reader.read<Rml::Vector2f>();
+				uint64_t texture = reader.read<uint64_t>();
+				uintptr_t handle = geometries.get(geometry);
+				if (handle != 0) {
+					p_target->RenderGeometry(handle, translation, textures.get(texture));
+				}
+			} break;
+			case CAPTURE_RELEASE_GEOMETRY: {
+				uintptr_t handle;
+				if (geometries.take(reader.read<uint64_t>(), handle)) {
+					p_target->ReleaseGeometry(handle);
+				}
+			} break;
+			case CAPTURE_LOAD_TEXTURE: {
+				uint64_t recorded = reader.read<uint64_t>();
+				Rml::String source = reader.read_string();
+				Rml::Vector2i dimensions;
+				textures.add(recorded, p_target->LoadTexture(dimensions, source));
+			} break;
+			case CAPTURE_GENERATE_TEXTURE: {
+				uint64_t recorded = reader.read<uint64_t>();
+				Rml::Vector2i dimensions = reader.read<Rml::Vector2i>();
+				uint32_t byte_count = reader.read<uint32_t>();
+				const uint8_t *bytes = reader.read_data(byte_count);
+				if (reader.has_failed()) break;
+				textures.add(recorded, p_target->GenerateTexture({ bytes, byte_count }, dimensions));
+			} break;
+			case CAPTURE_RELEASE_TEXTURE: {
+				uintptr_t handle;
+				if (textures.take(reader.read<uint64_t>(), handle)) {
+					p_target->ReleaseTexture(handle);
+				}
+			} break;
+			case CAPTURE_ENABLE_SCISSOR_REGION: {
+				p_target->EnableScissorRegion(reader.read<uint8_t>() != 0);
+			} break;
+			case CAPTURE_SET_SCISSOR_REGION: {
+				Rml::Vector2i position = reader.read<Rml::Vector2i>();
+				Rml::Vector2i region_size = reader.read<Rml::Vector2i>();
+				p_target->SetScissorRegion(Rml::Rectanglei::FromPositionSize(position, region_size));
+			} break;
+			case CAPTURE_ENABLE_CLIP_MASK: {
+				p_target->EnableClipMask(reader.read<uint8_t>() != 0);
+			} break;
+			case CAPTURE_RENDER_TO_CLIP_MASK: {
+				Rml::ClipMaskOperation operation = (Rml::ClipMaskOperation)reader.read<uint8_t>();
+				uintptr_t handle = geometries.get(reader.read<uint64_t>());
+				Rml::Vector2f translation = reader.read<Rml::Vector2f>();
+				if (handle != 0) {
+					p_target->RenderToClipMask(operation, handle, translation);
+				}
+			} break;
+			case CAPTURE_SET_TRANSFORM: {
+				if (reader.read<uint8_t>() != 0) {
+					Rml::Matrix4f transform;
+					const uint8_t *matrix = reader.read_data(sizeof(float) * 16);
+					if (reader.has_failed()) break;
+					memcpy(transform.data(), matrix, sizeof(float) * 16);
+					p_target->SetTransform(&transform);
+				} else {
+					p_target->SetTransform(nullptr);
+				}
+			} break;
+			case CAPTURE_PUSH_LAYER: {
+				uint64_t recorded = reader.read<uint64_t>();
+				layers.add(recorded, p_target->PushLayer());
+			} break;
+			case CAPTURE_COMPOSITE_LAYERS: {
+				uint64_t source = reader.read<uint64_t>();
+				uint64_t destination = reader.read<uint64_t>();
+				Rml::BlendMode blend_mode = (Rml::BlendMode)reader.read<uint8_t>();
+				uint32_t filter_count = reader.read<uint32_t>();
+				composite_filters.clear();
+				for (uint32_t i = 0; i < filter_count && !reader.has_failed(); i++) {
+					uintptr_t handle = filters.get(reader.read<uint64_t>());
+					if (handle != 0) {
+						composite_filters.push_back(handle);
+					}
+				}
+				if (reader.has_failed()) break;
+				p_target->CompositeLayers(layers.get(source), layers.get(destination), blend_mode, composite_filters);
+			} break;
+			case CAPTURE_POP_LAYER: {
+				p_target->PopLayer();
+			} break;
+			case CAPTURE_SAVE_LAYER_AS_TEXTURE: {
+				uint64_t recorded = reader.read<uint64_t>();
+				textures.add(recorded, p_target->SaveLayerAsTexture());
+			} break;
+			case CAPTURE_SAVE_LAYER_AS_MASK_IMAGE: {
+				uint64_t recorded = reader.read<uint64_t>();
+				filters.add(recorded, p_target->SaveLayerAsMaskImage());
+			} break;
+			case CAPTURE_COMPILE_FILTER: {
+				uint64_t recorded = reader.read<uint64_t>();
+				Rml::String name = reader.read_string();
+				Rml::Dictionary parameters = reader.read_dictionary();
+				if (reader.has_failed()) break;
+				filters.add(recorded, p_target->CompileFilter(name, parameters));
+			} break;
+			case CAPTURE_RELEASE_FILTER: {
+				uintptr_t handle;
+				if (filters.take(reader.read<uint64_t>(), handle)) {
+					p_target->ReleaseFilter(handle);
+				}
+			} break;
+			case CAPTURE_COMPILE_SHADER: {
+				uint64_t recorded = reader.read<uint64_t>();
+				Rml::String name = reader.read_string();
+				Rml::Dictionary parameters = reader.read_dictionary();
+				if (reader.has_failed()) break;
+				shaders.add(recorded, p_target->CompileShader(name, parameters));
+			} break;
+			case CAPTURE_RENDER_SHADER: {
+				uintptr_t shader = shaders.get(reader.read<uint64_t>());
+				uintptr_t geometry = geometries.get(reader.read<uint64_t>());
+				Rml::Vector2f translation = reader.read<Rml::Vector2f>();
+				uintptr_t texture = textures.get(reader.read<uint64_t>());
+				if (shader != 0 && geometry != 0) {
+					p_target->RenderShader(shader, geometry, translation, texture);
+				}
+			} break;
+			case CAPTURE_RELEASE_SHADER: {
+				uintptr_t handle;
+				if (shaders.take(reader.read<uint64_t>(), handle)) {
+					p_target->ReleaseShader(handle);
+				}
+			} break;
+			default: {
+				Rml::Log::Message(Rml::Log::LT_ERROR, "Unknown render capture command %d", command);
+				reader.read_data(SIZE_MAX);
+			} break;
+		}
+
+		command_count++;
+	}
+
+	// Leave the target as it was before the replay
+	for (const auto &it : geometries.handles) {
+		if (it.second != 0) p_target->ReleaseGeometry(it.second);
+	}
+	for (const auto &it : textures.handles) {
+		if (it.second != 0) p_target->ReleaseTexture(it.second);
+	}
+	for (const auto &it : filters.handles) {
+		if (it.second != 0) p_target->ReleaseFilter(it.second);
+	}
+	for (const auto &it : shaders.handles) {
+		if (it.second != 0) p_target->ReleaseShader(it.second);
+	}
+
+	if (reader.has_failed()) {
+		Rml::Log::Message(Rml::Log::LT_ERROR, "Render capture is truncated or malformed");
+		return -1;
+	}
+	return command_count;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <RmlUi/Core/RenderInterface.h>
+#include <RmlUi/Core/Dictionary.h>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Binary capture of the render calls RmlUi makes, and its playback into any render interface.
+// Only depends on RmlUi, so tools outside of Godot (see benchmarks/) can replay captures too.
+//
+// A capture starts with RENDER_CAPTURE_MAGIC, the format version and the context size, followed
+// by commands made of a RenderCaptureCommand byte and its arguments, in native byte order.
+// Handles are stored as recorded and remapped to the ones the target returns on playback.
+
+const uint32_t RENDER_CAPTURE_MAGIC = 0x434c4d52; // "RMLC"
+const uint32_t RENDER_CAPTURE_VERSION = 1;
+
+enum RenderCaptureCommand : uint8_t {
+	CAPTURE_COMPILE_GEOMETRY,
+	CAPTURE_RENDER_GEOMETRY,
+	CAPTURE_RELEASE_GEOMETRY,
+	CAPTURE_LOAD_TEXTURE,
+	CAPTURE_GENERATE_TEXTURE,
+	CAPTURE_RELEASE_TEXTURE,
+	CAPTURE_ENABLE_SCISSOR_REGION,
+	CAPTURE_SET_SCISSOR_REGION,
+	CAPTURE_ENABLE_CLIP_MASK,
+	CAPTURE_RENDER_TO_CLIP_MASK,
+	CAPTURE_SET_TRANSFORM,
+	CAPTURE_PUSH_LAYER,
+	CAPTURE_COMPOSITE_LAYERS,
+	CAPTURE_POP_LAYER,
+	CAPTURE_SAVE_LAYER_AS_TEXTURE,
+	CAPTURE_SAVE_LAYER_AS_MASK_IMAGE,
+	CAPTURE_COMPILE_FILTER,
+	CAPTURE_RELEASE_FILTER,
+	CAPTURE_COMPILE_SHADER,
+	CAPTURE_RENDER_SHADER,
+	CAPTURE_RELEASE_SHADER,
+	CAPTURE_COMMAND_MAX
+};
+
+// Forwards every call to the target render interface, recording them between begin() and end()
+class RenderCaptureInterface: public Rml::RenderInterface {
+	struct CompiledProgram {
+		Rml::String name;
+		Rml::Dictionary parameters;
+	};
+
+	struct GeometryPayload {
+		std::vector<Rml::Vertex> vertices;
+		std::vector<int> indices;
+	};
+
+	// Either loaded from source or generated from data
+	struct TexturePayload {
+		bool loaded = false;
+		Rml::String source;
+		Rml::Vector2i dimensions;
+		std::vector<Rml::byte> data;
+	};
+
+	Rml::RenderInterface *target = nullptr;
+
+	bool recording = false;
+	std::vector<uint8_t> stream;
+
+	// Geometry, textures, filters and shaders outlive frames, the ones alive when a capture begins
+	// are recorded first. Textures saved from layers can't be recreated and aren't tracked
+	std::map<uintptr_t, GeometryPayload> geometries;
+	std::map<uintptr_t, TexturePayload> textures;
+	std::map<uintptr_t, CompiledProgram> filters;
+	std::map<uintptr_t, CompiledProgram> shaders;
+
+	void write_command(RenderCaptureCommand p_command);
+	void write_data(const void *p_data, size_t p_size);
+	template <typename T>
+	void write(const T &p_value) { write_data(&p_value, sizeof(T)); }
+	void write_string(const Rml::String &p_string);
+	void write_dictionary(const Rml::Dictionary &p_dictionary);
+	void write_compile_geometry(uintptr_t p_handle, Rml::Span<const Rml::Vertex> p_vertices, Rml::Span<const int> p_indices);
+	void write_load_texture(uintptr_t p_handle, const Rml::String &p_source);
+	void write_generate_texture(uintptr_t p_handle, Rml::Span<const Rml::byte> p_source, Rml::Vector2i p_dimensions);
+	void write_compile_program(RenderCaptureCommand p_command, uintptr_t p_handle, const CompiledProgram &p_program);
+
+public:
+	void set_target(Rml::RenderInterface *p_target) { target = p_target; }
+	Rml::RenderInterface *get_target() const { return target; }
+
+	void begin(Rml::Vector2i p_size);
+	std::vector<uint8_t> end();
+	bool is_recording() const { return recording; }
+
+	Rml::CompiledGeometryHandle CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) override;
+	void RenderGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) override;
+	void ReleaseGeometry(Rml::CompiledGeometryHandle geometry) override;
+
+	Rml::TextureHandle LoadTexture(Rml::Vector2i& texture_dimensions, const Rml::String& source) override;
+	Rml::TextureHandle GenerateTexture(Rml::Span<const Rml::byte> source, Rml::Vector2i source_dimensions) override;
+	void ReleaseTexture(Rml::TextureHandle texture) override;
+
+	void EnableScissorRegion(bool enable) override;
+	void SetScissorRegion(Rml::Rectanglei region) override;
+
+	void EnableClipMask(bool enable) override;
+	void RenderToClipMask(Rml::ClipMaskOperation operation, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation) override;
+
+	void SetTransform(const Rml::Matrix4f* transform) override;
+
+	Rml::LayerHandle PushLayer() override;
+	void CompositeLayers(Rml::LayerHandle source, Rml::LayerHandle destination, Rml::BlendMode blend_mode, Rml::Span<const Rml::CompiledFilterHandle> filters) override;
+	void PopLayer() override;
+
+	Rml::TextureHandle SaveLayerAsTexture() override;
+	Rml::CompiledFilterHandle SaveLayerAsMaskImage() override;
+
+	Rml::CompiledFilterHandle CompileFilter(const Rml::String& name, const Rml::Dictionary& parameters) override;
+	void ReleaseFilter(Rml::CompiledFilterHandle filter) override;
+
+	Rml::CompiledShaderHandle CompileShader(const Rml::String& name, const Rml::Dictionary& parameters) override;
+	void RenderShader(Rml::CompiledShaderHandle shader, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) override;
+	void ReleaseShader(Rml::CompiledShaderHandle shader) override;
+};
+
+// Plays a capture back into a render interface, between the target's own frame setup and
+// teardown. Everything the capture creates and doesn't release is released at the end
+class RenderCapturePlayer {
+	std::vector<uint8_t> data;
+	Rml::Vector2i size;
+	size_t commands_offset = 0;
+
+public:
+	bool load(std::vector<uint8_t> p_data);
+	Rml::Vector2i get_size() const { return size; }
+
+	// Returns the number of commands replayed, or -1 if the capture is malformed
+	int64_t replay(Rml::RenderInterface *p_target) const;
+};
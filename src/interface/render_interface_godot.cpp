@@ -3,6 +3,7 @@
 
 using namespace godot;
 
+RenderInterfaceGodot *RenderInterfaceGodot::singleton = nullptr;
 
 #ifdef DEBUG_ENABLED
 void RenderInterfaceGodot::clear_debug_commands() {
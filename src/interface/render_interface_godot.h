@@ -1,10 +1,14 @@
 #pragma once
 #include <godot_cpp/variant/rid.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
 #include <godot_cpp/variant/vector2i.hpp>
 #include <godot_cpp/variant/packed_string_array.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
+#include <godot_cpp/classes/image.hpp>
 #include <RmlUi/Core/RenderInterface.h>
 
+#include "render_capture.h"
+
 namespace godot {
 
 class RMLServer;
@@ -16,24 +20,57 @@ class RMLServer;
 #endif
 
 class RenderInterfaceGodot: public Rml::RenderInterface {
+public:
+    // Running totals since initialization, RMLServer attributes the difference to each context
+    struct RenderStats {
+        uint64_t render_passes = 0;
+        uint64_t draw_calls = 0;
+        uint64_t geometry_compiled = 0;
+        uint64_t geometry_released = 0;
+        uint64_t textures_generated = 0;
+        uint64_t layers_pushed = 0;
+        // Times a buffer reused to record and submit passes had to grow, zero once warmed up
+        uint64_t submission_allocations = 0;
+    };
+
 private:
+    static RenderInterfaceGodot *singleton;
+
 #ifdef DEBUG_ENABLED
     PackedStringArray debug_commands;
 #endif
 
+    // Installed in front of this interface when render captures are enabled
+    RenderCaptureInterface *capture = nullptr;
+
 protected:
+    RenderStats stats;
+
     void clear_debug_commands();
     void push_debug_command(const String &p_command);
     void flush_debug_commands();
 
 public:
+    // The renderer in use, RmlUi's render interface may be a capture forwarding to it
+    static RenderInterfaceGodot *get_singleton() { return singleton; }
+    static void set_singleton(RenderInterfaceGodot *p_singleton) { singleton = p_singleton; }
+
+    void set_capture(RenderCaptureInterface *p_capture) { capture = p_capture; }
+    RenderCaptureInterface *get_capture() const { return capture; }
+
     virtual void initialize() = 0;
     virtual void finalize() = 0;
 
-    virtual void push_context(void *&p_ctx, const Vector2i &p_size) = 0;
+    virtual void push_context(void *&p_ctx, const Vector2i &p_size, bool p_incremental = false, bool p_direct = false) = 0;
     virtual void pop_context() = 0;
     virtual void draw_context(void *&p_ctx, const RID &p_canvas_item) = 0;
     virtual void free_context(void *&p_ctx) = 0;
+    // Last frame rendered by the context with straight alpha, if the renderer can read it back
+    virtual Ref<Image> get_context_image(void *&p_ctx) { return Ref<Image>(); }
+    // GPU time of the last measured frame of the context by pass kind, in microseconds, if the renderer profiles it
+    virtual Dictionary get_context_gpu_times(void *&p_ctx) { return Dictionary(); }
+
+    const RenderStats &get_stats() const { return stats; }
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,882 @@
+#include "software_render_interface_godot.h"
+#include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/texture2d.hpp>
+#include <godot_cpp/core/math.hpp>
+
+#include <RmlUi/Core/Dictionary.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "../rml_util.h"
+
+using namespace godot;
+
+// Kernels are cut off at this many standard deviations
+const float BLUR_KERNEL_EXTENT = 3.0f;
+
+static inline uint32_t pack_color(float r, float g, float b, float a) {
+    return
+        ((uint32_t)(CLAMP(a, 0.0f, 1.0f) * 255.0f + 0.5f) << 24) |
+        ((uint32_t)(CLAMP(r, 0.0f, 1.0f) * 255.0f + 0.5f) << 16) |
+        ((uint32_t)(CLAMP(g, 0.0f, 1.0f) * 255.0f + 0.5f) << 8) |
+        ((uint32_t)(CLAMP(b, 0.0f, 1.0f) * 255.0f + 0.5f));
+}
+
+static inline void unpack_color(uint32_t p_pixel, float r_color[4]) {
+    r_color[0] = ((p_pixel >> 16) & 0xff) / 255.0f;
+    r_color[1] = ((p_pixel >> 8) & 0xff) / 255.0f;
+    r_color[2] = (p_pixel & 0xff) / 255.0f;
+    r_color[3] = (p_pixel >> 24) / 255.0f;
+}
+
+// Premultiplied source over destination
+static inline void blend_pixel(uint32_t &r_dst, const float p_src[4]) {
+    if (p_src[3] <= 0.0f && p_src[0] <= 0.0f && p_src[1] <= 0.0f && p_src[2] <= 0.0f) return;
+
+    float dst[4];
+    unpack_color(r_dst, dst);
+    float inv_alpha = 1.0f - p_src[3];
+    r_dst = pack_color(
+        p_src[0] + dst[0] * inv_alpha,
+        p_src[1] + dst[1] * inv_alpha,
+        p_src[2] + dst[2] * inv_alpha,
+        p_src[3] + dst[3] * inv_alpha
+    );
+}
+
+static inline uint32_t *surface_row(plutovg_surface_t *p_surface, int p_y) {
+    return (uint32_t *)(plutovg_surface_get_data(p_surface) + p_y * plutovg_surface_get_stride(p_surface));
+}
+
+plutovg_surface_t *SoftwareRenderInterfaceGodot::create_surface(const Vector2i &p_size) {
+    plutovg_surface_t *surface = plutovg_surface_create(MAX(p_size.x, 1), MAX(p_size.y, 1));
+    ERR_FAIL_NULL_V_MSG(surface, nullptr, "Couldn't allocate the surface");
+    return surface;
+}
+
+void SoftwareRenderInterfaceGodot::destroy_surface(plutovg_surface_t *&p_surface) {
+    if (p_surface != nullptr) {
+        plutovg_surface_destroy(p_surface);
+        p_surface = nullptr;
+    }
+}
+
+void SoftwareRenderInterfaceGodot::copy_surface(plutovg_surface_t *p_dst, plutovg_surface_t *p_src, const Rect2i &p_region) {
+    for (int y = p_region.position.y; y < p_region.get_end().y; y++) {
+        memcpy(
+            surface_row(p_dst, y) + p_region.position.x,
+            surface_row(p_src, y) + p_region.position.x,
+            p_region.size.x * sizeof(uint32_t)
+        );
+    }
+}
+
+void SoftwareRenderInterfaceGodot::composite_surface(plutovg_surface_t *p_dst, plutovg_surface_t *p_src, plutovg_operator_t p_op, const Rect2i &p_region, const Vector2i &p_offset) {
+    plutovg_canvas_t *canvas = plutovg_canvas_create(p_dst);
+
+    plutovg_matrix_t matrix;
+    plutovg_matrix_init_translate(&matrix, p_offset.x, p_offset.y);
+    plutovg_canvas_set_texture(canvas, p_src, PLUTOVG_TEXTURE_TYPE_PLAIN, 1.0f, &matrix);
+    plutovg_canvas_set_operator(canvas, p_op);
+    plutovg_canvas_fill_rect(canvas, p_region.position.x, p_region.position.y, p_region.size.x, p_region.size.y);
+
+    plutovg_canvas_destroy(canvas);
+}
+
+void SoftwareRenderInterfaceGodot::allocate_context(Context *p_ctx, const Vector2i &p_size) {
+    if (p_ctx->size == p_size) return;
+    free_context(p_ctx);
+
+    p_ctx->size = p_size;
+    p_ctx->layers.push_back(create_surface(p_size));
+    p_ctx->filter_buffer = create_surface(p_size);
+    p_ctx->shadow_buffer = create_surface(p_size);
+    p_ctx->clip_mask = create_surface(p_size);
+    p_ctx->clip_buffer = create_surface(p_size);
+}
+
+void SoftwareRenderInterfaceGodot::free_context(Context *p_ctx) {
+    for (plutovg_surface_t *&layer : p_ctx->layers) {
+        destroy_surface(layer);
+    }
+    p_ctx->layers.clear();
+    p_ctx->layer_ptr = 0;
+
+    destroy_surface(p_ctx->filter_buffer);
+    destroy_surface(p_ctx->shadow_buffer);
+    destroy_surface(p_ctx->clip_mask);
+    destroy_surface(p_ctx->clip_buffer);
+
+    p_ctx->size = Vector2i();
+    p_ctx->has_frame = false;
+}
+
+plutovg_surface_t *SoftwareRenderInterfaceGodot::get_layer() {
+    return context->layers[context->layer_ptr];
+}
+
+Rect2i SoftwareRenderInterfaceGodot::get_draw_region() const {
+    Rect2i region = Rect2i(Vector2i(), context->size);
+    if (scissor_enabled) {
+        region = region.intersection(scissor_region);
+    }
+    return region;
+}
+
+void SoftwareRenderInterfaceGodot::initialize() {
+    // Surfaces hold premultiplied colors, drawn into the canvas as is
+    premultiplied_material.instantiate();
+    premultiplied_material->set_blend_mode(CanvasItemMaterial::BLEND_MODE_PREMULT_ALPHA);
+}
+
+void SoftwareRenderInterfaceGodot::finalize() {
+    premultiplied_material.unref();
+}
+
+void SoftwareRenderInterfaceGodot::push_context(void *&p_ctx, const Vector2i &p_size, bool p_incremental, bool p_direct) {
+    Context *ctx = static_cast<Context *>(p_ctx);
+    if (ctx == nullptr) {
+        ctx = memnew(Context);
+        p_ctx = ctx;
+    }
+    context = ctx;
+
+    // Frames are always fully redrawn, and there's no canvas geometry to draw directly
+    allocate_context(ctx, p_size);
+
+    context->layer_ptr = 0;
+    plutovg_surface_clear(get_layer(), nullptr);
+
+    scissor_enabled = false;
+    clip_mask_enabled = false;
+    drawing_matrix = Rml::Matrix4f::Identity();
+    has_transform = false;
+
+    clear_debug_commands();
+}
+
+void SoftwareRenderInterfaceGodot::pop_context() {
+    ERR_FAIL_COND_MSG(context->layer_ptr != 0, "Layers must be popped before finishing rendering");
+    context->has_frame = true;
+
+    flush_debug_commands();
+    context = nullptr;
+}
+
+void SoftwareRenderInterfaceGodot::read_pixels(Context *p_ctx, PackedByteArray &r_data, bool p_premultiplied) const {
+    Vector2i size = p_ctx->size;
+    r_data.resize(size.x * size.y * 4);
+    uint8_t *ptrw = r_data.ptrw();
+
+    for (int y = 0; y < size.y; y++) {
+        const uint32_t *row = surface_row(p_ctx->layers[0], y);
+        for (int x = 0; x < size.x; x++) {
+            uint32_t pixel = row[x];
+            uint32_t a = pixel >> 24;
+            uint32_t r = (pixel >> 16) & 0xff;
+            uint32_t g = (pixel >> 8) & 0xff;
+            uint32_t b = pixel & 0xff;
+            if (!p_premultiplied && a > 0 && a < 255) {
+                r = MIN(255u, (r * 255 + a / 2) / a);
+                g = MIN(255u, (g * 255 + a / 2) / a);
+                b = MIN(255u, (b * 255 + a / 2) / a);
+            }
+            ptrw[0] = r;
+            ptrw[1] = g;
+            ptrw[2] = b;
+            ptrw[3] = a;
+            ptrw += 4;
+        }
+    }
+}
+
+void SoftwareRenderInterfaceGodot::draw_context(void *&p_ctx, const RID &p_canvas_item) {
+    Context *ctx = static_cast<Context *>(p_ctx);
+    ERR_FAIL_NULL(ctx);
+    if (!ctx->has_frame) return;
+
+    RenderingServer *rs = RenderingServer::get_singleton();
+    Vector2i size = ctx->size;
+
+    read_pixels(ctx, ctx->image_data, true);
+    Ref<Image> image = Image::create_from_data(size.x, size.y, false, Image::FORMAT_RGBA8, ctx->image_data);
+    if (ctx->texture.is_null() || ctx->texture->get_size() != Vector2(size)) {
+        ctx->texture = ImageTexture::create_from_image(image);
+    } else {
+        ctx->texture->update(image);
+    }
+
+    if (!ctx->canvas_item.is_valid()) {
+        ctx->canvas_item = rs->canvas_item_create();
+        rs->canvas_item_set_material(ctx->canvas_item, premultiplied_material->get_rid());
+    }
+    rs->canvas_item_clear(ctx->canvas_item);
+    rs->canvas_item_set_parent(ctx->canvas_item, p_canvas_item);
+    rs->canvas_item_add_texture_rect(ctx->canvas_item, Rect2(0, 0, size.x, size.y), ctx->texture->get_rid());
+}
+
+void SoftwareRenderInterfaceGodot::free_context(void *&p_ctx) {
+    Context *ctx = static_cast<Context *>(p_ctx);
+    if (ctx == nullptr) return;
+
+    if (ctx->canvas_item.is_valid()) {
+        RenderingServer::get_singleton()->free_rid(ctx->canvas_item);
+    }
+    free_context(ctx);
+    memdelete(ctx);
+
+    p_ctx = nullptr;
+}
+
+Ref<Image> SoftwareRenderInterfaceGodot::get_context_image(void *&p_ctx) {
+    Context *ctx = static_cast<Context *>(p_ctx);
+    if (ctx == nullptr || !ctx->has_frame) {
+        return Ref<Image>();
+    }
+
+    PackedByteArray data;
+    read_pixels(ctx, data, false);
+    return Image::create_from_data(ctx->size.x, ctx->size.y, false, Image::FORMAT_RGBA8, data);
+}
+
+void SoftwareRenderInterfaceGodot::transform_vertices(const MeshData *p_mesh_data, Rml::Vector2f p_translation) {
+    raster_vertices.resize(p_mesh_data->vertices.size());
+
+    for (size_t i = 0; i < p_mesh_data->vertices.size(); i++) {
+        const Rml::Vertex &vertex = p_mesh_data->vertices[i];
+        RasterVertex &raster = raster_vertices[i];
+
+        Rml::Vector2f position = vertex.position + p_translation;
+        if (has_transform) {
+            // Same projection as geometry.glsl, which takes xy without dividing by w
+            Rml::Vector4f projected = drawing_matrix * Rml::Vector4f(position.x, position.y, 0.0f, 1.0f);
+            position = Rml::Vector2f(projected.x, projected.y);
+        }
+
+        raster.x = position.x;
+        raster.y = position.y;
+        raster.r = vertex.colour.red / 255.0f;
+        raster.g = vertex.colour.green / 255.0f;
+        raster.b = vertex.colour.blue / 255.0f;
+        raster.a = vertex.colour.alpha / 255.0f;
+        raster.u = vertex.tex_coord.x;
+        raster.v = vertex.tex_coord.y;
+    }
+}
+
+template <typename F>
+void SoftwareRenderInterfaceGodot::rasterize(const MeshData *p_mesh_data, const Rect2i &p_region, F p_shade) {
+    const std::vector<int> &indices = p_mesh_data->indices;
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const RasterVertex *v[3] = {
+            &raster_vertices[indices[i]],
+            &raster_vertices[indices[i + 1]],
+            &raster_vertices[indices[i + 2]]
+        };
+
+        float area = (v[1]->x - v[0]->x) * (v[2]->y - v[0]->y) - (v[1]->y - v[0]->y) * (v[2]->x - v[0]->x);
+        if (area == 0.0f) continue;
+        // Same orientation for every triangle, so the fill rule below holds
+        if (area < 0.0f) {
+            std::swap(v[1], v[2]);
+            area = -area;
+        }
+        float inv_area = 1.0f / area;
+
+        int min_x = MAX(p_region.position.x, (int)Math::floor(MIN(v[0]->x, MIN(v[1]->x, v[2]->x))));
+        int min_y = MAX(p_region.position.y, (int)Math::floor(MIN(v[0]->y, MIN(v[1]->y, v[2]->y))));
+        int max_x = MIN(p_region.get_end().x, (int)Math::ceil(MAX(v[0]->x, MAX(v[1]->x, v[2]->x))));
+        int max_y = MIN(p_region.get_end().y, (int)Math::ceil(MAX(v[0]->y, MAX(v[1]->y, v[2]->y))));
+
+        for (int y = min_y; y < max_y; y++) {
+            float py = y + 0.5f;
+            for (int x = min_x; x < max_x; x++) {
+                float px = x + 0.5f;
+
+                float w[3];
+                bool inside = true;
+                for (int e = 0; e < 3 && inside; e++) {
+                    // Edge opposite to vertex e
+                    const RasterVertex *a = v[(e + 1) % 3];
+                    const RasterVertex *b = v[(e + 2) % 3];
+                    float dx = b->x - a->x;
+                    float dy = b->y - a->y;
+                    float edge = dx * (py - a->y) - dy * (px - a->x);
+                    // Pixels on an edge shared by two triangles belong to only one of them
+                    inside = edge > 0.0f || (edge == 0.0f && (dy < 0.0f || (dy == 0.0f && dx > 0.0f)));
+                    w[e] = edge * inv_area;
+                }
+                if (!inside) continue;
+
+                p_shade(x, y, w, v);
+            }
+        }
+    }
+}
+
+void SoftwareRenderInterfaceGodot::fill_mask(plutovg_surface_t *p_surface, const MeshData *p_mesh_data, uint32_t p_value) {
+    rasterize(p_mesh_data, get_draw_region(), [&](int x, int y, const float *w, const RasterVertex *const *v) {
+        surface_row(p_surface, y)[x] = p_value;
+    });
+}
+
+uint32_t SoftwareRenderInterfaceGodot::sample_texture(const TextureData *p_texture, float p_u, float p_v) {
+    plutovg_surface_t *surface = p_texture->surface;
+    int width = plutovg_surface_get_width(surface);
+    int height = plutovg_surface_get_height(surface);
+
+    if (!p_texture->linear_filtering) {
+        int x = CLAMP((int)Math::floor(p_u * width), 0, width - 1);
+        int y = CLAMP((int)Math::floor(p_v * height), 0, height - 1);
+        return surface_row(surface, y)[x];
+    }
+
+    // Bilinear with repeat, as the RenderingDevice sampler
+    float fx = p_u * width - 0.5f;
+    float fy = p_v * height - 0.5f;
+    int x0 = (int)Math::floor(fx);
+    int y0 = (int)Math::floor(fy);
+    float tx = fx - x0;
+    float ty = fy - y0;
+
+    auto fetch = [&](int x, int y, float r_color[4]) {
+        x = ((x % width) + width) % width;
+        y = ((y % height) + height) % height;
+        unpack_color(surface_row(surface, y)[x], r_color);
+    };
+
+    float c00[4], c10[4], c01[4], c11[4];
+    fetch(x0, y0, c00);
+    fetch(x0 + 1, y0, c10);
+    fetch(x0, y0 + 1, c01);
+    fetch(x0 + 1, y0 + 1, c11);
+
+    float c[4];
+    for (int i = 0; i < 4; i++) {
+        float top = c00[i] + (c10[i] - c00[i]) * tx;
+        float bottom = c01[i] + (c11[i] - c01[i]) * tx;
+        c[i] = top + (bottom - top) * ty;
+    }
+    return pack_color(c[0], c[1], c[2], c[3]);
+}
+
+void SoftwareRenderInterfaceGodot::gradient_color(const ShaderInfo *p_shader, float p_u, float p_v, float r_color[4]) {
+    // Same as shaders/gradient.glsl
+    float t = 0.0f;
+    Rml::Vector2f d = Rml::Vector2f(p_u, p_v) - p_shader->p;
+
+    if (p_shader->type == GRADIENT_LINEAR) {
+        float dsq = p_shader->v.x * p_shader->v.x + p_shader->v.y * p_shader->v.y;
+        t = (p_shader->v.x * d.x + p_shader->v.y * d.y) / dsq;
+    } else if (p_shader->type == GRADIENT_RADIAL) {
+        Rml::Vector2f scaled = Rml::Vector2f(p_shader->v.x * d.x, p_shader->v.y * d.y);
+        t = Math::sqrt(scaled.x * scaled.x + scaled.y * scaled.y);
+    } else if (p_shader->type == GRADIENT_CONIC) {
+        Rml::Vector2f r = Rml::Vector2f(
+            p_shader->v.x * d.x + p_shader->v.y * d.y,
+            -p_shader->v.y * d.x + p_shader->v.x * d.y
+        );
+        t = 0.5f + Math::atan2(-r.x, r.y) / (float)Math_TAU;
+    }
+
+    const Rml::ColorStopList &stops = p_shader->stops;
+    if (p_shader->repeating && stops.size() > 1) {
+        float t0 = stops.front().position.number;
+        float t1 = stops.back().position.number;
+        float length = t1 - t0;
+        if (length > 0.0f) {
+            t = t0 + Math::fposmod(t - t0, length);
+        }
+    }
+
+    auto stop_color = [&](size_t i, float r_stop[4]) {
+        r_stop[0] = stops[i].color.red / 255.0f;
+        r_stop[1] = stops[i].color.green / 255.0f;
+        r_stop[2] = stops[i].color.blue / 255.0f;
+        r_stop[3] = stops[i].color.alpha / 255.0f;
+    };
+
+    stop_color(0, r_color);
+    for (size_t i = 1; i < stops.size(); i++) {
+        float c[4];
+        stop_color(i, c);
+        float s0 = stops[i - 1].position.number;
+        float s1 = stops[i].position.number;
+        float f = s1 > s0 ? CLAMP((t - s0) / (s1 - s0), 0.0f, 1.0f) : (t >= s1 ? 1.0f : 0.0f);
+        f = f * f * (3.0f - 2.0f * f);
+        for (int j = 0; j < 4; j++) {
+            r_color[j] += (c[j] - r_color[j]) * f;
+        }
+    }
+}
+
+Rml::CompiledGeometryHandle SoftwareRenderInterfaceGodot::CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) {
+    stats.geometry_compiled++;
+
+    MeshData *mesh_data = memnew(MeshData);
+    mesh_data->vertices.assign(vertices.begin(), vertices.end());
+    mesh_data->indices.assign(indices.begin(), indices.end());
+    return reinterpret_cast<uintptr_t>(mesh_data);
+}
+
+void SoftwareRenderInterfaceGodot::RenderGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) {
+    PUSH_DEBUG_COMMAND("RenderGeometry");
+    MeshData *mesh_data = reinterpret_cast<MeshData *>(geometry);
+    ERR_FAIL_NULL(mesh_data);
+
+    Rect2i region = get_draw_region();
+    if (!region.has_area()) return;
+    stats.draw_calls++;
+
+    transform_vertices(mesh_data, translation);
+    plutovg_surface_t *target = get_layer();
+    plutovg_surface_t *mask = clip_mask_enabled ? context->clip_mask : nullptr;
+    const TextureData *tex_data = reinterpret_cast<TextureData *>(texture);
+
+    rasterize(mesh_data, region, [&](int x, int y, const float *w, const RasterVertex *const *v) {
+        if (mask != nullptr && surface_row(mask, y)[x] == 0) return;
+
+        float color[4] = {
+            w[0] * v[0]->r + w[1] * v[1]->r + w[2] * v[2]->r,
+            w[0] * v[0]->g + w[1] * v[1]->g + w[2] * v[2]->g,
+            w[0] * v[0]->b + w[1] * v[1]->b + w[2] * v[2]->b,
+            w[0] * v[0]->a + w[1] * v[1]->a + w[2] * v[2]->a
+        };
+        if (tex_data != nullptr) {
+            float texel[4];
+            unpack_color(sample_texture(
+                tex_data,
+                w[0] * v[0]->u + w[1] * v[1]->u + w[2] * v[2]->u,
+                w[0] * v[0]->v + w[1] * v[1]->v + w[2] * v[2]->v
+            ), texel);
+            for (int i = 0; i < 4; i++) {
+                color[i] *= texel[i];
+            }
+        }
+        blend_pixel(surface_row(target, y)[x], color);
+    });
+}
+
+void SoftwareRenderInterfaceGodot::ReleaseGeometry(Rml::CompiledGeometryHandle geometry) {
+    MeshData *mesh_data = reinterpret_cast<MeshData *>(geometry);
+    ERR_FAIL_NULL(mesh_data);
+    stats.geometry_released++;
+
+    memdelete(mesh_data);
+}
+
+Rml::TextureHandle SoftwareRenderInterfaceGodot::LoadTexture(Rml::Vector2i& texture_dimensions, const Rml::String& source) {
+    Ref<Texture2D> tex = ResourceLoader::get_singleton()->load(rml_to_godot_string(source));
+    if (!tex.is_valid()) {
+        return 0;
+    }
+
+    Ref<Image> image = tex->get_image();
+    ERR_FAIL_COND_V_MSG(image.is_null(), 0, vformat("Couldn't read the image of '%s'", rml_to_godot_string(source)));
+    // The texture may hand out the image it keeps
+    image = image->duplicate();
+    if (image->is_compressed()) {
+        image->decompress();
+    }
+    image->convert(Image::FORMAT_RGBA8);
+
+    Vector2i size = image->get_size();
+    texture_dimensions.x = size.x;
+    texture_dimensions.y = size.y;
+
+    TextureData *tex_data = memnew(TextureData);
+    tex_data->surface = create_surface(size);
+
+    PackedByteArray data = image->get_data();
+    const uint8_t *ptr = data.ptr();
+    for (int y = 0; y < size.y; y++) {
+        uint32_t *row = surface_row(tex_data->surface, y);
+        for (int x = 0; x < size.x; x++) {
+            float a = ptr[3] / 255.0f;
+            row[x] = pack_color(ptr[0] / 255.0f * a, ptr[1] / 255.0f * a, ptr[2] / 255.0f * a, a);
+            ptr += 4;
+        }
+    }
+
+    return reinterpret_cast<uintptr_t>(tex_data);
+}
+
+Rml::TextureHandle SoftwareRenderInterfaceGodot::GenerateTexture(Rml::Span<const Rml::byte> source, Rml::Vector2i source_dimensions) {
+    Vector2i size = Vector2i(source_dimensions.x, source_dimensions.y);
+    ERR_FAIL_COND_V(source.size() < (size_t)size.x * size.y * 4, 0);
+    stats.textures_generated++;
+
+    TextureData *tex_data = memnew(TextureData);
+    tex_data->surface = create_surface(size);
+
+    // Generated textures already come premultiplied
+    const Rml::byte *ptr = source.data();
+    for (int y = 0; y < size.y; y++) {
+        uint32_t *row = surface_row(tex_data->surface, y);
+        for (int x = 0; x < size.x; x++) {
+            row[x] = ((uint32_t)ptr[3] << 24) | ((uint32_t)ptr[0] << 16) | ((uint32_t)ptr[1] << 8) | ptr[2];
+            ptr += 4;
+        }
+    }
+
+    return reinterpret_cast<uintptr_t>(tex_data);
+}
+
+void SoftwareRenderInterfaceGodot::ReleaseTexture(Rml::TextureHandle texture) {
+    TextureData *tex_data = reinterpret_cast<TextureData *>(texture);
+    ERR_FAIL_NULL(tex_data);
+
+    destroy_surface(tex_data->surface);
+    memdelete(tex_data);
+}
+
+void SoftwareRenderInterfaceGodot::EnableScissorRegion(bool enable) {
+    PUSH_DEBUG_COMMAND(vformat("EnableScissorRegion: %s", enable));
+    scissor_enabled = enable;
+}
+
+void SoftwareRenderInterfaceGodot::SetScissorRegion(Rml::Rectanglei region) {
+    PUSH_DEBUG_COMMAND(vformat(
+        "SetScissorRegion: (%d, %d, %d, %d)",
+        region.Position().x, region.Position().y,
+        region.Size().x, region.Size().y
+    ));
+    scissor_region = Rect2i(
+        region.Position().x,
+        region.Position().y,
+        region.Size().x,
+        region.Size().y
+    );
+}
+
+void SoftwareRenderInterfaceGodot::EnableClipMask(bool enable) {
+    PUSH_DEBUG_COMMAND(vformat("EnableClipMask: %s", enable));
+    clip_mask_enabled = enable;
+}
+
+void SoftwareRenderInterfaceGodot::RenderToClipMask(Rml::ClipMaskOperation operation, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation) {
+    PUSH_DEBUG_COMMAND("RenderToClipMask");
+    MeshData *mesh_data = reinterpret_cast<MeshData *>(geometry);
+    ERR_FAIL_NULL(mesh_data);
+    stats.draw_calls++;
+
+    transform_vertices(mesh_data, translation);
+
+    switch (operation) {
+        case Rml::ClipMaskOperation::Set: {
+            plutovg_surface_clear(context->clip_mask, nullptr);
+            fill_mask(context->clip_mask, mesh_data, 0xffffffff);
+        } break;
+        case Rml::ClipMaskOperation::SetInverse: {
+            plutovg_color_t white = { 1.0f, 1.0f, 1.0f, 1.0f };
+            plutovg_surface_clear(context->clip_mask, &white);
+            fill_mask(context->clip_mask, mesh_data, 0);
+        } break;
+        case Rml::ClipMaskOperation::Intersect: {
+            plutovg_surface_clear(context->clip_buffer, nullptr);
+            fill_mask(context->clip_buffer, mesh_data, 0xffffffff);
+            composite_surface(context->clip_mask, context->clip_buffer, PLUTOVG_OPERATOR_DST_IN, Rect2i(Vector2i(), context->size));
+        } break;
+    }
+}
+
+void SoftwareRenderInterfaceGodot::SetTransform(const Rml::Matrix4f* transform) {
+    PUSH_DEBUG_COMMAND(transform == nullptr ? "Clear transform" : "SetTransform");
+    has_transform = transform != nullptr;
+    drawing_matrix = has_transform ? *transform : Rml::Matrix4f::Identity();
+}
+
+Rml::LayerHandle SoftwareRenderInterfaceGodot::PushLayer() {
+    PUSH_DEBUG_COMMAND("PushLayer");
+    stats.layers_pushed++;
+
+    context->layer_ptr++;
+    if (context->layer_ptr == context->layers.size()) {
+        context->layers.push_back(create_surface(context->size));
+    }
+    plutovg_surface_clear(get_layer(), nullptr);
+
+    return context->layer_ptr;
+}
+
+void SoftwareRenderInterfaceGodot::CompositeLayers(Rml::LayerHandle source, Rml::LayerHandle destination, Rml::BlendMode blend_mode, Rml::Span<const Rml::CompiledFilterHandle> filters) {
+    PUSH_DEBUG_COMMAND(vformat("CompositeLayers: %d -> %d", source, destination));
+    ERR_FAIL_UNSIGNED_INDEX(source, context->layers.size());
+    ERR_FAIL_UNSIGNED_INDEX(destination, context->layers.size());
+
+    Rect2i region = get_draw_region();
+    if (!region.has_area()) return;
+    stats.render_passes++;
+
+    plutovg_surface_t *buffer = context->filter_buffer;
+    plutovg_surface_t *dst = context->layers[destination];
+
+    copy_surface(buffer, context->layers[source], region);
+    for (Rml::CompiledFilterHandle filter : filters) {
+        apply_filter(reinterpret_cast<FilterData *>(filter), region);
+    }
+
+    plutovg_operator_t op = PLUTOVG_OPERATOR_SRC_OVER;
+    if (clip_mask_enabled) {
+        composite_surface(buffer, context->clip_mask, PLUTOVG_OPERATOR_DST_IN, region);
+    }
+    if (blend_mode == Rml::BlendMode::Replace) {
+        // The mask is either fully opaque or transparent, so clearing the masked destination
+        // first and blending over it replaces exactly the masked pixels
+        if (clip_mask_enabled) {
+            composite_surface(dst, context->clip_mask, PLUTOVG_OPERATOR_DST_OUT, region);
+        } else {
+            op = PLUTOVG_OPERATOR_SRC;
+        }
+    }
+    composite_surface(dst, buffer, op, region);
+}
+
+void SoftwareRenderInterfaceGodot::PopLayer() {
+    PUSH_DEBUG_COMMAND("PopLayer");
+    ERR_FAIL_COND(context->layer_ptr == 0);
+    context->layer_ptr--;
+}
+
+Rml::TextureHandle SoftwareRenderInterfaceGodot::SaveLayerAsTexture() {
+    PUSH_DEBUG_COMMAND("SaveLayerAsTexture");
+    Rect2i region = get_draw_region();
+    ERR_FAIL_COND_V(!region.has_area(), 0);
+
+    TextureData *tex_data = memnew(TextureData);
+    tex_data->surface = create_surface(region.size);
+    tex_data->linear_filtering = false;
+
+    composite_surface(tex_data->surface, get_layer(), PLUTOVG_OPERATOR_SRC, Rect2i(Vector2i(), region.size), -region.position);
+
+    return reinterpret_cast<uintptr_t>(tex_data);
+}
+
+Rml::CompiledFilterHandle SoftwareRenderInterfaceGodot::SaveLayerAsMaskImage() {
+    PUSH_DEBUG_COMMAND("SaveLayerAsMaskImage");
+    FilterData *filter = memnew(FilterData);
+    filter->type = FILTER_MASK;
+    filter->mask = create_surface(context->size);
+
+    Rect2i region = get_draw_region();
+    if (region.has_area()) {
+        copy_surface(filter->mask, get_layer(), region);
+    }
+
+    return reinterpret_cast<uintptr_t>(filter);
+}
+
+void SoftwareRenderInterfaceGodot::apply_color_matrix(plutovg_surface_t *p_surface, const Rml::Matrix4f &p_matrix, const Rect2i &p_region) {
+    for (int y = p_region.position.y; y < p_region.get_end().y; y++) {
+        uint32_t *row = surface_row(p_surface, y);
+        for (int x = p_region.position.x; x < p_region.get_end().x; x++) {
+            float c[4];
+            unpack_color(row[x], c);
+            Rml::Vector4f result = p_matrix * Rml::Vector4f(c[0], c[1], c[2], c[3]);
+            row[x] = pack_color(result.x, result.y, result.z, result.w);
+        }
+    }
+}
+
+void SoftwareRenderInterfaceGodot::apply_blur(plutovg_surface_t *p_surface, float p_sigma, const Rect2i &p_region) {
+    if (p_sigma <= 0.0f) return;
+
+    int radius = (int)Math::ceil(p_sigma * BLUR_KERNEL_EXTENT);
+    std::vector<float> weights(radius + 1);
+    float total = 0.0f;
+    for (int i = 0; i <= radius; i++) {
+        weights[i] = Math::exp(-(i * i) / (2.0f * p_sigma * p_sigma));
+        total += i == 0 ? weights[i] : 2.0f * weights[i];
+    }
+    for (float &weight : weights) {
+        weight /= total;
+    }
+
+    // Separable, samples past the region count as transparent as on the GPU
+    Vector2i start = p_region.position;
+    Vector2i end = p_region.get_end();
+    std::vector<float> horizontal(p_region.size.x * p_region.size.y * 4);
+
+    for (int y = start.y; y < end.y; y++) {
+        const uint32_t *row = surface_row(p_surface, y);
+        for (int x = start.x; x < end.x; x++) {
+            float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int k = -radius; k <= radius; k++) {
+                if (x + k < start.x || x + k >= end.x) continue;
+                float c[4];
+                unpack_color(row[x + k], c);
+                float weight = weights[Math::abs(k)];
+                for (int i = 0; i < 4; i++) {
+                    sum[i] += c[i] * weight;
+                }
+            }
+            float *out = &horizontal[((y - start.y) * p_region.size.x + (x - start.x)) * 4];
+            memcpy(out, sum, sizeof(sum));
+        }
+    }
+
+    for (int y = start.y; y < end.y; y++) {
+        uint32_t *row = surface_row(p_surface, y);
+        for (int x = start.x; x < end.x; x++) {
+            float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int k = -radius; k <= radius; k++) {
+                if (y + k < start.y || y + k >= end.y) continue;
+                int sy = y + k - start.y;
+                const float *c = &horizontal[(sy * p_region.size.x + (x - start.x)) * 4];
+                float weight = weights[Math::abs(k)];
+                for (int i = 0; i < 4; i++) {
+                    sum[i] += c[i] * weight;
+                }
+            }
+            row[x] = pack_color(sum[0], sum[1], sum[2], sum[3]);
+        }
+    }
+}
+
+void SoftwareRenderInterfaceGodot::apply_drop_shadow(const FilterData *p_filter, const Rect2i &p_region) {
+    plutovg_surface_t *buffer = context->filter_buffer;
+    plutovg_surface_t *shadow = context->shadow_buffer;
+
+    // Offset silhouette of the layer, tinted with the shadow color
+    composite_surface(shadow, buffer, PLUTOVG_OPERATOR_SRC, p_region, p_filter->offset);
+
+    plutovg_canvas_t *canvas = plutovg_canvas_create(shadow);
+    plutovg_canvas_set_rgba(canvas,
+        p_filter->color.red / 255.0f,
+        p_filter->color.green / 255.0f,
+        p_filter->color.blue / 255.0f,
+        p_filter->color.alpha / 255.0f
+    );
+    plutovg_canvas_set_operator(canvas, PLUTOVG_OPERATOR_SRC_IN);
+    plutovg_canvas_fill_rect(canvas, p_region.position.x, p_region.position.y, p_region.size.x, p_region.size.y);
+    plutovg_canvas_destroy(canvas);
+
+    apply_blur(shadow, p_filter->sigma, p_region);
+
+    composite_surface(shadow, buffer, PLUTOVG_OPERATOR_SRC_OVER, p_region);
+    copy_surface(buffer, shadow, p_region);
+}
+
+void SoftwareRenderInterfaceGodot::apply_filter(const FilterData *p_filter, const Rect2i &p_region) {
+    ERR_FAIL_NULL(p_filter);
+
+    switch (p_filter->type) {
+        case FILTER_COLOR_MATRIX: {
+            apply_color_matrix(context->filter_buffer, p_filter->matrix, p_region);
+        } break;
+        case FILTER_BLUR: {
+            apply_blur(context->filter_buffer, p_filter->sigma, p_region);
+        } break;
+        case FILTER_DROP_SHADOW: {
+            apply_drop_shadow(p_filter, p_region);
+        } break;
+        case FILTER_MASK: {
+            composite_surface(context->filter_buffer, p_filter->mask, PLUTOVG_OPERATOR_DST_IN, p_region);
+        } break;
+    }
+}
+
+Rml::CompiledFilterHandle SoftwareRenderInterfaceGodot::CompileFilter(const Rml::String& name, const Rml::Dictionary& parameters) {
+    FilterData filter;
+
+    if (rml_filter_color_matrix(name, parameters, filter.matrix)) {
+        filter.type = FILTER_COLOR_MATRIX;
+    } else if (name == "blur") {
+        filter.type = FILTER_BLUR;
+        filter.sigma = Rml::Get(parameters, "sigma", 0.f);
+    } else if (name == "drop-shadow") {
+        const Rml::Colourb color = Rml::Get(parameters, "color", Rml::Colourb());
+        const Rml::Vector2f offset = Rml::Get(parameters, "offset", Rml::Vector2f());
+
+        filter.type = FILTER_DROP_SHADOW;
+        filter.sigma = Rml::Get(parameters, "sigma", 0.f);
+        filter.color = color;
+        filter.offset = Vector2i(Math::round(offset.x), Math::round(offset.y));
+    } else {
+        // Unsupported filters leave the layer untouched
+        filter.type = FILTER_COLOR_MATRIX;
+    }
+
+    FilterData *filter_data = memnew(FilterData(filter));
+    return reinterpret_cast<uintptr_t>(filter_data);
+}
+
+void SoftwareRenderInterfaceGodot::ReleaseFilter(Rml::CompiledFilterHandle filter) {
+    FilterData *filter_data = reinterpret_cast<FilterData *>(filter);
+    ERR_FAIL_NULL(filter_data);
+
+    destroy_surface(filter_data->mask);
+    memdelete(filter_data);
+}
+
+Rml::CompiledShaderHandle SoftwareRenderInterfaceGodot::CompileShader(const Rml::String& name, const Rml::Dictionary& parameters) {
+    ShaderInfo shader;
+    shader.repeating = Rml::Get(parameters, "repeating", false);
+    shader.stops = Rml::Get(parameters, "color_stop_list", Rml::ColorStopList());
+
+    if (name == "linear-gradient") {
+        shader.type = GRADIENT_LINEAR;
+        shader.p = Rml::Get(parameters, "p0", Rml::Vector2f(0.f));
+        shader.v = Rml::Get(parameters, "p1", Rml::Vector2f(0.f)) - shader.p;
+    } else if (name == "radial-gradient") {
+        shader.type = GRADIENT_RADIAL;
+        shader.p = Rml::Get(parameters, "center", Rml::Vector2f(0.f));
+        shader.v = Rml::Vector2f(1.f) / Rml::Get(parameters, "radius", Rml::Vector2f(1.f));
+    } else if (name == "conic-gradient") {
+        shader.type = GRADIENT_CONIC;
+        shader.p = Rml::Get(parameters, "center", Rml::Vector2f(0.f));
+        const float angle = Rml::Get(parameters, "angle", 0.f);
+        shader.v = Rml::Vector2f(Rml::Math::Cos(angle), Rml::Math::Sin(angle));
+    } else {
+        return 0;
+    }
+    ERR_FAIL_COND_V(shader.stops.empty(), 0);
+
+    ShaderInfo *shader_info = memnew(ShaderInfo(std::move(shader)));
+    return reinterpret_cast<uintptr_t>(shader_info);
+}
+
+void SoftwareRenderInterfaceGodot::RenderShader(Rml::CompiledShaderHandle shader, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) {
+    PUSH_DEBUG_COMMAND("RenderShader");
+    ShaderInfo *shader_info = reinterpret_cast<ShaderInfo *>(shader);
+    MeshData *mesh_data = reinterpret_cast<MeshData *>(geometry);
+    ERR_FAIL_NULL(shader_info);
+    ERR_FAIL_NULL(mesh_data);
+
+    Rect2i region = get_draw_region();
+    if (!region.has_area()) return;
+    stats.draw_calls++;
+
+    transform_vertices(mesh_data, translation);
+    plutovg_surface_t *target = get_layer();
+    plutovg_surface_t *mask = clip_mask_enabled ? context->clip_mask : nullptr;
+
+    rasterize(mesh_data, region, [&](int x, int y, const float *w, const RasterVertex *const *v) {
+        if (mask != nullptr && surface_row(mask, y)[x] == 0) return;
+
+        float gradient[4];
+        gradient_color(
+            shader_info,
+            w[0] * v[0]->u + w[1] * v[1]->u + w[2] * v[2]->u,
+            w[0] * v[0]->v + w[1] * v[1]->v + w[2] * v[2]->v,
+            gradient
+        );
+        float color[4] = {
+            gradient[0] * (w[0] * v[0]->r + w[1] * v[1]->r + w[2] * v[2]->r),
+            gradient[1] * (w[0] * v[0]->g + w[1] * v[1]->g + w[2] * v[2]->g),
+            gradient[2] * (w[0] * v[0]->b + w[1] * v[1]->b + w[2] * v[2]->b),
+            gradient[3] * (w[0] * v[0]->a + w[1] * v[1]->a + w[2] * v[2]->a)
+        };
+        blend_pixel(surface_row(target, y)[x], color);
+    });
+}
+
+void SoftwareRenderInterfaceGodot::ReleaseShader(Rml::CompiledShaderHandle shader) {
+    ShaderInfo *shader_info = reinterpret_cast<ShaderInfo *>(shader);
+    ERR_FAIL_NULL(shader_info);
+
+    memdelete(shader_info);
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <RmlUi/Core/RenderInterface.h>
+#include <RmlUi/Core/DecorationTypes.h>
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/canvas_item_material.hpp>
+#include <vector>
+
+#include <plutovg.h>
+
+#include "render_interface_godot.h"
+
+namespace godot {
+
+// Renders on the CPU into plutovg surfaces, for machines without a RenderingDevice (headless
+// runs, CI). Surfaces hold premultiplied ARGB32, triangles are rasterized straight into them since
+// plutovg paints can't interpolate vertex colors, while layers, masks and shadows are composited
+// with plutovg canvases
+class SoftwareRenderInterfaceGodot: public RenderInterfaceGodot {
+    struct MeshData {
+        std::vector<Rml::Vertex> vertices;
+        std::vector<int> indices;
+    };
+
+    struct TextureData {
+        plutovg_surface_t *surface = nullptr;
+        bool linear_filtering = true;
+    };
+
+    enum FilterType {
+        FILTER_COLOR_MATRIX,
+        FILTER_BLUR,
+        FILTER_DROP_SHADOW,
+        FILTER_MASK
+    };
+
+    struct FilterData {
+        FilterType type = FILTER_COLOR_MATRIX;
+        Rml::Matrix4f matrix = Rml::Matrix4f::Identity();
+        float sigma = 0.0f;
+        Vector2i offset;
+        // Straight alpha, plutovg premultiplies solid colors itself
+        Rml::Colourb color;
+        // Mask filters only, same size as the context
+        plutovg_surface_t *mask = nullptr;
+    };
+
+    enum GradientType {
+        GRADIENT_LINEAR = 1,
+        GRADIENT_RADIAL = 2,
+        GRADIENT_CONIC = 3
+    };
+
+    struct ShaderInfo {
+        GradientType type = GRADIENT_LINEAR;
+        bool repeating = false;
+        Rml::Vector2f p, v;
+        Rml::ColorStopList stops;
+    };
+
+    // Vertex transformed to pixels, with premultiplied color in [0, 1]
+    struct RasterVertex {
+        float x, y;
+        float r, g, b, a;
+        float u, v;
+    };
+
+    struct Context {
+        Vector2i size;
+        // Index 0 is the context itself, pushed layers follow
+        std::vector<plutovg_surface_t *> layers;
+        uint32_t layer_ptr = 0;
+        // Filters run on a copy of the source layer, and drop shadows on a second one
+        plutovg_surface_t *filter_buffer = nullptr;
+        plutovg_surface_t *shadow_buffer = nullptr;
+        // Opaque white where drawing is allowed, transparent elsewhere
+        plutovg_surface_t *clip_mask = nullptr;
+        plutovg_surface_t *clip_buffer = nullptr;
+
+        PackedByteArray image_data;
+        Ref<ImageTexture> texture;
+        RID canvas_item;
+        bool has_frame = false;
+    };
+
+    Context *context = nullptr;
+    Ref<CanvasItemMaterial> premultiplied_material;
+
+    bool scissor_enabled = false;
+    Rect2i scissor_region;
+    bool clip_mask_enabled = false;
+
+    Rml::Matrix4f drawing_matrix = Rml::Matrix4f::Identity();
+    bool has_transform = false;
+
+    std::vector<RasterVertex> raster_vertices;
+
+    static plutovg_surface_t *create_surface(const Vector2i &p_size);
+    static void destroy_surface(plutovg_surface_t *&p_surface);
+    static void copy_surface(plutovg_surface_t *p_dst, plutovg_surface_t *p_src, const Rect2i &p_region);
+    static void composite_surface(plutovg_surface_t *p_dst, plutovg_surface_t *p_src, plutovg_operator_t p_op, const Rect2i &p_region, const Vector2i &p_offset = Vector2i());
+
+    void allocate_context(Context *p_ctx, const Vector2i &p_size);
+    void free_context(Context *p_ctx);
+    plutovg_surface_t *get_layer();
+    Rect2i get_draw_region() const;
+
+    void transform_vertices(const MeshData *p_mesh_data, Rml::Vector2f p_translation);
+    template <typename F>
+    void rasterize(const MeshData *p_mesh_data, const Rect2i &p_region, F p_shade);
+    void fill_mask(plutovg_surface_t *p_surface, const MeshData *p_mesh_data, uint32_t p_value);
+
+    static uint32_t sample_texture(const TextureData *p_texture, float p_u, float p_v);
+    static void gradient_color(const ShaderInfo *p_shader, float p_u, float p_v, float r_color[4]);
+
+    void apply_color_matrix(plutovg_surface_t *p_surface, const Rml::Matrix4f &p_matrix, const Rect2i &p_region);
+    void apply_blur(plutovg_surface_t *p_surface, float p_sigma, const Rect2i &p_region);
+    void apply_drop_shadow(const FilterData *p_filter, const Rect2i &p_region);
+    void apply_filter(const FilterData *p_filter, const Rect2i &p_region);
+
+    // Frame converted to RGBA8, premultiplied as drawn into the canvas or straight for images
+    void read_pixels(Context *p_ctx, PackedByteArray &r_data, bool p_premultiplied) const;
+
+public:
+	void initialize() override;
+    void finalize() override;
+
+    void push_context(void *&p_ctx, const Vector2i &p_size, bool p_incremental, bool p_direct) override;
+    void pop_context() override;
+    void draw_context(void *&p_ctx, const RID &p_canvas_item) override;
+	void free_context(void *&p_ctx) override;
+    Ref<Image> get_context_image(void *&p_ctx) override;
+
+	Rml::CompiledGeometryHandle CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices) override;
+	void RenderGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) override;
+	void ReleaseGeometry(Rml::CompiledGeometryHandle geometry) override;
+
+    Rml::TextureHandle LoadTexture(Rml::Vector2i& texture_dimensions, const Rml::String& source) override;
+    Rml::TextureHandle GenerateTexture(Rml::Span<const Rml::byte> source, Rml::Vector2i source_dimensions) override;
+    void ReleaseTexture(Rml::TextureHandle texture) override;
+
+    void EnableScissorRegion(bool enable) override;
+    void SetScissorRegion(Rml::Rectanglei region) override;
+
+    void EnableClipMask(bool enable) override;
+    void RenderToClipMask(Rml::ClipMaskOperation operation, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation) override;
+
+    void SetTransform(const Rml::Matrix4f* transform) override;
+
+    Rml::LayerHandle PushLayer() override;
+    void CompositeLayers(Rml::LayerHandle source, Rml::LayerHandle destination, Rml::BlendMode blend_mode, Rml::Span<const Rml::CompiledFilterHandle> filters) override;
+    void PopLayer() override;
+
+    Rml::TextureHandle SaveLayerAsTexture() override;
+    Rml::CompiledFilterHandle SaveLayerAsMaskImage() override;
+
+    Rml::CompiledFilterHandle CompileFilter(const Rml::String& name, const Rml::Dictionary& parameters) override;
+    void ReleaseFilter(Rml::CompiledFilterHandle filter) override;
+
+    Rml::CompiledShaderHandle CompileShader(const Rml::String& name, const Rml::Dictionary& parameters) override;
+    void RenderShader(Rml::CompiledShaderHandle shader, Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture) override;
+    void ReleaseShader(Rml::CompiledShaderHandle shader) override;
+};
+
+}
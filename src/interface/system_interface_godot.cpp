@@ -15,8 +15,8 @@ SystemInterfaceGodot *SystemInterfaceGodot::get_singleton() {
 	return singleton;
 }
 
-void SystemInterfaceGodot::set_context_document(const RID &p_rid) {
-	current_document = p_rid;
+void SystemInterfaceGodot::set_current_context(const RID &p_rid) {
+	current_context = p_rid;
 }
 
 double SystemInterfaceGodot::GetElapsedTime() {
@@ -105,8 +105,8 @@ void SystemInterfaceGodot::SetMouseCursor(const Rml::String& cursor_name) {
 	else if (cursor_name == "wait") {
 		shape = Input::CursorShape::CURSOR_WAIT;
 	}
-	if (current_document.is_valid()) {
-		RMLServer::get_singleton()->document_set_cursor_shape(current_document, shape);
+	if (current_context.is_valid()) {
+		RMLServer::get_singleton()->context_set_cursor_shape(current_context, shape);
 	}
 }
 
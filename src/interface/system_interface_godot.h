@@ -6,12 +6,12 @@ namespace godot {
 
 class SystemInterfaceGodot : public Rml::SystemInterface {
 private:
-	RID current_document = RID();
+	RID current_context = RID();
     static SystemInterfaceGodot *singleton;
 
 public:
 	static SystemInterfaceGodot *get_singleton();
-	void set_context_document(const RID &p_rid);
+	void set_current_context(const RID &p_rid);
 
 	double GetElapsedTime() override;
 
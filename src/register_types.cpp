@@ -4,7 +4,10 @@
 
 #include "interface/system_interface_godot.h"
 #include "interface/rd_render_interface_godot.h"
+#include "interface/software_render_interface_godot.h"
+#include "interface/render_capture.h"
 #include "interface/file_interface_godot.h"
+#include "element/rml_context.h"
 #include "element/rml_document.h"
 #include "element/rml_element.h"
 #include "server/rml_server.h"
@@ -17,6 +20,7 @@
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/godot.hpp>
 
@@ -26,19 +30,54 @@ using namespace godot;
 
 static RMLServer *rml_server = nullptr;
 
+enum Renderer {
+	RENDERER_AUTOMATIC,
+	RENDERER_RENDERING_DEVICE,
+	RENDERER_SOFTWARE
+};
+
 void initialize_rmlui() {
     static SystemInterfaceGodot system;
-    static RDRenderInterfaceGodot render;
     static FileInterfaceGodot file;
 	static RmlPluginGodot plugin;
-	
+
+	// The render interface is only needed by contexts, it's set once the rendering server is up
 	Rml::SetSystemInterface(&system);
-	Rml::SetRenderInterface(&render);
 	Rml::SetFileInterface(&file);
 	Rml::RegisterPlugin(&plugin);
 	Rml::Initialise();
 }
 
+void initialize_render_interface() {
+    static RDRenderInterfaceGodot rd_render;
+    static SoftwareRenderInterfaceGodot software_render;
+
+	// Headless runs and the Compatibility renderer have no RenderingDevice to draw with
+	int renderer = GLOBAL_GET("RmlUi/rendering/renderer");
+	bool has_device = RenderingServer::get_singleton()->get_rendering_device() != nullptr;
+	if (renderer == RENDERER_AUTOMATIC) {
+		renderer = has_device ? RENDERER_RENDERING_DEVICE : RENDERER_SOFTWARE;
+	} else if (renderer == RENDERER_RENDERING_DEVICE && !has_device) {
+		WARN_PRINT("RmlUi/rendering/renderer is RenderingDevice, but there's no RenderingDevice to draw with, using the software renderer");
+		renderer = RENDERER_SOFTWARE;
+	}
+	
+	RenderInterfaceGodot *render = &rd_render;
+	if (renderer == RENDERER_SOFTWARE) {
+		render = &software_render;
+	}
+	RenderInterfaceGodot::set_singleton(render);
+	
+	if (GLOBAL_GET("RmlUi/debug/render_capture")) {
+		static RenderCaptureInterface capture;
+		capture.set_target(render);
+		render->set_capture(&capture);
+		Rml::SetRenderInterface(&capture);
+	} else {
+		Rml::SetRenderInterface(render);
+	}
+}
+
 void uninitialize_rmlui() {
 	Rml::Shutdown();
 }
@@ -48,6 +87,17 @@ void initialize_gdex_module(ModuleInitializationLevel p_level) {
 		case MODULE_INITIALIZATION_LEVEL_CORE: {
 			GLOBAL_DEF_RST("RmlUi/load_user_agent_stylesheet", true);
 			GLOBAL_DEF_RST("RmlUi/custom_user_agent_stylesheet", String());
+			GLOBAL_DEF_RST("RmlUi/rendering/batch_draws", true);
+			// Un-multiplied output blends as expected with a translucent modulate, at the cost of two passes
+			GLOBAL_DEF_RST("RmlUi/rendering/post_process_pass", false);
+			// Compiled shaders are cached in user:// so later startups skip the driver compilation
+			GLOBAL_DEF_RST("RmlUi/rendering/shader_cache", true);
+			// Automatic draws on the CPU when there's no RenderingDevice, like headless or with the Compatibility renderer
+			GLOBAL_DEF_RST(PropertyInfo(Variant::INT, "RmlUi/rendering/renderer", PROPERTY_HINT_ENUM, "Automatic,RenderingDevice,Software"), RENDERER_AUTOMATIC);
+			// Routes render calls through a recorder so frames can be captured, see RMLServer.context_capture_frame
+			GLOBAL_DEF_RST("RmlUi/debug/render_capture", false);
+			// Times the passes of each context on the GPU, see RMLServer.context_get_gpu_times
+			GLOBAL_DEF_RST("RmlUi/debug/gpu_profiling", false);
 
 			initialize_rmlui();
 		} break;
@@ -60,6 +110,7 @@ void initialize_gdex_module(ModuleInitializationLevel p_level) {
 			Engine::get_singleton()->register_singleton("RMLServer", rml_server);
 		} break;
 		case MODULE_INITIALIZATION_LEVEL_SCENE: {
+			GDREGISTER_CLASS(RMLContext);
 			GDREGISTER_CLASS(RMLDocument);
 			GDREGISTER_CLASS(RMLElement);
 		} break;
@@ -78,6 +129,7 @@ void uninitialize_gdex_module(ModuleInitializationLevel p_level) {
 }
 
 void startup_gdex_module() {
+	initialize_render_interface();
 	RMLServer::get_singleton()->initialize();
 }
 
@@ -0,0 +1,176 @@
+#include "geometry_arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+using namespace godot;
+using RD = RenderingDevice;
+
+GeometryArena::RangeAllocator::RangeAllocator(uint32_t p_capacity) {
+	capacity = p_capacity;
+	free_ranges[0] = p_capacity;
+}
+
+bool GeometryArena::RangeAllocator::allocate(uint32_t p_size, uint32_t &r_offset) {
+	// First fit
+	for (auto it = free_ranges.begin(); it != free_ranges.end(); it++) {
+		if (it->second < p_size) continue;
+
+		r_offset = it->first;
+		uint32_t remaining = it->second - p_size;
+		free_ranges.erase(it);
+		if (remaining > 0) {
+			free_ranges[r_offset + p_size] = remaining;
+		}
+		return true;
+	}
+	return false;
+}
+
+void GeometryArena::RangeAllocator::free(uint32_t p_offset, uint32_t p_size) {
+	auto it = free_ranges.emplace(p_offset, p_size).first;
+
+	// Merge with the next range
+	auto next = std::next(it);
+	if (next != free_ranges.end() && it->first + it->second == next->first) {
+		it->second += next->second;
+		free_ranges.erase(next);
+	}
+
+	// Merge with the previous range
+	if (it != free_ranges.begin()) {
+		auto prev = std::prev(it);
+		if (prev->first + prev->second == it->first) {
+			prev->second += it->second;
+			free_ranges.erase(it);
+		}
+	}
+}
+
+GeometryArena::Block *GeometryArena::create_block(uint32_t p_vertex_capacity, uint32_t p_index_capacity) {
+	Block *block = memnew(Block);
+	block->vertices = RangeAllocator(p_vertex_capacity);
+	block->indices = RangeAllocator(p_index_capacity);
+
+	VertexBufferDesc vertex_buffer_desc;
+	vertex_buffer_desc.size = p_vertex_capacity * vertex_stride;
+	block->vertex_buffer = resources->create_vertex_buffer(vertex_buffer_desc);
+
+	// Initialized with zeros so the index buffer starts with a known max index
+	IndexBufferDesc index_buffer_desc;
+	index_buffer_desc.data.resize(p_index_capacity * 4);
+	index_buffer_desc.data.fill(0);
+	index_buffer_desc.count = p_index_capacity;
+	index_buffer_desc.format = RD::INDEX_BUFFER_FORMAT_UINT32;
+	block->index_buffer = resources->create_index_buffer(index_buffer_desc);
+
+	// Every attribute reads from the same interleaved buffer
+	VertexArrayDesc vertex_array_desc;
+	vertex_array_desc.count = p_vertex_capacity;
+	vertex_array_desc.format = vertex_format;
+	vertex_array_desc.buffers.assign(attribute_count, block->vertex_buffer);
+	block->vertex_array = resources->create_vertex_array(vertex_array_desc);
+
+	blocks.push_back(block);
+	return block;
+}
+
+void GeometryArena::free_block(Block *p_block) {
+	resources->free_vertex_array(p_block->vertex_array);
+	resources->free_vertex_buffer(p_block->vertex_buffer);
+	resources->free_index_buffer(p_block->index_buffer);
+
+	blocks.erase(std::find(blocks.begin(), blocks.end(), p_block));
+	memdelete(p_block);
+}
+
+void GeometryArena::initialize(RenderingResources *p_resources, int64_t p_vertex_format, uint32_t p_vertex_stride, uint32_t p_attribute_count, uint32_t p_block_vertex_capacity, uint32_t p_block_index_capacity) {
+	resources = p_resources;
+	vertex_format = p_vertex_format;
+	vertex_stride = p_vertex_stride;
+	attribute_count = p_attribute_count;
+	block_vertex_capacity = p_block_vertex_capacity;
+	block_index_capacity = p_block_index_capacity;
+}
+
+GeometryArena::Allocation GeometryArena::allocate(const uint8_t *p_vertices, uint32_t p_vertex_count, const int *p_indices, uint32_t p_index_count) {
+	Allocation alloc;
+	ERR_FAIL_NULL_V(resources, alloc);
+	ERR_FAIL_COND_V(p_vertex_count == 0 || p_index_count == 0, alloc);
+
+	for (Block *block : blocks) {
+		if (!block->vertices.allocate(p_vertex_count, alloc.vertex_offset)) continue;
+		if (!block->indices.allocate(p_index_count, alloc.index_offset)) {
+			block->vertices.free(alloc.vertex_offset, p_vertex_count);
+			continue;
+		}
+		alloc.block = block;
+		break;
+	}
+
+	if (alloc.block == nullptr) {
+		// Geometry larger than the default block size gets a dedicated block
+		Block *block = create_block(
+			MAX(block_vertex_capacity, p_vertex_count),
+			MAX(block_index_capacity, p_index_count)
+		);
+		block->vertices.allocate(p_vertex_count, alloc.vertex_offset);
+		block->indices.allocate(p_index_count, alloc.index_offset);
+		alloc.block = block;
+	}
+
+	alloc.vertex_count = p_vertex_count;
+	alloc.index_count = p_index_count;
+	alloc.block->allocation_count++;
+
+	RD *rd = resources->device();
+
+	uint32_t vertex_bytes = p_vertex_count * vertex_stride;
+	uint32_t index_bytes = p_index_count * 4;
+	if ((uint32_t)upload_buffer.size() < MAX(vertex_bytes, index_bytes)) {
+		upload_buffer.resize(MAX(vertex_bytes, index_bytes));
+	}
+
+	memcpy(upload_buffer.ptrw(), p_vertices, vertex_bytes);
+	rd->buffer_update(alloc.block->vertex_buffer, alloc.vertex_offset * vertex_stride, vertex_bytes, upload_buffer);
+
+	// Indices are rebased so they address the shared vertex array directly
+	uint32_t *index_ptr = (uint32_t *)upload_buffer.ptrw();
+	for (uint32_t i = 0; i < p_index_count; i++) {
+		index_ptr[i] = alloc.vertex_offset + (uint32_t)p_indices[i];
+	}
+	rd->buffer_update(alloc.block->index_buffer, alloc.index_offset * 4, index_bytes, upload_buffer);
+
+	IndexArrayDesc index_array_desc;
+	index_array_desc.buffer = alloc.block->index_buffer;
+	index_array_desc.offset = alloc.index_offset;
+	index_array_desc.count = p_index_count;
+	alloc.index_array = resources->create_index_array(index_array_desc);
+
+	return alloc;
+}
+
+void GeometryArena::free(Allocation &p_allocation) {
+	if (!p_allocation.is_valid()) return;
+
+	Block *block = p_allocation.block;
+
+	resources->free_index_array(p_allocation.index_array);
+	block->vertices.free(p_allocation.vertex_offset, p_allocation.vertex_count);
+	block->indices.free(p_allocation.index_offset, p_allocation.index_count);
+	block->allocation_count--;
+
+	// Always keep one block around to avoid churn on small documents
+	if (block->allocation_count == 0 && blocks.size() > 1) {
+		free_block(block);
+	}
+
+	p_allocation = Allocation();
+}
+
+void GeometryArena::clear() {
+	while (!blocks.empty()) {
+		free_block(blocks.back());
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <godot_cpp/classes/rendering_device.hpp>
+
+#include "rendering_resources.h"
+
+namespace godot {
+
+// Sub-allocates geometry from a handful of large shared vertex and index buffers,
+// so each compiled geometry only owns an index array
+class GeometryArena {
+	struct RangeAllocator {
+		// Free ranges, offset -> size
+		std::map<uint32_t, uint32_t> free_ranges;
+		uint32_t capacity = 0;
+
+		bool allocate(uint32_t p_size, uint32_t &r_offset);
+		void free(uint32_t p_offset, uint32_t p_size);
+
+		RangeAllocator() {}
+		RangeAllocator(uint32_t p_capacity);
+	};
+
+public:
+	struct Block {
+		RID vertex_buffer;
+		RID index_buffer;
+		RID vertex_array;
+
+		RangeAllocator vertices;
+		RangeAllocator indices;
+		uint32_t allocation_count = 0;
+	};
+
+	struct Allocation {
+		Block *block = nullptr;
+		uint32_t vertex_offset = 0;
+		uint32_t vertex_count = 0;
+		uint32_t index_offset = 0;
+		uint32_t index_count = 0;
+
+		RID index_array;
+
+		RID get_vertex_array() const { return block ? block->vertex_array : RID(); }
+		bool is_valid() const { return block != nullptr; }
+	};
+
+private:
+	RenderingResources *resources = nullptr;
+
+	int64_t vertex_format = -1;
+	uint32_t vertex_stride = 0;
+	uint32_t attribute_count = 0;
+
+	uint32_t block_vertex_capacity = 0;
+	uint32_t block_index_capacity = 0;
+
+	std::vector<Block *> blocks;
+
+	PackedByteArray upload_buffer;
+
+	Block *create_block(uint32_t p_vertex_capacity, uint32_t p_index_capacity);
+	void free_block(Block *p_block);
+
+public:
+	void initialize(RenderingResources *p_resources, int64_t p_vertex_format, uint32_t p_vertex_stride, uint32_t p_attribute_count, uint32_t p_block_vertex_capacity = 65536, uint32_t p_block_index_capacity = 196608);
+
+	Allocation allocate(const uint8_t *p_vertices, uint32_t p_vertex_count, const int *p_indices, uint32_t p_index_count);
+	void free(Allocation &p_allocation);
+
+	void clear();
+
+	uint32_t get_block_count() const { return blocks.size(); }
+};
+
+}
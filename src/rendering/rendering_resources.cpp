@@ -1,8 +1,13 @@
 #include "rendering_resources.h"
 
 #include <iostream>
+#include <cstring>
 
 #include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/templates/hashfuncs.hpp>
 #include <godot_cpp/classes/rd_uniform.hpp>
 #include <godot_cpp/classes/rd_shader_source.hpp>
 #include <godot_cpp/classes/rd_shader_file.hpp>
@@ -21,28 +26,162 @@
 using namespace godot;
 using RD = RenderingDevice;
 
+uint32_t SamplerDesc::hash() const {
+	uint32_t h = hash_murmur3_one_32(min_filter);
+	h = hash_murmur3_one_32(mag_filter, h);
+	h = hash_murmur3_one_32(repeat_u, h);
+	h = hash_murmur3_one_32(repeat_v, h);
+	h = hash_murmur3_one_32(repeat_w, h);
+	h = hash_murmur3_one_32(border_color, h);
+	return hash_fmix32(h);
+}
+
+bool SamplerDesc::operator==(const SamplerDesc &p_other) const {
+	return min_filter == p_other.min_filter &&
+		mag_filter == p_other.mag_filter &&
+		repeat_u == p_other.repeat_u &&
+		repeat_v == p_other.repeat_v &&
+		repeat_w == p_other.repeat_w &&
+		border_color == p_other.border_color;
+}
+
+uint32_t TextureDesc::hash() const {
+	uint32_t h = hash_murmur3_one_32(texture_type);
+	h = hash_murmur3_one_32(width, h);
+	h = hash_murmur3_one_32(height, h);
+	h = hash_murmur3_one_32(format, h);
+	h = hash_murmur3_one_64(usage_bits, h);
+	h = hash_murmur3_one_32(swizzle_r | swizzle_g << 8 | swizzle_b << 16 | swizzle_a << 24, h);
+	h = hash_murmur3_buffer(data.ptr(), data.size(), h);
+	return hash_fmix32(h);
+}
+
+bool TextureDesc::operator==(const TextureDesc &p_other) const {
+	return texture_type == p_other.texture_type &&
+		width == p_other.width &&
+		height == p_other.height &&
+		format == p_other.format &&
+		usage_bits == p_other.usage_bits &&
+		swizzle_r == p_other.swizzle_r &&
+		swizzle_g == p_other.swizzle_g &&
+		swizzle_b == p_other.swizzle_b &&
+		swizzle_a == p_other.swizzle_a &&
+		data.size() == p_other.data.size() &&
+		memcmp(data.ptr(), p_other.data.ptr(), data.size()) == 0;
+}
+
+uint32_t FramebufferDesc::hash() const {
+	uint32_t h = HASH_MURMUR3_SEED;
+	for (const RID &texture : textures) {
+		h = hash_murmur3_one_64(texture.get_id(), h);
+	}
+	return hash_fmix32(h);
+}
+
+bool FramebufferDesc::operator==(const FramebufferDesc &p_other) const {
+	return textures == p_other.textures;
+}
+
+uint32_t ShaderDesc::hash() const {
+	return hash_fmix32(hash_murmur3_one_32(path.hash(), name.hash()));
+}
+
+bool ShaderDesc::operator==(const ShaderDesc &p_other) const {
+	return path == p_other.path && name == p_other.name;
+}
+
+bool StencilOpDesc::operator==(const StencilOpDesc &p_other) const {
+	return reference == p_other.reference &&
+		write_mask == p_other.write_mask &&
+		compare_mask == p_other.compare_mask &&
+		compare == p_other.compare &&
+		pass == p_other.pass &&
+		fail == p_other.fail;
+}
+
+bool BlendAttachmentDesc::operator==(const BlendAttachmentDesc &p_other) const {
+	return enable_blend == p_other.enable_blend &&
+		color_blend_op == p_other.color_blend_op &&
+		alpha_blend_op == p_other.alpha_blend_op &&
+		src_color_blend_factor == p_other.src_color_blend_factor &&
+		dst_color_blend_factor == p_other.dst_color_blend_factor &&
+		src_alpha_blend_factor == p_other.src_alpha_blend_factor &&
+		dst_alpha_blend_factor == p_other.dst_alpha_blend_factor;
+}
+
+static uint32_t hash_stencil_op(const StencilOpDesc &p_op, uint32_t p_seed) {
+	uint32_t h = hash_murmur3_one_32(p_op.reference, p_seed);
+	h = hash_murmur3_one_32(p_op.write_mask, h);
+	h = hash_murmur3_one_32(p_op.compare_mask, h);
+	return hash_murmur3_one_32(p_op.compare | p_op.pass << 8 | p_op.fail << 16, h);
+}
+
+uint32_t RenderPipelineDesc::hash() const {
+	uint32_t h = hash_murmur3_one_64(shader.get_id());
+	h = hash_murmur3_one_64(framebuffer_format, h);
+	h = hash_murmur3_one_64(vertex_format, h);
+	h = hash_murmur3_one_32(primitive, h);
+	h = hash_murmur3_one_32(enable_stencil, h);
+	if (enable_stencil) {
+		h = hash_stencil_op(front_stencil, h);
+		h = hash_stencil_op(back_stencil, h);
+	}
+	h = hash_murmur3_one_32(attachment_count, h);
+	h = hash_murmur3_one_32(blend.enable_blend | blend.color_blend_op << 1 | blend.alpha_blend_op << 8, h);
+	h = hash_murmur3_one_32(blend.src_color_blend_factor | blend.dst_color_blend_factor << 8 | blend.src_alpha_blend_factor << 16 | blend.dst_alpha_blend_factor << 24, h);
+	return hash_fmix32(h);
+}
+
+bool RenderPipelineDesc::operator==(const RenderPipelineDesc &p_other) const {
+	return shader == p_other.shader &&
+		framebuffer_format == p_other.framebuffer_format &&
+		vertex_format == p_other.vertex_format &&
+		primitive == p_other.primitive &&
+		enable_stencil == p_other.enable_stencil &&
+		front_stencil == p_other.front_stencil &&
+		back_stencil == p_other.back_stencil &&
+		attachment_count == p_other.attachment_count &&
+		blend == p_other.blend;
+}
+
+uint32_t ComputePipelineDesc::hash() const {
+	return hash_fmix32(hash_murmur3_one_64(shader.get_id()));
+}
+
+bool ComputePipelineDesc::operator==(const ComputePipelineDesc &p_other) const {
+	return shader == p_other.shader;
+}
+
 void RenderingResources::map_resource(const RID &p_rid, ResourceMap &p_map) {
-	p_map.insert(p_rid);
+	p_map.resources.insert(p_rid);
 }
 
 void RenderingResources::free_resource(const RID &p_rid, ResourceMap &p_map) {
-	bool has_rid = p_map.find(p_rid) != p_map.end();
+	bool has_rid = p_map.resources.has(p_rid);
 	ERR_FAIL_COND_MSG(!has_rid, vformat("Has no resource of type '%s' with %s", p_map.resource_name, p_rid));
 	rendering_device->free_rid(p_rid);
-	p_map.erase(p_rid);
+	p_map.resources.erase(p_rid);
 }
 
 void RenderingResources::free_all_resources(ResourceMap &p_map) {
-	for (auto it : p_map) {
-		rendering_device->free_rid(it);
+	for (const RID &rid : p_map.resources) {
+		rendering_device->free_rid(rid);
 	}
-	p_map.clear();
+	p_map.resources.clear();
 }
 
 void RenderingResources::free_all_resources() {
+	sampler_cache.clear();
+	texture_cache.clear();
+	framebuffer_cache.clear();
+	shader_cache.clear();
+	render_pipeline_cache.clear();
+	compute_pipeline_cache.clear();
+
 	// Must follow a order to be able to free the resources correctly
 	free_all_resources(framebuffer_map);
 	free_all_resources(render_pipeline_map);
+	free_all_resources(compute_pipeline_map);
 	free_all_resources(shader_map);
 	free_all_resources(sampler_map);
 	free_all_resources(texture_map);
@@ -54,58 +193,61 @@ void RenderingResources::free_all_resources() {
 }
 
 #define IMPLEMENT_RENDERING_RESOURCE(p_name) \
-void RenderingResources::free_##p_name(const RID &p_rid) { free_resource(p_rid, p_name ##_map); } \
-RID RenderingResources::get_or_create_ ##p_name(uint64_t p_id, const std::function<std::map<String, Variant>()> &p_get_data) { \
-	auto it = p_name ##_cache.find(p_id); \
-	if (it != p_name ##_cache.end()) { \
-		return it->second; \
+void RenderingResources::free_##p_name(const RID &p_rid) { \
+	free_resource(p_rid, p_name ##_map); \
+}
+
+#define IMPLEMENT_CACHED_RENDERING_RESOURCE(p_name, p_desc) \
+void RenderingResources::free_##p_name(const RID &p_rid) { \
+	if (!p_name ##_cache.release(p_rid)) return; \
+	free_resource(p_rid, p_name ##_map); \
+} \
+RID RenderingResources::get_or_create_ ##p_name(const p_desc &p_data) { \
+	RID rid = p_name ##_cache.acquire(p_data); \
+	if (rid.is_valid()) { \
+		return rid; \
+	} \
+	rid = create_ ##p_name(p_data); \
+	if (rid.is_valid()) { \
+		p_name ##_cache.insert(p_data, rid); \
 	} \
-	std::map<String, Variant> data = p_get_data(); \
-	return create_ ##p_name(data); \
+	return rid; \
 }
 
-IMPLEMENT_RENDERING_RESOURCE(sampler)
-IMPLEMENT_RENDERING_RESOURCE(texture)
-IMPLEMENT_RENDERING_RESOURCE(framebuffer)
-IMPLEMENT_RENDERING_RESOURCE(shader)
-IMPLEMENT_RENDERING_RESOURCE(render_pipeline)
+IMPLEMENT_CACHED_RENDERING_RESOURCE(sampler, SamplerDesc)
+IMPLEMENT_CACHED_RENDERING_RESOURCE(texture, TextureDesc)
+IMPLEMENT_CACHED_RENDERING_RESOURCE(framebuffer, FramebufferDesc)
+IMPLEMENT_CACHED_RENDERING_RESOURCE(shader, ShaderDesc)
+IMPLEMENT_CACHED_RENDERING_RESOURCE(render_pipeline, RenderPipelineDesc)
+IMPLEMENT_CACHED_RENDERING_RESOURCE(compute_pipeline, ComputePipelineDesc)
 IMPLEMENT_RENDERING_RESOURCE(vertex_buffer)
 IMPLEMENT_RENDERING_RESOURCE(index_buffer)
 IMPLEMENT_RENDERING_RESOURCE(vertex_array)
 IMPLEMENT_RENDERING_RESOURCE(index_array)
 IMPLEMENT_RENDERING_RESOURCE(storage_buffer)
 
+#undef IMPLEMENT_CACHED_RENDERING_RESOURCE
 #undef IMPLEMENT_RENDERING_RESOURCE
 
-Variant map_get(const std::map<String, Variant> &p_map, const String &p_key, const Variant &p_default) {
-	auto it = p_map.find(p_key);
-	if (it == p_map.end()) {
-		return p_default;
+static TypedArray<RID> to_rid_array(const std::vector<RID> &p_rids) {
+	TypedArray<RID> array;
+	array.resize(p_rids.size());
+	for (size_t i = 0; i < p_rids.size(); i++) {
+		array[i] = p_rids[i];
 	}
-	return it->second;
+	return array;
 }
 
-Variant map_get2(const std::map<String, Variant> &p_map, const String &p_key0, const String &p_key1, const Variant &p_default) {
-	auto it = p_map.find(p_key0);
-	if (it == p_map.end()) {
-		it = p_map.find(p_key1);
-	}
-	if (it == p_map.end()) {
-		return p_default;
-	}
-	return it->second;
-}
-
-RID RenderingResources::create_sampler(const std::map<String, Variant> &p_data) {
+RID RenderingResources::create_sampler(const SamplerDesc &p_data) {
 	Ref<RDSamplerState> sampler_state;
     sampler_state.instantiate();
 
-	sampler_state->set_min_filter((RD::SamplerFilter)(int)map_get2(p_data, "min_filter", "filter", RD::SAMPLER_FILTER_NEAREST));
-    sampler_state->set_mag_filter((RD::SamplerFilter)(int)map_get2(p_data, "mag_filter", "filter", RD::SAMPLER_FILTER_NEAREST));
-    sampler_state->set_repeat_u((RD::SamplerRepeatMode)(int)map_get2(p_data, "repeat_u", "repeat", RD::SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE));
-    sampler_state->set_repeat_v((RD::SamplerRepeatMode)(int)map_get2(p_data, "repeat_v", "repeat", RD::SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE));
-    sampler_state->set_repeat_w((RD::SamplerRepeatMode)(int)map_get2(p_data, "repeat_w", "repeat", RD::SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE));
-    sampler_state->set_border_color((RD::SamplerBorderColor)(int)map_get(p_data, "border_color", RD::SAMPLER_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK));
+	sampler_state->set_min_filter(p_data.min_filter);
+    sampler_state->set_mag_filter(p_data.mag_filter);
+    sampler_state->set_repeat_u(p_data.repeat_u);
+    sampler_state->set_repeat_v(p_data.repeat_v);
+    sampler_state->set_repeat_w(p_data.repeat_w);
+    sampler_state->set_border_color(p_data.border_color);
 
 	RID rid = rendering_device->sampler_create(sampler_state);
 	ERR_FAIL_COND_V(!rid.is_valid(), RID());
@@ -114,18 +256,25 @@ RID RenderingResources::create_sampler(const std::map<String, Variant> &p_data)
 	return rid;
 }
 
-RID RenderingResources::create_texture(const std::map<String, Variant> &p_data) {
+RID RenderingResources::create_texture(const TextureDesc &p_data) {
 	Ref<RDTextureFormat> tex_format;
     Ref<RDTextureView> tex_view;
     tex_format.instantiate();
     tex_view.instantiate();
-    tex_format->set_texture_type((RD::TextureType)(int)map_get(p_data, "texture_type", RD::TEXTURE_TYPE_2D));
-    tex_format->set_width(map_get(p_data, "width", 1));
-    tex_format->set_height(map_get(p_data, "height", 1));
-    tex_format->set_format((RD::DataFormat)(int)map_get(p_data, "format", RD::DATA_FORMAT_R8G8B8A8_UNORM));
-    tex_format->set_usage_bits((uint64_t)map_get(p_data, "usage_bits", RD::TEXTURE_USAGE_SAMPLING_BIT));
-
-	TypedArray<PackedByteArray> data = map_get(p_data, "data", TypedArray<PackedByteArray>());
+    tex_format->set_texture_type(p_data.texture_type);
+    tex_format->set_width(p_data.width);
+    tex_format->set_height(p_data.height);
+    tex_format->set_format(p_data.format);
+    tex_format->set_usage_bits(p_data.usage_bits);
+    tex_view->set_swizzle_r(p_data.swizzle_r);
+    tex_view->set_swizzle_g(p_data.swizzle_g);
+    tex_view->set_swizzle_b(p_data.swizzle_b);
+    tex_view->set_swizzle_a(p_data.swizzle_a);
+
+	TypedArray<PackedByteArray> data;
+	if (!p_data.data.is_empty()) {
+		data.push_back(p_data.data);
+	}
 	RID rid = rendering_device->texture_create(
 		tex_format,
 		tex_view, 
@@ -137,31 +286,87 @@ RID RenderingResources::create_texture(const std::map<String, Variant> &p_data)
 	return rid;
 }
 
-RID RenderingResources::create_framebuffer(const std::map<String, Variant> &p_data) {
-	TypedArray<RID> textures = map_get(p_data, "textures", TypedArray<RID>());
-
-	RID rid = rendering_device->framebuffer_create(textures);
+RID RenderingResources::create_framebuffer(const FramebufferDesc &p_data) {
+	RID rid = rendering_device->framebuffer_create(to_rid_array(p_data.textures));
 	ERR_FAIL_COND_V(!rid.is_valid(), RID());
 
 	map_resource(rid, framebuffer_map);
 	return rid;
 }
 
-RID RenderingResources::create_shader(const std::map<String, Variant> &p_data) {
-    Ref<RDShaderFile> shader_file = ResourceLoader::get_singleton()->load(map_get(p_data, "path", ""));
+RID RenderingResources::create_shader(const ShaderDesc &p_data) {
+    Ref<RDShaderFile> shader_file = ResourceLoader::get_singleton()->load(p_data.path);
     ERR_FAIL_COND_V(!shader_file.is_valid(), RID());
 
     Ref<RDShaderSPIRV> shader_spirv = shader_file->get_spirv();
     ERR_FAIL_COND_V(!shader_spirv.is_valid(), RID());
 
-    RID rid = rendering_device->shader_create_from_spirv(shader_spirv, map_get(p_data, "name", ""));
+    RID rid;
+    if (!shader_cache_path.is_empty()) {
+        rid = create_shader_from_cache(shader_spirv, p_data.name);
+    }
+    if (!rid.is_valid()) {
+        rid = rendering_device->shader_create_from_spirv(shader_spirv, p_data.name);
+    }
     ERR_FAIL_COND_V(!rid.is_valid(), RID());
 
    	map_resource(rid, shader_map);
 	return rid;
 }
 
-RID RenderingResources::create_render_pipeline(const std::map<String, Variant> &p_data) {
+RID RenderingResources::create_shader_from_cache(const Ref<RDShaderSPIRV> &p_spirv, const String &p_name) {
+    // Compiled bytecode is only valid for the driver and engine version it was compiled with
+    String key = rendering_device->get_device_pipeline_cache_uuid() + Engine::get_singleton()->get_version_info()["string"].stringify();
+    uint64_t hash = key.hash();
+    for (int i = 0; i < RD::SHADER_STAGE_MAX; i++) {
+        PackedByteArray bytecode = p_spirv->get_stage_bytecode((RD::ShaderStage)i);
+        hash = hash * 31 + hash_murmur3_buffer(bytecode.ptr(), bytecode.size());
+    }
+    String path = shader_cache_path.path_join(vformat("%s_%s.bin", p_name, String::num_uint64(hash, 16)));
+
+    if (FileAccess::file_exists(path)) {
+        PackedByteArray bytecode = FileAccess::get_file_as_bytes(path);
+        RID rid = bytecode.is_empty() ? RID() : rendering_device->shader_create_from_bytecode(bytecode);
+        if (rid.is_valid()) {
+            shader_cache_hits++;
+            return rid;
+        }
+    }
+    shader_cache_misses++;
+
+    PackedByteArray bytecode = rendering_device->shader_compile_binary_from_spirv(p_spirv, p_name);
+    ERR_FAIL_COND_V(bytecode.is_empty(), RID());
+    RID rid = rendering_device->shader_create_from_bytecode(bytecode);
+    ERR_FAIL_COND_V(!rid.is_valid(), RID());
+
+    // Failing to write the cache only costs a compilation on the next startup
+    DirAccess::make_dir_recursive_absolute(shader_cache_path);
+    Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+    if (file.is_valid()) {
+        file->store_buffer(bytecode);
+    }
+    return rid;
+}
+
+static void apply_stencil_op(const Ref<RDPipelineDepthStencilState> &p_state, const StencilOpDesc &p_op, bool p_front) {
+	if (p_front) {
+		p_state->set_front_op_reference(p_op.reference);
+		p_state->set_front_op_write_mask(p_op.write_mask);
+		p_state->set_front_op_compare(p_op.compare);
+		p_state->set_front_op_compare_mask(p_op.compare_mask);
+		p_state->set_front_op_pass(p_op.pass);
+		p_state->set_front_op_fail(p_op.fail);
+	} else {
+		p_state->set_back_op_reference(p_op.reference);
+		p_state->set_back_op_write_mask(p_op.write_mask);
+		p_state->set_back_op_compare(p_op.compare);
+		p_state->set_back_op_compare_mask(p_op.compare_mask);
+		p_state->set_back_op_pass(p_op.pass);
+		p_state->set_back_op_fail(p_op.fail);
+	}
+}
+
+RID RenderingResources::create_render_pipeline(const RenderPipelineDesc &p_data) {
 	Ref<RDPipelineRasterizationState> rasterization_state;
     Ref<RDPipelineMultisampleState> multisample_state;
     Ref<RDPipelineDepthStencilState> depth_stencil_state;
@@ -171,44 +376,31 @@ RID RenderingResources::create_render_pipeline(const std::map<String, Variant> &
     depth_stencil_state.instantiate();
     color_blend_state.instantiate();
 
-	depth_stencil_state->set_enable_stencil(map_get(p_data, "enable_stencil", false));
-
-	depth_stencil_state->set_back_op_reference(map_get2(p_data, "back_op_ref", "op_ref", 0));
-	depth_stencil_state->set_back_op_write_mask(map_get2(p_data, "back_op_write_mask", "op_write_mask", 0));
-	depth_stencil_state->set_back_op_compare((RD::CompareOperator)(int)map_get2(p_data, "back_op_compare", "op_compare", RD::COMPARE_OP_ALWAYS));
-	depth_stencil_state->set_back_op_compare_mask(map_get2(p_data, "back_op_compare_mask", "op_compare_mask", 0));
-	depth_stencil_state->set_back_op_pass((RD::StencilOperation)(int)map_get2(p_data, "back_op_pass", "op_pass", RD::STENCIL_OP_ZERO));
-	depth_stencil_state->set_back_op_fail((RD::StencilOperation)(int)map_get2(p_data, "back_op_fail", "op_fail", RD::STENCIL_OP_ZERO));
-
-	depth_stencil_state->set_front_op_reference(map_get2(p_data, "front_op_ref", "op_ref", 0));
-	depth_stencil_state->set_front_op_write_mask(map_get2(p_data, "front_op_write_mask", "op_write_mask", 0));
-	depth_stencil_state->set_front_op_compare((RD::CompareOperator)(int)map_get2(p_data, "front_op_compare", "op_compare", RD::COMPARE_OP_ALWAYS));
-	depth_stencil_state->set_front_op_compare_mask(map_get2(p_data, "front_op_compare_mask", "op_compare_mask", 0));
-	depth_stencil_state->set_front_op_pass((RD::StencilOperation)(int)map_get2(p_data, "front_op_pass", "op_pass", RD::STENCIL_OP_ZERO));
-	depth_stencil_state->set_front_op_fail((RD::StencilOperation)(int)map_get2(p_data, "front_op_fail", "op_fail", RD::STENCIL_OP_ZERO));
+	depth_stencil_state->set_enable_stencil(p_data.enable_stencil);
+	apply_stencil_op(depth_stencil_state, p_data.back_stencil, false);
+	apply_stencil_op(depth_stencil_state, p_data.front_stencil, true);
 
 	TypedArray<RDPipelineColorBlendStateAttachment> attachments;
-	int attachment_count = map_get(p_data, "attachment_count", 1);
-	for (int i = attachment_count - 1; i >= 0; i--) {
+	for (uint32_t i = 0; i < p_data.attachment_count; i++) {
 		Ref<RDPipelineColorBlendStateAttachment> attachment = memnew(RDPipelineColorBlendStateAttachment);
 
-		attachment->set_enable_blend(map_get2(p_data, vformat("attachment%d_enable_blend", i), "attachment_enable_blend", false));
-		attachment->set_color_blend_op((RD::BlendOperation)(int)map_get2(p_data, vformat("attachment%d_color_blend_op", i), "attachment_color_blend_op", RD::BLEND_OP_ADD));
-		attachment->set_alpha_blend_op((RD::BlendOperation)(int)map_get2(p_data, vformat("attachment%d_alpha_blend_op", i), "attachment_alpha_blend_op", RD::BLEND_OP_ADD));
-		attachment->set_src_color_blend_factor((RD::BlendFactor)(int)map_get2(p_data, vformat("attachment%d_src_color_blend_factor", i), "attachment_src_color_blend_factor", RD::BLEND_FACTOR_ZERO));
-		attachment->set_src_alpha_blend_factor((RD::BlendFactor)(int)map_get2(p_data, vformat("attachment%d_src_alpha_blend_factor", i), "attachment_src_alpha_blend_factor", RD::BLEND_FACTOR_ZERO));
-		attachment->set_dst_color_blend_factor((RD::BlendFactor)(int)map_get2(p_data, vformat("attachment%d_dst_color_blend_factor", i), "attachment_dst_color_blend_factor", RD::BLEND_FACTOR_ZERO));
-		attachment->set_dst_alpha_blend_factor((RD::BlendFactor)(int)map_get2(p_data, vformat("attachment%d_dst_alpha_blend_factor", i), "attachment_dst_alpha_blend_factor", RD::BLEND_FACTOR_ZERO));
+		attachment->set_enable_blend(p_data.blend.enable_blend);
+		attachment->set_color_blend_op(p_data.blend.color_blend_op);
+		attachment->set_alpha_blend_op(p_data.blend.alpha_blend_op);
+		attachment->set_src_color_blend_factor(p_data.blend.src_color_blend_factor);
+		attachment->set_src_alpha_blend_factor(p_data.blend.src_alpha_blend_factor);
+		attachment->set_dst_color_blend_factor(p_data.blend.dst_color_blend_factor);
+		attachment->set_dst_alpha_blend_factor(p_data.blend.dst_alpha_blend_factor);
 
 		attachments.append(attachment);
 	}
     color_blend_state->set_attachments(attachments);
 
 	RID rid = rendering_device->render_pipeline_create(
-        map_get(p_data, "shader", RID()), 
-		map_get(p_data, "framebuffer_format", -1),
-        map_get(p_data, "vertex_format", -1),
-       	(RD::RenderPrimitive)(int)map_get(p_data, "primitive", RD::RENDER_PRIMITIVE_TRIANGLES),
+        p_data.shader, 
+		p_data.framebuffer_format,
+        p_data.vertex_format,
+       	p_data.primitive,
         rasterization_state,
         multisample_state,
         depth_stencil_state,
@@ -220,33 +412,29 @@ RID RenderingResources::create_render_pipeline(const std::map<String, Variant> &
 	return rid;
 }
 
-RID RenderingResources::create_compute_pipeline(const std::map<String, Variant> &p_data) {
-	RID rid = rendering_device->compute_pipeline_create(
-        map_get(p_data, "shader", RID())
-    );
+RID RenderingResources::create_compute_pipeline(const ComputePipelineDesc &p_data) {
+	RID rid = rendering_device->compute_pipeline_create(p_data.shader);
 	ERR_FAIL_COND_V(!rid.is_valid(), RID());
 
    	map_resource(rid, compute_pipeline_map);
 	return rid;
 }
 
-RID RenderingResources::create_vertex_buffer(const std::map<String, Variant> &p_data) {
-	PackedByteArray data = (PackedByteArray)map_get(p_data, "data", PackedByteArray());
+RID RenderingResources::create_vertex_buffer(const VertexBufferDesc &p_data) {
+	uint32_t size = p_data.size != 0 ? p_data.size : p_data.data.size();
 
-	RID rid = rendering_device->vertex_buffer_create(data.size(), data);
+	RID rid = rendering_device->vertex_buffer_create(size, p_data.data);
 	ERR_FAIL_COND_V(!rid.is_valid(), RID());
 
    	map_resource(rid, vertex_buffer_map);
 	return rid;
 }
 
-RID RenderingResources::create_index_buffer(const std::map<String, Variant> &p_data) {
-	PackedByteArray data = (PackedByteArray)map_get(p_data, "data", PackedByteArray());
-
+RID RenderingResources::create_index_buffer(const IndexBufferDesc &p_data) {
 	RID rid = rendering_device->index_buffer_create(
-		map_get(p_data, "count",0), 
-		(RD::IndexBufferFormat)(int)map_get(p_data, "format", RD::INDEX_BUFFER_FORMAT_UINT32),
-		data
+		p_data.count, 
+		p_data.format,
+		p_data.data
 	);
 	ERR_FAIL_COND_V(!rid.is_valid(), RID());
 
@@ -254,11 +442,11 @@ RID RenderingResources::create_index_buffer(const std::map<String, Variant> &p_d
 	return rid;
 }
 
-RID RenderingResources::create_vertex_array(const std::map<String, Variant> &p_data) {
+RID RenderingResources::create_vertex_array(const VertexArrayDesc &p_data) {
 	RID rid = rendering_device->vertex_array_create(
-		map_get(p_data, "count", 0), 
-		map_get(p_data, "format", -1), 
-		map_get(p_data, "buffers", TypedArray<RID>())
+		p_data.count, 
+		p_data.format, 
+		to_rid_array(p_data.buffers)
 	);
 	ERR_FAIL_COND_V(!rid.is_valid(), RID());
 
@@ -266,11 +454,11 @@ RID RenderingResources::create_vertex_array(const std::map<String, Variant> &p_d
 	return rid;
 }
 
-RID RenderingResources::create_index_array(const std::map<String, Variant> &p_data) {
+RID RenderingResources::create_index_array(const IndexArrayDesc &p_data) {
 	RID rid = rendering_device->index_array_create(
-		map_get(p_data, "buffer", RID()), 
-		map_get(p_data, "offset", 0), 
-		map_get(p_data, "count", 0)
+		p_data.buffer, 
+		p_data.offset, 
+		p_data.count
 	);
 	ERR_FAIL_COND_V(!rid.is_valid(), RID());
 
@@ -278,12 +466,10 @@ RID RenderingResources::create_index_array(const std::map<String, Variant> &p_da
 	return rid;
 }
 
-RID RenderingResources::create_storage_buffer(const std::map<String, Variant> &p_data) {
-	PackedByteArray data = (PackedByteArray)map_get(p_data, "data", PackedByteArray());
-
+RID RenderingResources::create_storage_buffer(const StorageBufferDesc &p_data) {
 	RID rid = rendering_device->storage_buffer_create(
-		data.size(), 
-		data
+		p_data.data.size(), 
+		p_data.data
 	);
 	ERR_FAIL_COND_V(!rid.is_valid(), RID());
 
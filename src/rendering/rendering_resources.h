@@ -1,68 +1,215 @@
 #pragma once
 
 #include <map>
-#include <set>
-#include <functional>
+#include <vector>
 
 #include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/rendering_device.hpp>
 #include <godot_cpp/classes/texture.hpp>
+#include <godot_cpp/classes/rd_shader_spirv.hpp>
 #include <godot_cpp/templates/vector.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
 
 namespace godot {
 
-#define DEFINE_RENDERING_RESOURCE(p_name) \
-private: ResourceMap p_name ##_map = ResourceMap(#p_name); std::map<uint64_t, RID> p_name ##_cache;\
+// Descriptors of the resources RenderingResources creates, defaults match RenderingDevice's.
+// The ones of cached resources hash and compare their whole content, see get_or_create_*
+
+struct SamplerDesc {
+	RenderingDevice::SamplerFilter min_filter = RenderingDevice::SAMPLER_FILTER_NEAREST;
+	RenderingDevice::SamplerFilter mag_filter = RenderingDevice::SAMPLER_FILTER_NEAREST;
+	RenderingDevice::SamplerRepeatMode repeat_u = RenderingDevice::SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE;
+	RenderingDevice::SamplerRepeatMode repeat_v = RenderingDevice::SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE;
+	RenderingDevice::SamplerRepeatMode repeat_w = RenderingDevice::SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE;
+	RenderingDevice::SamplerBorderColor border_color = RenderingDevice::SAMPLER_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+
+	uint32_t hash() const;
+	bool operator==(const SamplerDesc &p_other) const;
+};
+
+struct TextureDesc {
+	RenderingDevice::TextureType texture_type = RenderingDevice::TEXTURE_TYPE_2D;
+	uint32_t width = 1;
+	uint32_t height = 1;
+	RenderingDevice::DataFormat format = RenderingDevice::DATA_FORMAT_R8G8B8A8_UNORM;
+	uint64_t usage_bits = RenderingDevice::TEXTURE_USAGE_SAMPLING_BIT;
+	RenderingDevice::TextureSwizzle swizzle_r = RenderingDevice::TEXTURE_SWIZZLE_R;
+	RenderingDevice::TextureSwizzle swizzle_g = RenderingDevice::TEXTURE_SWIZZLE_G;
+	RenderingDevice::TextureSwizzle swizzle_b = RenderingDevice::TEXTURE_SWIZZLE_B;
+	RenderingDevice::TextureSwizzle swizzle_a = RenderingDevice::TEXTURE_SWIZZLE_A;
+	// Initial content of the single layer, left empty for uninitialized textures
+	PackedByteArray data;
+
+	uint32_t hash() const;
+	bool operator==(const TextureDesc &p_other) const;
+};
+
+struct FramebufferDesc {
+	std::vector<RID> textures;
+
+	uint32_t hash() const;
+	bool operator==(const FramebufferDesc &p_other) const;
+};
+
+struct ShaderDesc {
+	String path;
+	String name;
+
+	uint32_t hash() const;
+	bool operator==(const ShaderDesc &p_other) const;
+};
+
+struct StencilOpDesc {
+	uint32_t reference = 0;
+	uint32_t write_mask = 0;
+	uint32_t compare_mask = 0;
+	RenderingDevice::CompareOperator compare = RenderingDevice::COMPARE_OP_ALWAYS;
+	RenderingDevice::StencilOperation pass = RenderingDevice::STENCIL_OP_ZERO;
+	RenderingDevice::StencilOperation fail = RenderingDevice::STENCIL_OP_ZERO;
+
+	bool operator==(const StencilOpDesc &p_other) const;
+};
+
+struct BlendAttachmentDesc {
+	bool enable_blend = false;
+	RenderingDevice::BlendOperation color_blend_op = RenderingDevice::BLEND_OP_ADD;
+	RenderingDevice::BlendOperation alpha_blend_op = RenderingDevice::BLEND_OP_ADD;
+	RenderingDevice::BlendFactor src_color_blend_factor = RenderingDevice::BLEND_FACTOR_ZERO;
+	RenderingDevice::BlendFactor dst_color_blend_factor = RenderingDevice::BLEND_FACTOR_ZERO;
+	RenderingDevice::BlendFactor src_alpha_blend_factor = RenderingDevice::BLEND_FACTOR_ZERO;
+	RenderingDevice::BlendFactor dst_alpha_blend_factor = RenderingDevice::BLEND_FACTOR_ZERO;
+
+	bool operator==(const BlendAttachmentDesc &p_other) const;
+};
+
+struct RenderPipelineDesc {
+	RID shader;
+	int64_t framebuffer_format = -1;
+	int64_t vertex_format = -1;
+	RenderingDevice::RenderPrimitive primitive = RenderingDevice::RENDER_PRIMITIVE_TRIANGLES;
+
+	bool enable_stencil = false;
+	StencilOpDesc front_stencil;
+	StencilOpDesc back_stencil;
+
+	// Every attachment blends the same way
+	uint32_t attachment_count = 1;
+	BlendAttachmentDesc blend;
+
+	void set_stencil(const StencilOpDesc &p_op) {
+		enable_stencil = true;
+		front_stencil = p_op;
+		back_stencil = p_op;
+	}
+
+	uint32_t hash() const;
+	bool operator==(const RenderPipelineDesc &p_other) const;
+};
+
+struct ComputePipelineDesc {
+	RID shader;
+
+	uint32_t hash() const;
+	bool operator==(const ComputePipelineDesc &p_other) const;
+};
+
+struct VertexBufferDesc {
+	// Defaults to the size of data
+	uint32_t size = 0;
+	PackedByteArray data;
+};
+
+struct IndexBufferDesc {
+	uint32_t count = 0;
+	RenderingDevice::IndexBufferFormat format = RenderingDevice::INDEX_BUFFER_FORMAT_UINT32;
+	PackedByteArray data;
+};
+
+struct VertexArrayDesc {
+	uint32_t count = 0;
+	int64_t format = -1;
+	std::vector<RID> buffers;
+};
+
+struct IndexArrayDesc {
+	RID buffer;
+	uint32_t offset = 0;
+	uint32_t count = 0;
+};
+
+struct StorageBufferDesc {
+	PackedByteArray data;
+};
+
+#define DEFINE_RENDERING_RESOURCE(p_name, p_desc) \
+private: ResourceMap p_name ##_map = ResourceMap(#p_name);\
+public: \
+	RID create_##p_name(const p_desc &p_data = p_desc());\
+	void free_##p_name(const RID &p_id);
+
+// Cached resources are shared by every get_or_create_* call with an equal descriptor,
+// and freed once free_* was called as many times as they were handed out
+#define DEFINE_CACHED_RENDERING_RESOURCE(p_name, p_desc) \
+	DEFINE_RENDERING_RESOURCE(p_name, p_desc) \
+private: ResourceCache<p_desc> p_name ##_cache;\
 public: \
-	RID create_##p_name(const std::map<String, Variant> &p_data = std::map<String, Variant>());\
-	void free_##p_name(const RID &p_id); \
-	RID get_or_create_##p_name(uint64_t p_id, const std::function<std::map<String, Variant>()> &p_get_data);
+	RID get_or_create_##p_name(const p_desc &p_data);
 
 class RenderingResources {
 private:
 	struct ResourceMap {
-		std::set<RID> resources;
+		HashSet<RID> resources;
 		String resource_name;
 
-		void insert(const RID &p_rid) {
-			resources.insert(p_rid);
-		}
-
-		void erase(const RID &p_rid) {
-			resources.erase(p_rid);
+		ResourceMap() {}
+		ResourceMap(const String &p_name) {
+			resource_name = p_name;
 		}
+	};
 
-		std::set<RID>::iterator begin() {
-			return resources.begin();
-		}
+	struct DescHasher {
+		template <class T>
+		static uint32_t hash(const T &p_desc) { return p_desc.hash(); }
+	};
 
-		std::set<RID>::iterator end() {
-			return resources.end();
-		}
+	template <class T>
+	struct ResourceCache {
+		struct Entry {
+			RID rid;
+			uint32_t users = 0;
+		};
 
-		std::set<RID>::iterator find(const RID &p_rid) {
-			return resources.find(p_rid);
-		}
+		HashMap<T, Entry, DescHasher> entries;
+		// Descriptors of the cached resources, to find their entry when they're freed
+		HashMap<RID, T> descs;
 
-		std::set<RID>::const_iterator find(const RID &p_rid) const {
-			return resources.find(p_rid);
+		RID acquire(const T &p_desc) {
+			Entry *entry = entries.getptr(p_desc);
+			if (entry == nullptr) return RID();
+			entry->users++;
+			return entry->rid;
 		}
 
-		std::set<RID>::const_iterator begin() const {
-			return resources.begin();
+		void insert(const T &p_desc, const RID &p_rid) {
+			entries.insert(p_desc, { p_rid, 1 });
+			descs.insert(p_rid, p_desc);
 		}
 
-		std::set<RID>::const_iterator end() const {
-			return resources.end();
+		// Whether the resource isn't cached or this was its last user
+		bool release(const RID &p_rid) {
+			const T *desc = descs.getptr(p_rid);
+			if (desc == nullptr) return true;
+			Entry *entry = entries.getptr(*desc);
+			if (--entry->users > 0) return false;
+			entries.erase(*desc);
+			descs.erase(p_rid);
+			return true;
 		}
 
 		void clear() {
-			resources.clear();
-		}
-
-		ResourceMap() {}
-		ResourceMap(const String &p_name) {
-			resource_name = p_name;
+			entries.clear();
+			descs.clear();
 		}
 	};
 
@@ -72,21 +219,32 @@ private:
 	void free_resource(const RID &p_rid, ResourceMap &p_map);
 	void free_all_resources(ResourceMap &p_map);
 
+	// Directory compiled shader bytecode is cached in, empty to always compile from SPIR-V
+	String shader_cache_path;
+	uint32_t shader_cache_hits = 0;
+	uint32_t shader_cache_misses = 0;
+
+	RID create_shader_from_cache(const Ref<RDShaderSPIRV> &p_spirv, const String &p_name);
+
 public:
-	DEFINE_RENDERING_RESOURCE(sampler)
-	DEFINE_RENDERING_RESOURCE(texture)
-	DEFINE_RENDERING_RESOURCE(framebuffer)
-	DEFINE_RENDERING_RESOURCE(shader)
-	DEFINE_RENDERING_RESOURCE(render_pipeline)
-	DEFINE_RENDERING_RESOURCE(compute_pipeline)
-	DEFINE_RENDERING_RESOURCE(vertex_buffer)
-	DEFINE_RENDERING_RESOURCE(index_buffer)
-	DEFINE_RENDERING_RESOURCE(vertex_array)
-	DEFINE_RENDERING_RESOURCE(index_array)
-	DEFINE_RENDERING_RESOURCE(storage_buffer)
+	DEFINE_CACHED_RENDERING_RESOURCE(sampler, SamplerDesc)
+	DEFINE_CACHED_RENDERING_RESOURCE(texture, TextureDesc)
+	DEFINE_CACHED_RENDERING_RESOURCE(framebuffer, FramebufferDesc)
+	DEFINE_CACHED_RENDERING_RESOURCE(shader, ShaderDesc)
+	DEFINE_CACHED_RENDERING_RESOURCE(render_pipeline, RenderPipelineDesc)
+	DEFINE_CACHED_RENDERING_RESOURCE(compute_pipeline, ComputePipelineDesc)
+	DEFINE_RENDERING_RESOURCE(vertex_buffer, VertexBufferDesc)
+	DEFINE_RENDERING_RESOURCE(index_buffer, IndexBufferDesc)
+	DEFINE_RENDERING_RESOURCE(vertex_array, VertexArrayDesc)
+	DEFINE_RENDERING_RESOURCE(index_array, IndexArrayDesc)
+	DEFINE_RENDERING_RESOURCE(storage_buffer, StorageBufferDesc)
 
 	RenderingDevice *device() const { return rendering_device; }
 
+	void set_shader_cache_path(const String &p_path) { shader_cache_path = p_path; }
+	uint32_t get_shader_cache_hits() const { return shader_cache_hits; }
+	uint32_t get_shader_cache_misses() const { return shader_cache_misses; }
+
 	void free_all_resources();
 
 	RenderingResources() {}
@@ -94,6 +252,7 @@ public:
 	~RenderingResources();
 };
 
+#undef DEFINE_CACHED_RENDERING_RESOURCE
 #undef DEFINE_RENDERING_RESOURCE
 
-}
\ No newline at end of file
+}
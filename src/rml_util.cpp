@@ -76,4 +76,76 @@ Variant godot::rml_to_godot_variant(const Rml::Variant &p_var) {
 			ERR_FAIL_V_MSG(Variant(), vformat("Unimplemented for RML variant type %d", p_var.GetType()));
 		} break;
 	}
-}
\ No newline at end of file
+}
+
+bool godot::rml_filter_color_matrix(const Rml::String &p_name, const Rml::Dictionary &p_parameters, Rml::Matrix4f &r_matrix) {
+	if (p_name == "opacity") {
+		const float value = Rml::Get(p_parameters, "value", 1.f);
+
+		r_matrix = Rml::Matrix4f::Diag(1.f, 1.f, 1.f, value);
+	} else if (p_name == "brightness") {
+		const float value = Rml::Get(p_parameters, "value", 1.f);
+
+		r_matrix = Rml::Matrix4f::Diag(value, value, value, 1.f);
+	} else if (p_name == "contrast") {
+		const float value = Rml::Get(p_parameters, "value", 1.f);
+		const float gray = 0.5f - 0.5f * value;
+
+		r_matrix = Rml::Matrix4f::Diag(value, value, value, 1.0f);
+		r_matrix.SetColumn(3, Rml::Vector4f(gray, gray, gray, 1.0f));
+	} else if (p_name == "invert") {
+		const float value = Rml::Get(p_parameters, "value", 0.f);
+		const float inverted = 1.f - 2.f * value;
+
+		r_matrix = Rml::Matrix4f::Diag(inverted, inverted, inverted, 1.f);
+		r_matrix.SetColumn(3, Rml::Vector4f(value, value, value, 1.f));
+	} else if (p_name == "grayscale") {
+		const float value = Rml::Get(p_parameters, "value", 1.f);
+		const float rev_value = 1.f - value;
+		const Rml::Vector3f gray = value * Rml::Vector3f(0.2126f, 0.7152f, 0.0722f);
+
+		r_matrix = Rml::Matrix4f::FromRows(
+			{gray.x + rev_value, gray.y,             gray.z,             0.f},
+			{gray.x,             gray.y + rev_value, gray.z,             0.f},
+			{gray.x,             gray.y,             gray.z + rev_value, 0.f},
+			{0.f,                0.f,                0.f,                1.f}
+		);
+	} else if (p_name == "sepia") {
+		const float value = Rml::Get(p_parameters, "value", 1.f);
+		const float rev_value = 1.f - value;
+		const Rml::Vector3f r_mix = value * Rml::Vector3f(0.393f, 0.769f, 0.189f);
+		const Rml::Vector3f g_mix = value * Rml::Vector3f(0.349f, 0.686f, 0.168f);
+		const Rml::Vector3f b_mix = value * Rml::Vector3f(0.272f, 0.534f, 0.131f);
+
+		r_matrix = Rml::Matrix4f::FromRows(
+			{r_mix.x + rev_value, r_mix.y,             r_mix.z,             0.f},
+			{g_mix.x,             g_mix.y + rev_value, g_mix.z,             0.f},
+			{b_mix.x,             b_mix.y,             b_mix.z + rev_value, 0.f},
+			{0.f,                 0.f,                 0.f,                 1.f}
+		);
+	} else if (p_name == "hue-rotate") {
+		const float value = Rml::Get(p_parameters, "value", 0.f);
+		const float s = Rml::Math::Sin(value);
+		const float c = Rml::Math::Cos(value);
+
+		// Linear hue rotation as specified for CSS and SVG filters, so it can be fused
+		r_matrix = Rml::Matrix4f::FromRows(
+			{0.213f + 0.787f * c - 0.213f * s,  0.715f - 0.715f * c - 0.715f * s,  0.072f - 0.072f * c + 0.928f * s,  0.f},
+			{0.213f - 0.213f * c + 0.143f * s,  0.715f + 0.285f * c + 0.140f * s,  0.072f - 0.072f * c - 0.283f * s,  0.f},
+			{0.213f - 0.213f * c - 0.787f * s,  0.715f - 0.715f * c + 0.715f * s,  0.072f + 0.928f * c + 0.072f * s,  0.f},
+			{0.f,                               0.f,                               0.f,                               1.f}
+		);
+	} else if (p_name == "saturate") {
+		const float value = Rml::Get(p_parameters, "value", 1.f);
+
+		r_matrix = Rml::Matrix4f::FromRows(
+			{0.213f + 0.787f * value,  0.715f - 0.715f * value,  0.072f - 0.072f * value,  0.f},
+			{0.213f - 0.213f * value,  0.715f + 0.285f * value,  0.072f - 0.072f * value,  0.f},
+			{0.213f - 0.213f * value,  0.715f - 0.715f * value,  0.072f + 0.928f * value,  0.f},
+			{0.f,                      0.f,                      0.f,                      1.f}
+		);
+	} else {
+		return false;
+	}
+	return true;
+}
@@ -8,6 +8,8 @@
 
 #include <godot_cpp/classes/global_constants.hpp>
 #include <RmlUi/Core/Input.h>
+#include <RmlUi/Core/Dictionary.h>
+#include <RmlUi/Core/Types.h>
 
 namespace godot {
 
@@ -23,5 +25,9 @@ Key rml_to_godot_key(const Rml::Input::KeyIdentifier &p_key);
 Rml::Input::KeyModifier godot_to_rml_key_modifiers(const BitField<KeyModifierMask> &p_mod);
 BitField<KeyModifierMask> rml_to_godot_key_modifiers(const Rml::Input::KeyModifier &p_mod);
 
+// Matrix applied to premultiplied colors by the filters expressible as one,
+// returns false for the other filters
+bool rml_filter_color_matrix(const Rml::String &p_name, const Rml::Dictionary &p_parameters, Rml::Matrix4f &r_matrix);
+
 }
 
@@ -10,6 +10,9 @@
 #include <godot_cpp/classes/font_file.hpp>
 #include <godot_cpp/classes/theme_db.hpp>
 #include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/performance.hpp>
+#include <godot_cpp/classes/time.hpp>
 #include "../interface/render_interface_godot.h"
 #include "../interface/system_interface_godot.h"
 #include "../plugin/rml_godot_plugin.h"
@@ -22,6 +25,20 @@ using namespace godot;
 
 RMLServer *RMLServer::singleton = nullptr;
 
+// Stats exposed as Performance monitors, times are shown in milliseconds
+static const char *MONITOR_STATS[] = {
+	"update_usec",
+	"render_usec",
+	"input_usec",
+	"render_passes",
+	"draw_calls",
+	"geometry_compiled",
+	"geometry_released",
+	"textures_generated",
+	"layers_pushed",
+	"submission_allocations"
+};
+
 RMLServer *RMLServer::get_singleton() {
 	return singleton;
 }
@@ -42,50 +59,180 @@ void RMLServer::load_resources() {
 }
 
 void RMLServer::initialize() {
-	RenderInterfaceGodot *ri = dynamic_cast<RenderInterfaceGodot *>(Rml::GetRenderInterface());
-	ERR_FAIL_NULL_MSG(ri, "Render interface configured is not of type RenderInterfaceGodot");
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_MSG(ri, "No RenderInterfaceGodot is configured");
 	ri->initialize();
 
+	Performance *performance = Performance::get_singleton();
+	for (const char *stat : MONITOR_STATS) {
+		String monitor = "RmlUi/" + String(stat).replace("_usec", "_ms");
+		performance->add_custom_monitor(monitor, callable_mp(this, &RMLServer::get_monitor).bind(String(stat)));
+	}
+
 	Rml::Log::Message(Rml::Log::LT_INFO, "RMLServer initialized.");
 }
 
 void RMLServer::uninitialize() {
-	RenderInterfaceGodot *ri = dynamic_cast<RenderInterfaceGodot *>(Rml::GetRenderInterface());
-	ERR_FAIL_NULL_MSG(ri, "Render interface configured is not of type RenderInterfaceGodot");
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_MSG(ri, "No RenderInterfaceGodot is configured");
+	ri->free_context(replay_context);
 	ri->finalize();
 
+	Performance *performance = Performance::get_singleton();
+	for (const char *stat : MONITOR_STATS) {
+		String monitor = "RmlUi/" + String(stat).replace("_usec", "_ms");
+		if (performance->has_custom_monitor(monitor)) {
+			performance->remove_custom_monitor(monitor);
+		}
+	}
+
 	Rml::Log::Message(Rml::Log::LT_INFO, "RMLServer uninitialized.");
 }
 
-RID RMLServer::initialize_document() {
-	RenderInterfaceGodot *ri = dynamic_cast<RenderInterfaceGodot *>(Rml::GetRenderInterface());
-	ERR_FAIL_NULL_V_MSG(ri, RID(), "Render interface configured is not of type RenderInterfaceGodot");
-
-	RID new_rid = document_owner.make_rid();
+RID RMLServer::initialize_context() {
+	RID new_rid = context_owner.make_rid();
 	String context_id = vformat("godot_context_%d", new_rid.get_id());
-	DocumentData *doc_data = document_owner.get_or_null(new_rid);
-	doc_data->ctx = Rml::CreateContext(
+	ContextData *ctx_data = context_owner.get_or_null(new_rid);
+	ctx_data->ctx = Rml::CreateContext(
 		godot_to_rml_string(context_id),
 		Rml::Vector2i(1, 1)
 	);
-	
-	if (doc_data->ctx == nullptr) {
-		document_owner.free(new_rid);
+
+	if (ctx_data->ctx == nullptr) {
+		context_owner.free(new_rid);
 		ERR_FAIL_V_MSG(RID(), "Couldn't create the context");
 	}
 
 	return new_rid;
 }
 
-RID RMLServer::create_document() {
-	RID new_rid = initialize_document();
+void RMLServer::finalize_context(const RID &p_context) {
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_MSG(ri, "No RenderInterfaceGodot is configured");
+
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL(ctx_data);
+
+	Rml::RemoveContext(ctx_data->ctx->GetName());
+	ri->free_context(ctx_data->draw_context);
+
+	context_owner.free(p_context);
+}
+
+RID RMLServer::initialize_document(const RID &p_context) {
+	RID context = p_context;
+	if (context.is_valid()) {
+		ERR_FAIL_COND_V(!context_owner.owns(context), RID());
+		ERR_FAIL_COND_V_MSG(context_owner.get_or_null(context)->pending_free, RID(), "Context was already freed");
+	} else {
+		context = initialize_context();
+		ERR_FAIL_COND_V(!context.is_valid(), RID());
+		context_owner.get_or_null(context)->implicit = true;
+	}
+
+	RID new_rid = document_owner.make_rid();
+	DocumentData *doc_data = document_owner.get_or_null(new_rid);
+	doc_data->context = context;
+
+	ContextData *ctx_data = context_owner.get_or_null(context);
+	ctx_data->document_count++;
+
+	return new_rid;
+}
+
+void RMLServer::finalize_document(const RID &p_document) {
+	DocumentData *doc_data = document_owner.get_or_null(p_document);
+	ERR_FAIL_NULL(doc_data);
+	RID context = doc_data->context;
+	ContextData *ctx_data = context_owner.get_or_null(context);
+
+	if (doc_data->doc != nullptr && !ctx_data->implicit) {
+		doc_data->doc->Close();
+		ctx_data->ctx->RequestNextUpdate(0);
+	}
+	document_owner.free(p_document);
+
+	ctx_data->document_count--;
+	if (ctx_data->document_count == 0 && (ctx_data->implicit || ctx_data->pending_free)) {
+		finalize_context(context);
+	}
+}
+
+RMLServer::ContextData *RMLServer::get_document_context(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), nullptr);
+	DocumentData *doc_data = document_owner.get_or_null(p_document);
+	ERR_FAIL_NULL_V(doc_data, nullptr);
+	return context_owner.get_or_null(doc_data->context);
+}
+
+RMLServer::FrameStats &RMLServer::get_frame_stats(FrameStats &p_stats) {
+	uint64_t frame = Engine::get_singleton()->get_process_frames();
+	if (p_stats.frame != frame) {
+		p_stats = FrameStats();
+		p_stats.frame = frame;
+	}
+	return p_stats;
+}
+
+void RMLServer::record_stats(ContextData *p_ctx_data, uint64_t FrameStats::*p_time, uint64_t p_start_usec, const RenderInterfaceGodot::RenderStats &p_render_start) {
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL(ri);
+
+	uint64_t elapsed = Time::get_singleton()->get_ticks_usec() - p_start_usec;
+	const RenderInterfaceGodot::RenderStats &render = ri->get_stats();
+
+	for (FrameStats *stats : { &get_frame_stats(p_ctx_data->stats), &get_frame_stats(frame_stats) }) {
+		stats->*p_time += elapsed;
+		stats->render.render_passes += render.render_passes - p_render_start.render_passes;
+		stats->render.draw_calls += render.draw_calls - p_render_start.draw_calls;
+		stats->render.geometry_compiled += render.geometry_compiled - p_render_start.geometry_compiled;
+		stats->render.geometry_released += render.geometry_released - p_render_start.geometry_released;
+		stats->render.textures_generated += render.textures_generated - p_render_start.textures_generated;
+		stats->render.layers_pushed += render.layers_pushed - p_render_start.layers_pushed;
+		stats->render.submission_allocations += render.submission_allocations - p_render_start.submission_allocations;
+	}
+}
+
+Dictionary RMLServer::stats_to_dictionary(const FrameStats &p_stats) {
+	Dictionary dict;
+	dict["frame"] = p_stats.frame;
+	dict["update_usec"] = p_stats.update_usec;
+	dict["render_usec"] = p_stats.render_usec;
+	dict["input_usec"] = p_stats.input_usec;
+	dict["render_passes"] = p_stats.render.render_passes;
+	dict["draw_calls"] = p_stats.render.draw_calls;
+	dict["geometry_compiled"] = p_stats.render.geometry_compiled;
+	dict["geometry_released"] = p_stats.render.geometry_released;
+	dict["textures_generated"] = p_stats.render.textures_generated;
+	dict["layers_pushed"] = p_stats.render.layers_pushed;
+	dict["submission_allocations"] = p_stats.render.submission_allocations;
+	return dict;
+}
+
+double RMLServer::get_monitor(const String &p_key) {
+	// Monitors are sampled once per frame, either before or after the UI of the frame ran
+	if (frame_stats.frame + 1 < Engine::get_singleton()->get_process_frames()) {
+		return 0.0;
+	}
+	double value = stats_to_dictionary(frame_stats)[p_key];
+	return p_key.ends_with("_usec") ? value / 1000.0 : value;
+}
+
+RID RMLServer::create_context() {
+	RID new_rid = initialize_context();
+	ERR_FAIL_COND_V(!new_rid.is_valid(), RID());
+	return new_rid;
+}
+
+RID RMLServer::create_document(const RID &p_context) {
+	RID new_rid = initialize_document(p_context);
 	ERR_FAIL_COND_V(!new_rid.is_valid(), RID());
 	DocumentData *doc_data = document_owner.get_or_null(new_rid);
+	ContextData *ctx_data = context_owner.get_or_null(doc_data->context);
 
-	doc_data->doc = doc_data->ctx->CreateDocument();
+	doc_data->doc = ctx_data->ctx->CreateDocument();
 	if (doc_data->doc == nullptr) {
-		Rml::RemoveContext(doc_data->ctx->GetName());
-		document_owner.free(new_rid);
+		finalize_document(new_rid);
 		ERR_FAIL_V_MSG(RID(), "Couldn't create the document");
 		return RID();
 	}
@@ -95,15 +242,15 @@ RID RMLServer::create_document() {
 	return new_rid;
 }
 
-RID RMLServer::create_document_from_rml_string(const String &p_string) {
-	RID new_rid = initialize_document();
+RID RMLServer::create_document_from_rml_string(const String &p_string, const RID &p_context) {
+	RID new_rid = initialize_document(p_context);
 	ERR_FAIL_COND_V(!new_rid.is_valid(), RID());
 	DocumentData *doc_data = document_owner.get_or_null(new_rid);
+	ContextData *ctx_data = context_owner.get_or_null(doc_data->context);
 
-	doc_data->doc = doc_data->ctx->LoadDocumentFromMemory(godot_to_rml_string(p_string));
+	doc_data->doc = ctx_data->ctx->LoadDocumentFromMemory(godot_to_rml_string(p_string));
 	if (doc_data->doc == nullptr) {
-		Rml::RemoveContext(doc_data->ctx->GetName());
-		document_owner.free(new_rid);
+		finalize_document(new_rid);
 		ERR_FAIL_V_MSG(RID(), "Couldn't create the document");
 		return RID();
 	}
@@ -113,15 +260,15 @@ RID RMLServer::create_document_from_rml_string(const String &p_string) {
 	return new_rid;
 }
 
-RID RMLServer::create_document_from_path(const String &p_path) {
-	RID new_rid = initialize_document();
+RID RMLServer::create_document_from_path(const String &p_path, const RID &p_context) {
+	RID new_rid = initialize_document(p_context);
 	ERR_FAIL_COND_V(!new_rid.is_valid(), RID());
 	DocumentData *doc_data = document_owner.get_or_null(new_rid);
+	ContextData *ctx_data = context_owner.get_or_null(doc_data->context);
 
-	doc_data->doc = doc_data->ctx->LoadDocument(godot_to_rml_string(p_path));
+	doc_data->doc = ctx_data->ctx->LoadDocument(godot_to_rml_string(p_path));
 	if (doc_data->doc == nullptr) {
-		Rml::RemoveContext(doc_data->ctx->GetName());
-		document_owner.free(new_rid);
+		finalize_document(new_rid);
 		ERR_FAIL_V_MSG(RID(), "Couldn't create the document");
 		return RID();
 	}
@@ -149,45 +296,201 @@ Ref<RMLElement> RMLServer::create_element(const RID &p_document, const String &p
 	return RMLElement::ref(doc_data->doc->CreateElement(tag_name));
 }
 
-void RMLServer::document_update(const RID &p_document) {
+RID RMLServer::document_get_context(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), RID());
+	DocumentData *doc_data = document_owner.get_or_null(p_document);
+	ERR_FAIL_NULL_V(doc_data, RID());
+
+	return doc_data->context;
+}
+
+void RMLServer::document_set_rect(const RID &p_document, const Rect2i &p_rect) {
 	ERR_FAIL_COND(!document_owner.owns(p_document));
 	DocumentData *doc_data = document_owner.get_or_null(p_document);
 	ERR_FAIL_NULL(doc_data);
-	doc_data->ctx->Update();
+
+	// Documents are absolutely positioned inside their context
+	doc_data->doc->SetProperty(Rml::PropertyId::Left, Rml::Property(p_rect.position.x, Rml::Unit::PX));
+	doc_data->doc->SetProperty(Rml::PropertyId::Top, Rml::Property(p_rect.position.y, Rml::Unit::PX));
+	doc_data->doc->SetProperty(Rml::PropertyId::Width, Rml::Property(p_rect.size.x, Rml::Unit::PX));
+	doc_data->doc->SetProperty(Rml::PropertyId::Height, Rml::Property(p_rect.size.y, Rml::Unit::PX));
+	context_owner.get_or_null(doc_data->context)->ctx->RequestNextUpdate(0);
 }
 
-void RMLServer::document_set_size(const RID &p_document, const Vector2i &p_size) {
+void RMLServer::document_set_z_index(const RID &p_document, int p_z_index) {
 	ERR_FAIL_COND(!document_owner.owns(p_document));
 	DocumentData *doc_data = document_owner.get_or_null(p_document);
 	ERR_FAIL_NULL(doc_data);
-	doc_data->ctx->SetDimensions(Rml::Vector2i(
+
+	doc_data->doc->SetProperty(Rml::PropertyId::ZIndex, Rml::Property(p_z_index, Rml::Unit::NUMBER));
+	context_owner.get_or_null(doc_data->context)->ctx->RequestNextUpdate(0);
+}
+
+bool RMLServer::document_update(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), false);
+	return context_update(document_owner.get_or_null(p_document)->context);
+}
+
+bool RMLServer::document_needs_update(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), false);
+	return context_needs_update(document_owner.get_or_null(p_document)->context);
+}
+
+void RMLServer::document_set_size(const RID &p_document, const Vector2i &p_size) {
+	ERR_FAIL_COND(!document_owner.owns(p_document));
+	ContextData *ctx_data = get_document_context(p_document);
+	ERR_FAIL_NULL(ctx_data);
+	ERR_FAIL_COND_MSG(!ctx_data->implicit, "Document shares its context, use context_set_size or document_set_rect instead");
+
+	context_set_size(document_owner.get_or_null(p_document)->context, p_size);
+}
+
+bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEvent> &p_event) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), false);
+	return context_process_event(document_owner.get_or_null(p_document)->context, p_event);
+}
+
+void RMLServer::document_set_cursor_shape(const RID &p_document, const Input::CursorShape &p_shape) {
+	ERR_FAIL_COND(!document_owner.owns(p_document));
+	context_set_cursor_shape(document_owner.get_or_null(p_document)->context, p_shape);
+}
+
+Input::CursorShape RMLServer::document_get_cursor_shape(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), Input::CURSOR_ARROW);
+	return context_get_cursor_shape(document_owner.get_or_null(p_document)->context);
+}
+
+void RMLServer::document_set_redraw_mode(const RID &p_document, RedrawMode p_mode) {
+	ERR_FAIL_COND(!document_owner.owns(p_document));
+	context_set_redraw_mode(document_owner.get_or_null(p_document)->context, p_mode);
+}
+
+RMLServer::RedrawMode RMLServer::document_get_redraw_mode(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), REDRAW_MODE_ALWAYS);
+	return context_get_redraw_mode(document_owner.get_or_null(p_document)->context);
+}
+
+void RMLServer::document_set_update_mode(const RID &p_document, UpdateMode p_mode) {
+	ERR_FAIL_COND(!document_owner.owns(p_document));
+	context_set_update_mode(document_owner.get_or_null(p_document)->context, p_mode);
+}
+
+RMLServer::UpdateMode RMLServer::document_get_update_mode(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), UPDATE_MODE_ALWAYS);
+	return context_get_update_mode(document_owner.get_or_null(p_document)->context);
+}
+
+void RMLServer::document_set_direct_rendering(const RID &p_document, bool p_enabled) {
+	ERR_FAIL_COND(!document_owner.owns(p_document));
+	context_set_direct_rendering(document_owner.get_or_null(p_document)->context, p_enabled);
+}
+
+bool RMLServer::document_is_direct_rendering(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), false);
+	return context_is_direct_rendering(document_owner.get_or_null(p_document)->context);
+}
+
+void RMLServer::document_draw(const RID &p_document, const RID &p_canvas_item) {
+	ERR_FAIL_COND(!document_owner.owns(p_document));
+	context_draw(document_owner.get_or_null(p_document)->context, p_canvas_item);
+}
+
+Dictionary RMLServer::document_get_stats(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), Dictionary());
+	return context_get_stats(document_owner.get_or_null(p_document)->context);
+}
+
+Ref<Image> RMLServer::document_get_image(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), Ref<Image>());
+	return context_get_image(document_owner.get_or_null(p_document)->context);
+}
+
+Dictionary RMLServer::document_get_gpu_times(const RID &p_document) {
+	ERR_FAIL_COND_V(!document_owner.owns(p_document), Dictionary());
+	return context_get_gpu_times(document_owner.get_or_null(p_document)->context);
+}
+
+void RMLServer::document_capture_frame(const RID &p_document, const String &p_path) {
+	ERR_FAIL_COND(!document_owner.owns(p_document));
+	context_capture_frame(document_owner.get_or_null(p_document)->context, p_path);
+}
+
+bool RMLServer::context_update(const RID &p_context) {
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), false);
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, false);
+
+	if (ctx_data->update_mode == UPDATE_MODE_WHEN_NEEDED && !context_needs_update(p_context)) {
+		return false;
+	}
+
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_V_MSG(ri, false, "No RenderInterfaceGodot is configured");
+	uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+	RenderInterfaceGodot::RenderStats render_start = ri->get_stats();
+
+	ctx_data->ctx->Update();
+	record_stats(ctx_data, &FrameStats::update_usec, start_usec, render_start);
+	ctx_data->last_update_time = Rml::GetSystemInterface()->GetElapsedTime();
+	return true;
+}
+
+bool RMLServer::context_needs_update(const RID &p_context) {
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), false);
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, false);
+
+	if (ctx_data->last_update_time < 0.0) {
+		return true;
+	}
+
+	// Animations, transitions, caret blinking, input and DOM changes all request the next update
+	// through the context, infinity when nothing did since the last update
+	double elapsed = Rml::GetSystemInterface()->GetElapsedTime() - ctx_data->last_update_time;
+	return elapsed >= ctx_data->ctx->GetNextUpdateDelay();
+}
+
+void RMLServer::context_set_size(const RID &p_context, const Vector2i &p_size) {
+	ERR_FAIL_COND(!context_owner.owns(p_context));
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL(ctx_data);
+	ctx_data->ctx->SetDimensions(Rml::Vector2i(
 		p_size.x,
 		p_size.y
 	));
+	ctx_data->ctx->RequestNextUpdate(0);
 }
 
-bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEvent> &p_event) {
-	ERR_FAIL_COND_V(!document_owner.owns(p_document), false);
-	DocumentData *doc_data = document_owner.get_or_null(p_document);
-	ERR_FAIL_NULL_V(doc_data, false);
+bool RMLServer::context_process_event(const RID &p_context, const Ref<InputEvent> &p_event) {
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), false);
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, false);
+
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_V_MSG(ri, false, "No RenderInterfaceGodot is configured");
+	uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+	RenderInterfaceGodot::RenderStats render_start = ri->get_stats();
 
-	SystemInterfaceGodot::get_singleton()->set_context_document(p_document);
+	SystemInterfaceGodot::get_singleton()->set_current_context(p_context);
 	bool propagated = true;
+
+	// Any input may change hover, focus or scrolling
+	ctx_data->ctx->RequestNextUpdate(0);
 	
 	Ref<InputEventKey> k = p_event;
 	if (k.is_valid()) {
 		if (k->is_pressed()) {
 			Rml::Input::KeyIdentifier key_identifier = godot_to_rml_key(k->get_keycode());
-			propagated = doc_data->ctx->ProcessKeyDown(
+			propagated = ctx_data->ctx->ProcessKeyDown(
 				key_identifier, 
 				godot_to_rml_key_modifiers(k->get_modifiers_mask())
 			);
 			char32_t c = k->get_unicode();
 			if (((c >= 32 || c == '\n') && c != 127) && !(k->get_modifiers_mask() & KeyModifierMask::KEY_MASK_CTRL)) {
-				propagated &= doc_data->ctx->ProcessTextInput(c);
+				propagated &= ctx_data->ctx->ProcessTextInput(c);
 			}
 		} else {
-			propagated = doc_data->ctx->ProcessKeyUp(
+			propagated = ctx_data->ctx->ProcessKeyUp(
 				godot_to_rml_key(k->get_keycode()), 
 				godot_to_rml_key_modifiers(k->get_modifiers_mask())
 			);
@@ -199,19 +502,19 @@ bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEve
 		if (mb->is_pressed()) {
 			switch (mb->get_button_index()) {
 				case MouseButton::MOUSE_BUTTON_LEFT: {
-					propagated = doc_data->ctx->ProcessMouseButtonDown(
+					propagated = ctx_data->ctx->ProcessMouseButtonDown(
 						0,
 						godot_to_rml_key_modifiers(mb->get_modifiers_mask())
 					);
 				} break;
 				case MouseButton::MOUSE_BUTTON_RIGHT: {
-					propagated = doc_data->ctx->ProcessMouseButtonDown(
+					propagated = ctx_data->ctx->ProcessMouseButtonDown(
 						1,
 						godot_to_rml_key_modifiers(mb->get_modifiers_mask())
 					);
 				} break;
 				case MouseButton::MOUSE_BUTTON_MIDDLE: {
-					propagated = doc_data->ctx->ProcessMouseButtonDown(
+					propagated = ctx_data->ctx->ProcessMouseButtonDown(
 						2,
 						godot_to_rml_key_modifiers(mb->get_modifiers_mask())
 					);
@@ -221,7 +524,7 @@ bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEve
 					if (mb->get_modifiers_mask() && KeyModifierMask::KEY_MASK_SHIFT) {
 						delta = Rml::Vector2f(-1.0, 0.0);
 					}
-					propagated = doc_data->ctx->ProcessMouseWheel(
+					propagated = ctx_data->ctx->ProcessMouseWheel(
 						delta,
 						godot_to_rml_key_modifiers(mb->get_modifiers_mask())
 					);
@@ -231,7 +534,7 @@ bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEve
 					if (mb->get_modifiers_mask() && KeyModifierMask::KEY_MASK_SHIFT) {
 						delta = Rml::Vector2f(1.0, 0.0);
 					}
-					propagated = doc_data->ctx->ProcessMouseWheel(
+					propagated = ctx_data->ctx->ProcessMouseWheel(
 						delta,
 						godot_to_rml_key_modifiers(mb->get_modifiers_mask())
 					);
@@ -241,19 +544,19 @@ bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEve
 		} else {
 			switch (mb->get_button_index()) {
 				case MouseButton::MOUSE_BUTTON_LEFT: {
-					propagated = doc_data->ctx->ProcessMouseButtonUp(
+					propagated = ctx_data->ctx->ProcessMouseButtonUp(
 						0,
 						godot_to_rml_key_modifiers(mb->get_modifiers_mask())
 					);
 				} break;
 				case MouseButton::MOUSE_BUTTON_RIGHT: {
-					propagated = doc_data->ctx->ProcessMouseButtonUp(
+					propagated = ctx_data->ctx->ProcessMouseButtonUp(
 						1,
 						godot_to_rml_key_modifiers(mb->get_modifiers_mask())
 					);
 				} break;
 				case MouseButton::MOUSE_BUTTON_MIDDLE: {
-					propagated = doc_data->ctx->ProcessMouseButtonUp(
+					propagated = ctx_data->ctx->ProcessMouseButtonUp(
 						2,
 						godot_to_rml_key_modifiers(mb->get_modifiers_mask())
 					);
@@ -266,11 +569,11 @@ bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEve
 	Ref<InputEventMouseMotion> mm = p_event;
 	if (mm.is_valid()) {
 		Vector2 mpos = mm->get_position();
-		Rml::Vector2i ctx_size = doc_data->ctx->GetDimensions();
+		Rml::Vector2i ctx_size = ctx_data->ctx->GetDimensions();
 		if (mpos.x < 0 || mpos.x >= ctx_size.x || mpos.y < 0 || mpos.y >= ctx_size.y) {
-			propagated = doc_data->ctx->ProcessMouseLeave();
+			propagated = ctx_data->ctx->ProcessMouseLeave();
 		} else {
-			propagated = doc_data->ctx->ProcessMouseMove(
+			propagated = ctx_data->ctx->ProcessMouseMove(
 				mpos.x,
 				mpos.y,
 				godot_to_rml_key_modifiers(mm->get_modifiers_mask())
@@ -289,11 +592,11 @@ bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEve
 		Rml::TouchList list;
 		list.push_back(touch_info);
 		if (touch->is_canceled()){
-			propagated = doc_data->ctx->ProcessTouchCancel(list);
+			propagated = ctx_data->ctx->ProcessTouchCancel(list);
 		} else if (touch->is_pressed()) {
-			propagated = doc_data->ctx->ProcessTouchStart(list, 0);
+			propagated = ctx_data->ctx->ProcessTouchStart(list, 0);
 		} else {
-			propagated = doc_data->ctx->ProcessTouchEnd(list, 0);
+			propagated = ctx_data->ctx->ProcessTouchEnd(list, 0);
 		}
 	}
 
@@ -307,50 +610,190 @@ bool RMLServer::document_process_event(const RID &p_document, const Ref<InputEve
 		);
 		Rml::TouchList list;
 		list.push_back(touch_info);
-		propagated = doc_data->ctx->ProcessTouchMove(list, 0);
+		propagated = ctx_data->ctx->ProcessTouchMove(list, 0);
 	}
 
-	SystemInterfaceGodot::get_singleton()->set_context_document(RID());
+	SystemInterfaceGodot::get_singleton()->set_current_context(RID());
+	record_stats(ctx_data, &FrameStats::input_usec, start_usec, render_start);
 
 	return !propagated;
 }
 
-void RMLServer::document_set_cursor_shape(const RID &p_document, const Input::CursorShape &p_shape) {
-	ERR_FAIL_COND(!document_owner.owns(p_document));
-	DocumentData *doc_data = document_owner.get_or_null(p_document);
-	ERR_FAIL_NULL(doc_data);
+void RMLServer::context_set_cursor_shape(const RID &p_context, const Input::CursorShape &p_shape) {
+	ERR_FAIL_COND(!context_owner.owns(p_context));
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL(ctx_data);
 
-	doc_data->cursor_shape = p_shape;
+	ctx_data->cursor_shape = p_shape;
 }
 
-Input::CursorShape RMLServer::document_get_cursor_shape(const RID &p_document) {
-	ERR_FAIL_COND_V(!document_owner.owns(p_document), Input::CURSOR_ARROW);
-	DocumentData *doc_data = document_owner.get_or_null(p_document);
-	ERR_FAIL_NULL_V(doc_data, Input::CURSOR_ARROW);
+Input::CursorShape RMLServer::context_get_cursor_shape(const RID &p_context) {
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), Input::CURSOR_ARROW);
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, Input::CURSOR_ARROW);
 
-	return doc_data->cursor_shape;
+	return ctx_data->cursor_shape;
 }
 
-void RMLServer::document_draw(const RID &p_document, const RID &p_canvas_item) {
-	RenderInterfaceGodot *ri = dynamic_cast<RenderInterfaceGodot *>(Rml::GetRenderInterface());
-	ERR_FAIL_NULL_MSG(ri, "Render interface configured is not of type RenderInterfaceGodot");
+void RMLServer::context_set_redraw_mode(const RID &p_context, RedrawMode p_mode) {
+	ERR_FAIL_COND(!context_owner.owns(p_context));
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL(ctx_data);
 
-	ERR_FAIL_COND(!document_owner.owns(p_document));
-	DocumentData *doc_data = document_owner.get_or_null(p_document);
-	ERR_FAIL_NULL(doc_data);
+	ctx_data->redraw_mode = p_mode;
+}
+
+RMLServer::RedrawMode RMLServer::context_get_redraw_mode(const RID &p_context) {
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), REDRAW_MODE_ALWAYS);
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, REDRAW_MODE_ALWAYS);
+
+	return ctx_data->redraw_mode;
+}
+
+void RMLServer::context_set_update_mode(const RID &p_context, UpdateMode p_mode) {
+	ERR_FAIL_COND(!context_owner.owns(p_context));
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL(ctx_data);
+
+	ctx_data->update_mode = p_mode;
+}
+
+RMLServer::UpdateMode RMLServer::context_get_update_mode(const RID &p_context) {
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), UPDATE_MODE_ALWAYS);
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, UPDATE_MODE_ALWAYS);
+
+	return ctx_data->update_mode;
+}
+
+void RMLServer::context_set_direct_rendering(const RID &p_context, bool p_enabled) {
+	ERR_FAIL_COND(!context_owner.owns(p_context));
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL(ctx_data);
+
+	ctx_data->direct_rendering = p_enabled;
+}
+
+bool RMLServer::context_is_direct_rendering(const RID &p_context) {
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), false);
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, false);
+
+	return ctx_data->direct_rendering;
+}
+
+void RMLServer::context_draw(const RID &p_context, const RID &p_canvas_item) {
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_MSG(ri, "No RenderInterfaceGodot is configured");
+
+	ERR_FAIL_COND(!context_owner.owns(p_context));
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL(ctx_data);
 
 	Vector2i size = Vector2i(
-		doc_data->ctx->GetDimensions().x,
-		doc_data->ctx->GetDimensions().y
+		ctx_data->ctx->GetDimensions().x,
+		ctx_data->ctx->GetDimensions().y
 	);
 	if (size.x <= 0 || size.y <= 0) {
 		return;
 	}
 
-	ri->push_context(doc_data->draw_context, size);
-	doc_data->ctx->Render();
+	// Unchanged frames reuse the previous render, changed ones only re-render the damaged region
+	bool incremental = ctx_data->redraw_mode == REDRAW_MODE_WHEN_CHANGED;
+
+	RenderCaptureInterface *capture = ctx_data->capture_path.is_empty() ? nullptr : ri->get_capture();
+	if (capture != nullptr) {
+		// The capture starts with the live geometry and textures, nothing has to be compiled again
+		capture->begin(Rml::Vector2i(size.x, size.y));
+		incremental = false;
+	}
+
+	uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+	RenderInterfaceGodot::RenderStats render_start = ri->get_stats();
+
+	ri->push_context(ctx_data->draw_context, size, incremental, ctx_data->direct_rendering);
+	ctx_data->ctx->Render();
 	ri->pop_context();
-	ri->draw_context(doc_data->draw_context, p_canvas_item);
+	ri->draw_context(ctx_data->draw_context, p_canvas_item);
+
+	record_stats(ctx_data, &FrameStats::render_usec, start_usec, render_start);
+
+	if (capture != nullptr) {
+		std::vector<uint8_t> data = capture->end();
+		String path = ctx_data->capture_path;
+		ctx_data->capture_path = String();
+
+		Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+		ERR_FAIL_COND_MSG(file.is_null(), vformat("Couldn't write the capture to '%s'", path));
+		PackedByteArray bytes;
+		bytes.resize(data.size());
+		memcpy(bytes.ptrw(), data.data(), data.size());
+		file->store_buffer(bytes);
+	}
+}
+
+Dictionary RMLServer::context_get_stats(const RID &p_context) {
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), Dictionary());
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, Dictionary());
+
+	return stats_to_dictionary(ctx_data->stats);
+}
+
+Ref<Image> RMLServer::context_get_image(const RID &p_context) {
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_V_MSG(ri, Ref<Image>(), "No RenderInterfaceGodot is configured");
+
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), Ref<Image>());
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, Ref<Image>());
+
+	return ri->get_context_image(ctx_data->draw_context);
+}
+
+Dictionary RMLServer::context_get_gpu_times(const RID &p_context) {
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_V_MSG(ri, Dictionary(), "No RenderInterfaceGodot is configured");
+
+	ERR_FAIL_COND_V(!context_owner.owns(p_context), Dictionary());
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL_V(ctx_data, Dictionary());
+
+	return ri->get_context_gpu_times(ctx_data->draw_context);
+}
+
+void RMLServer::context_capture_frame(const RID &p_context, const String &p_path) {
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_MSG(ri, "No RenderInterfaceGodot is configured");
+	ERR_FAIL_NULL_MSG(ri->get_capture(), "Render captures are disabled, enable the RmlUi/debug/render_capture project setting");
+
+	ERR_FAIL_COND(!context_owner.owns(p_context));
+	ContextData *ctx_data = context_owner.get_or_null(p_context);
+	ERR_FAIL_NULL(ctx_data);
+
+	ctx_data->capture_path = p_path;
+}
+
+bool RMLServer::replay_capture(const String &p_path, const RID &p_canvas_item) {
+	RenderInterfaceGodot *ri = RenderInterfaceGodot::get_singleton();
+	ERR_FAIL_NULL_V_MSG(ri, false, "No RenderInterfaceGodot is configured");
+
+	PackedByteArray bytes = FileAccess::get_file_as_bytes(p_path);
+	ERR_FAIL_COND_V_MSG(bytes.is_empty(), false, vformat("Couldn't read the capture '%s'", p_path));
+
+	RenderCapturePlayer player;
+	bool loaded = player.load(std::vector<uint8_t>(bytes.ptr(), bytes.ptr() + bytes.size()));
+	ERR_FAIL_COND_V_MSG(!loaded, false, vformat("Couldn't load the capture '%s'", p_path));
+
+	// Played straight into the renderer, so replays are never captured themselves
+	Vector2i size = Vector2i(player.get_size().x, player.get_size().y);
+	ri->push_context(replay_context, size);
+	int64_t command_count = player.replay(ri);
+	ri->pop_context();
+	ri->draw_context(replay_context, p_canvas_item);
+
+	return command_count >= 0;
 }
 
 bool RMLServer::load_default_stylesheet(const String &p_path) {
@@ -377,36 +820,83 @@ bool RMLServer::load_font_face_from_buffer(const PackedByteArray &p_buffer, cons
 }
 
 void RMLServer::free_rid(const RID &p_rid) {
-	RenderInterfaceGodot *ri = dynamic_cast<RenderInterfaceGodot *>(Rml::GetRenderInterface());
-	ERR_FAIL_NULL_MSG(ri, "Render interface configured is not of type RenderInterfaceGodot");
-
 	if (document_owner.owns(p_rid)) {
-		DocumentData *doc_data = document_owner.get_or_null(p_rid);
-		Rml::RemoveContext(doc_data->ctx->GetName());
-		
-		ri->free_context(doc_data->draw_context);
-		
-		document_owner.free(p_rid);
+		finalize_document(p_rid);
+	} else if (context_owner.owns(p_rid)) {
+		ContextData *ctx_data = context_owner.get_or_null(p_rid);
+		ERR_FAIL_COND_MSG(ctx_data->implicit, "Context is owned by its document, free the document instead");
+		ERR_FAIL_COND_MSG(ctx_data->pending_free, "Context was already freed");
+
+		// Documents still hosted keep the context alive until they are freed
+		if (ctx_data->document_count > 0) {
+			ctx_data->pending_free = true;
+		} else {
+			finalize_context(p_rid);
+		}
 	}
 }
 
 void RMLServer::_bind_methods() {
-	ClassDB::bind_method(D_METHOD("create_document"), &RMLServer::create_document);
-	ClassDB::bind_method(D_METHOD("create_document_from_rml_string", "rml"), &RMLServer::create_document_from_rml_string);
-	ClassDB::bind_method(D_METHOD("create_document_from_path", "path"), &RMLServer::create_document_from_path);
+	ClassDB::bind_method(D_METHOD("create_context"), &RMLServer::create_context);
+	ClassDB::bind_method(D_METHOD("create_document", "context"), &RMLServer::create_document, DEFVAL(RID()));
+	ClassDB::bind_method(D_METHOD("create_document_from_rml_string", "rml", "context"), &RMLServer::create_document_from_rml_string, DEFVAL(RID()));
+	ClassDB::bind_method(D_METHOD("create_document_from_path", "path", "context"), &RMLServer::create_document_from_path, DEFVAL(RID()));
 	ClassDB::bind_method(D_METHOD("get_document_root", "document"), &RMLServer::get_document_root);
 	ClassDB::bind_method(D_METHOD("create_element", "document", "tag_name"), &RMLServer::create_element);
+
+	ClassDB::bind_method(D_METHOD("document_get_context", "document"), &RMLServer::document_get_context);
+	ClassDB::bind_method(D_METHOD("document_set_rect", "document", "rect"), &RMLServer::document_set_rect);
+	ClassDB::bind_method(D_METHOD("document_set_z_index", "document", "z_index"), &RMLServer::document_set_z_index);
 	
 	ClassDB::bind_method(D_METHOD("document_set_size", "document", "size"), &RMLServer::document_set_size);
 	ClassDB::bind_method(D_METHOD("document_process_event", "document", "event"), &RMLServer::document_process_event);
 
 	ClassDB::bind_method(D_METHOD("document_update", "document"), &RMLServer::document_update);
+	ClassDB::bind_method(D_METHOD("document_needs_update", "document"), &RMLServer::document_needs_update);
 	ClassDB::bind_method(D_METHOD("document_draw", "document", "canvas_item"), &RMLServer::document_draw);
+	ClassDB::bind_method(D_METHOD("document_get_stats", "document"), &RMLServer::document_get_stats);
+	ClassDB::bind_method(D_METHOD("document_get_image", "document"), &RMLServer::document_get_image);
+	ClassDB::bind_method(D_METHOD("document_get_gpu_times", "document"), &RMLServer::document_get_gpu_times);
+	ClassDB::bind_method(D_METHOD("document_capture_frame", "document", "path"), &RMLServer::document_capture_frame);
+
+	ClassDB::bind_method(D_METHOD("document_set_redraw_mode", "document", "mode"), &RMLServer::document_set_redraw_mode);
+	ClassDB::bind_method(D_METHOD("document_get_redraw_mode", "document"), &RMLServer::document_get_redraw_mode);
+	ClassDB::bind_method(D_METHOD("document_set_update_mode", "document", "mode"), &RMLServer::document_set_update_mode);
+	ClassDB::bind_method(D_METHOD("document_get_update_mode", "document"), &RMLServer::document_get_update_mode);
+	ClassDB::bind_method(D_METHOD("document_set_direct_rendering", "document", "enabled"), &RMLServer::document_set_direct_rendering);
+	ClassDB::bind_method(D_METHOD("document_is_direct_rendering", "document"), &RMLServer::document_is_direct_rendering);
+
+	ClassDB::bind_method(D_METHOD("context_set_size", "context", "size"), &RMLServer::context_set_size);
+	ClassDB::bind_method(D_METHOD("context_process_event", "context", "event"), &RMLServer::context_process_event);
+	ClassDB::bind_method(D_METHOD("context_get_cursor_shape", "context"), &RMLServer::context_get_cursor_shape);
+
+	ClassDB::bind_method(D_METHOD("context_update", "context"), &RMLServer::context_update);
+	ClassDB::bind_method(D_METHOD("context_needs_update", "context"), &RMLServer::context_needs_update);
+	ClassDB::bind_method(D_METHOD("context_draw", "context", "canvas_item"), &RMLServer::context_draw);
+	ClassDB::bind_method(D_METHOD("context_get_stats", "context"), &RMLServer::context_get_stats);
+	ClassDB::bind_method(D_METHOD("context_get_image", "context"), &RMLServer::context_get_image);
+	ClassDB::bind_method(D_METHOD("context_get_gpu_times", "context"), &RMLServer::context_get_gpu_times);
+	ClassDB::bind_method(D_METHOD("context_capture_frame", "context", "path"), &RMLServer::context_capture_frame);
+
+	ClassDB::bind_method(D_METHOD("context_set_redraw_mode", "context", "mode"), &RMLServer::context_set_redraw_mode);
+	ClassDB::bind_method(D_METHOD("context_get_redraw_mode", "context"), &RMLServer::context_get_redraw_mode);
+	ClassDB::bind_method(D_METHOD("context_set_update_mode", "context", "mode"), &RMLServer::context_set_update_mode);
+	ClassDB::bind_method(D_METHOD("context_get_update_mode", "context"), &RMLServer::context_get_update_mode);
+	ClassDB::bind_method(D_METHOD("context_set_direct_rendering", "context", "enabled"), &RMLServer::context_set_direct_rendering);
+	ClassDB::bind_method(D_METHOD("context_is_direct_rendering", "context"), &RMLServer::context_is_direct_rendering);
 
 	ClassDB::bind_method(D_METHOD("load_font_face_from_path", "path", "fallback_face"), &RMLServer::load_font_face_from_path, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("load_font_face_from_buffer", "buffer", "family", "fallback_face", "is_italic"), &RMLServer::load_font_face_from_buffer, DEFVAL(false), DEFVAL(false));
 
+	ClassDB::bind_method(D_METHOD("replay_capture", "path", "canvas_item"), &RMLServer::replay_capture);
+
 	ClassDB::bind_method(D_METHOD("free_rid", "rid"), &RMLServer::free_rid);
+
+	BIND_ENUM_CONSTANT(REDRAW_MODE_ALWAYS);
+	BIND_ENUM_CONSTANT(REDRAW_MODE_WHEN_CHANGED);
+
+	BIND_ENUM_CONSTANT(UPDATE_MODE_ALWAYS);
+	BIND_ENUM_CONSTANT(UPDATE_MODE_WHEN_NEEDED);
 }
 
 RMLServer::RMLServer() {
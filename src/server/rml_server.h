@@ -7,6 +7,7 @@
 #include <RmlUi/Core.h>
 
 #include "../element/rml_element.h"
+#include "../interface/render_interface_godot.h"
 
 namespace godot {
 
@@ -19,18 +20,75 @@ class RMLServer: public Object {
 
 	static RMLServer *singleton;
 
+public:
+	enum RedrawMode {
+		REDRAW_MODE_ALWAYS,
+		REDRAW_MODE_WHEN_CHANGED
+	};
+
+	enum UpdateMode {
+		UPDATE_MODE_ALWAYS,
+		UPDATE_MODE_WHEN_NEEDED
+	};
+
+private:
+	struct ContextData;
 	struct DocumentData;
 
-	struct DocumentData {
-		Rml::Context *ctx;
-		Rml::ElementDocument *doc;
+	// Work done during a single process frame
+	struct FrameStats {
+		uint64_t frame = 0;
+		uint64_t update_usec = 0;
+		uint64_t render_usec = 0;
+		uint64_t input_usec = 0;
+		RenderInterfaceGodot::RenderStats render;
+	};
+
+	struct ContextData {
+		Rml::Context *ctx = nullptr;
 		Input::CursorShape cursor_shape = Input::CURSOR_ARROW;
 		void *draw_context = nullptr;
+		RedrawMode redraw_mode = REDRAW_MODE_ALWAYS;
+		UpdateMode update_mode = UPDATE_MODE_ALWAYS;
+		bool direct_rendering = false;
+		// Negative until the first update
+		double last_update_time = -1.0;
+
+		uint32_t document_count = 0;
+		// Created for a single document and freed with it
+		bool implicit = false;
+		// Freed while documents were still hosted, removed with the last one
+		bool pending_free = false;
+
+		FrameStats stats;
+		// Set until the next draw is captured into it
+		String capture_path;
 	};
 
+	struct DocumentData {
+		Rml::ElementDocument *doc = nullptr;
+		RID context;
+	};
+
+	RID_Owner<ContextData> context_owner;
 	RID_Owner<DocumentData> document_owner;
 
-	RID initialize_document();
+	// Summed over every context, read by the Performance monitors
+	FrameStats frame_stats;
+
+	// Draw context replayed captures are rendered into
+	void *replay_context = nullptr;
+
+	static FrameStats &get_frame_stats(FrameStats &p_stats);
+	void record_stats(ContextData *p_ctx_data, uint64_t FrameStats::*p_time, uint64_t p_start_usec, const RenderInterfaceGodot::RenderStats &p_render_start);
+	static Dictionary stats_to_dictionary(const FrameStats &p_stats);
+	double get_monitor(const String &p_key);
+
+	RID initialize_context();
+	void finalize_context(const RID &p_context);
+	RID initialize_document(const RID &p_context);
+	void finalize_document(const RID &p_document);
+	ContextData *get_document_context(const RID &p_document);
 protected:
 	static void _bind_methods();
 	
@@ -41,18 +99,54 @@ public:
 	void initialize();
 	void uninitialize();
 
-	RID create_document();
-	RID create_document_from_rml_string(const String &p_string);
-	RID create_document_from_path(const String &p_path);
+	RID create_context();
+	RID create_document(const RID &p_context = RID());
+	RID create_document_from_rml_string(const String &p_string, const RID &p_context = RID());
+	RID create_document_from_path(const String &p_path, const RID &p_context = RID());
 	Ref<RMLElement> get_document_root(const RID &p_document);
 	Ref<RMLElement> create_element(const RID &p_document, const String &p_tag_name);
 
-	void document_update(const RID &p_document);
+	RID document_get_context(const RID &p_document);
+	void document_set_rect(const RID &p_document, const Rect2i &p_rect);
+	void document_set_z_index(const RID &p_document, int p_z_index);
+
+	bool document_update(const RID &p_document);
+	bool document_needs_update(const RID &p_document);
 	void document_set_size(const RID &p_document, const Vector2i &p_size);
 	bool document_process_event(const RID &p_document, const Ref<InputEvent> &p_event);
 	void document_set_cursor_shape(const RID &p_document, const Input::CursorShape &p_shape);
 	Input::CursorShape document_get_cursor_shape(const RID &p_document);
+	void document_set_redraw_mode(const RID &p_document, RedrawMode p_mode);
+	RedrawMode document_get_redraw_mode(const RID &p_document);
+	void document_set_update_mode(const RID &p_document, UpdateMode p_mode);
+	UpdateMode document_get_update_mode(const RID &p_document);
+	void document_set_direct_rendering(const RID &p_document, bool p_enabled);
+	bool document_is_direct_rendering(const RID &p_document);
 	void document_draw(const RID &p_document, const RID &p_canvas_item);
+	Dictionary document_get_stats(const RID &p_document);
+	Ref<Image> document_get_image(const RID &p_document);
+	Dictionary document_get_gpu_times(const RID &p_document);
+	void document_capture_frame(const RID &p_document, const String &p_path);
+
+	bool context_update(const RID &p_context);
+	bool context_needs_update(const RID &p_context);
+	void context_set_size(const RID &p_context, const Vector2i &p_size);
+	bool context_process_event(const RID &p_context, const Ref<InputEvent> &p_event);
+	void context_set_cursor_shape(const RID &p_context, const Input::CursorShape &p_shape);
+	Input::CursorShape context_get_cursor_shape(const RID &p_context);
+	void context_set_redraw_mode(const RID &p_context, RedrawMode p_mode);
+	RedrawMode context_get_redraw_mode(const RID &p_context);
+	void context_set_update_mode(const RID &p_context, UpdateMode p_mode);
+	UpdateMode context_get_update_mode(const RID &p_context);
+	void context_set_direct_rendering(const RID &p_context, bool p_enabled);
+	bool context_is_direct_rendering(const RID &p_context);
+	void context_draw(const RID &p_context, const RID &p_canvas_item);
+	Dictionary context_get_stats(const RID &p_context);
+	Ref<Image> context_get_image(const RID &p_context);
+	Dictionary context_get_gpu_times(const RID &p_context);
+	void context_capture_frame(const RID &p_context, const String &p_path);
+
+	bool replay_capture(const String &p_path, const RID &p_canvas_item);
 
 	bool load_default_stylesheet(const String &p_path);
 
@@ -64,4 +158,7 @@ public:
 	RMLServer();
 };
 
-}
\ No newline at end of file
+}
+
+VARIANT_ENUM_CAST(RMLServer::RedrawMode);
+VARIANT_ENUM_CAST(RMLServer::UpdateMode);
\ No newline at end of file